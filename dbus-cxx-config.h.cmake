@@ -21,6 +21,8 @@
 
 #cmakedefine DBUS_CXX_HAS_CXXABI_H @DBUS_CXX_HAS_CXXABI_H@
 #cmakedefine DBUS_CXX_HAS_CXA_DEMANGLE @DBUS_CXX_HAS_CXA_DEMANGLE@
+#cmakedefine DBUS_CXX_HAS_EVENTFD @DBUS_CXX_HAS_EVENTFD@
+#cmakedefine DBUS_CXX_HAS_FUTEX @DBUS_CXX_HAS_FUTEX@
 
 #define DBUS_CXX_PACKAGE_MAJOR_VERSION ${dbus-cxx_VERSION_MAJOR}
 #define DBUS_CXX_PACKAGE_MINOR_VERSION ${dbus-cxx_VERSION_MINOR}
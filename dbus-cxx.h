@@ -15,6 +15,8 @@
 #include <dbus-cxx/dbus-cxx-config.h>
 #include <dbus-cxx/callmessage.h>
 #include <dbus-cxx/connection.h>
+#include <dbus-cxx/credentials.h>
+#include <dbus-cxx/deferredreply.h>
 #include <dbus-cxx/signal.h>
 #include <dbus-cxx/dispatcher.h>
 #include <dbus-cxx/enums.h>
@@ -30,6 +32,7 @@
 #include <dbus-cxx/object.h>
 #include <dbus-cxx/objectproxy.h>
 #include <dbus-cxx/pendingcall.h>
+#include <dbus-cxx/result.h>
 #include <dbus-cxx/returnmessage.h>
 #include <dbus-cxx/signalbase.h>
 #include <dbus-cxx/signalmessage.h>
@@ -38,11 +41,14 @@
 #include <dbus-cxx/signatureiterator.h>
 #include <dbus-cxx/utility.h>
 #include <dbus-cxx/variant.h>
+#include <dbus-cxx/virtualobjecttree.h>
 #include <dbus-cxx/filedescriptor.h>
 #include <dbus-cxx/simplelogger_defs.h>
 #include <dbus-cxx/standalonedispatcher.h>
+#include <dbus-cxx/standalonethreaddispatcher.h>
 #include <dbus-cxx/propertyproxy.h>
 #include <dbus-cxx/property.h>
 #include <dbus-cxx/multiplereturn.h>
+#include <dbus-cxx/coroutine.h>
 
 #endif
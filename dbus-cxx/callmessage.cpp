@@ -7,6 +7,7 @@
  ***************************************************************************/
 #include <dbus-cxx/dbus-cxx-private.h>
 #include "callmessage.h"
+#include "connection.h"
 #include "enums.h"
 #include "error.h"
 #include "message.h"
@@ -143,7 +144,17 @@ void CallMessage::set_no_reply( bool no_reply ) {
 }
 
 bool CallMessage::expects_reply() const {
-    return flags() & DBUSCXX_MESSAGE_NO_REPLY_EXPECTED;
+    return !( flags() & DBUSCXX_MESSAGE_NO_REPLY_EXPECTED );
+}
+
+Credentials CallMessage::sender_credentials() const {
+    std::shared_ptr<Connection> conn = received_on().lock();
+
+    if( !conn ) {
+        throw ErrorDisconnected();
+    }
+
+    return conn->credentials( sender() );
 }
 
 MessageType CallMessage::type() const {
@@ -5,6 +5,7 @@
  *                                                                         *
  *   This file is part of the dbus-cxx library.                            *
  ***************************************************************************/
+#include <dbus-cxx/credentials.h>
 #include <dbus-cxx/message.h>
 #include <dbus-cxx/path.h>
 #include <memory>
@@ -90,6 +91,18 @@ public:
 
     bool expects_reply() const;
 
+    /**
+     * Get the credentials of the connection that sent this call, from the
+     * connection that it was received on.  The credentials are cached by
+     * the connection, so this only asks the bus the first time that a
+     * caller is seen.
+     *
+     * @throws ErrorDisconnected If this call was not received on a
+     * connection, or the connection no longer exists
+     * @throws Error If the bus is unable to return the credentials
+     */
+    Credentials sender_credentials() const;
+
     virtual MessageType type() const;
 
 };
@@ -10,20 +10,26 @@
 #include <dbus-cxx/signalmessage.h>
 #include <dbus-cxx/errormessage.h>
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <memory>
+#include <optional>
 #include <utility>
 #include "callmessage.h"
 #include "dbus-cxx-private.h"
 #include "error.h"
 #include "message.h"
+#include "mpscqueue.h"
 #include "object.h"
 #include "objectproxy.h"
 #include "path.h"
+#include "pathtrie.h"
 #include "pendingcall.h"
+#include "replyslottable.h"
 #include "returnmessage.h"
 #include <sigc++/sigc++.h>
 #include "signalproxy.h"
+#include "timerwheel.h"
 #include "transport.h"
 #include "simpletransport.h"
 #include <poll.h>
@@ -63,12 +69,6 @@ static const char* LOGGER_NAME = "DBus.Connection";
 
 namespace DBus {
 
-struct ExpectingResponse {
-    std::mutex cv_lock;
-    std::condition_variable cv;
-    std::shared_ptr<Message> reply;
-};
-
 struct OutgoingMessage {
     std::shared_ptr<const Message> msg;
     uint32_t serial;
@@ -82,6 +82,8 @@ struct PathHandlingEntry {
 struct ObjectProxyThreadInfo {
     std::shared_ptr<ObjectProxy> handler;
     std::thread::id handlingThread;
+    /* Passes owner changes on to a handler that is not on the dispatching thread */
+    std::shared_ptr<SignalProxyBase> ownerChanged;
 };
 
 struct FreeSignalThreadInfo {
@@ -89,36 +91,178 @@ struct FreeSignalThreadInfo {
     std::thread::id handlingThread;
 };
 
+struct WatchedName {
+    WatchedName() : watchers( 0 ), changes( 0 ), resolved( false ) {}
+
+    std::string owner;
+    int watchers;
+    /* The number of NameOwnerChanged signals seen for this name */
+    uint64_t changes;
+    /* False until the owner has been looked up or changed */
+    bool resolved;
+};
+
+struct ListeningRule {
+    ListeningRule() : count( 0 ) {}
+
+    int count;
+    /* The AddMatch call for the rule; later adders wait for its reply */
+    std::shared_ptr<PendingCall> adding;
+};
+
+struct MatchCall {
+    MatchCall() : report_error( false ) {}
+
+    std::string method;
+    std::string rule;
+    /* Completed with the reply */
+    std::shared_ptr<PendingCall> pending;
+    /* Emit signal_match_error() if the bus rejects the call */
+    bool report_error;
+};
+
+static std::string name_owner_rule( const std::string& name ) {
+    return MatchRuleBuilder::create()
+           .set_sender( DBUS_CXX_BUS_NAME )
+           .set_path( DBUS_CXX_BUS_PATH )
+           .set_interface( DBUS_CXX_BUS_NAME )
+           .set_member( "NameOwnerChanged" )
+           .set_arg( 0, name )
+           .as_signal_match()
+           .match_rule();
+}
+
+/* NameOwnerChanged for every connection that leaves the bus */
+static std::string disconnected_rule() {
+    return MatchRuleBuilder::create()
+           .set_sender( DBUS_CXX_BUS_NAME )
+           .set_path( DBUS_CXX_BUS_PATH )
+           .set_interface( DBUS_CXX_BUS_NAME )
+           .set_member( "NameOwnerChanged" )
+           .set_arg( 2, "" )
+           .as_signal_match()
+           .match_rule();
+}
+
+/**
+ * Free signal proxies are indexed by ( interface, member ).  An empty
+ * interface or member means that the proxy will match any value, so an
+ * incoming signal needs to look in at most four buckets.
+ */
+typedef std::pair<std::string, std::string> SignalRoutingKey;
+typedef std::map<SignalRoutingKey, std::vector<FreeSignalThreadInfo>> SignalRoutingTable;
+
+static bool remove_signal_from_bucket( std::vector<FreeSignalThreadInfo>& bucket,
+                                       std::shared_ptr<SignalProxyBase> signal,
+                                       std::thread::id* handlingThread ) {
+    for( std::vector<FreeSignalThreadInfo>::iterator it = bucket.begin(); it != bucket.end(); it++ ) {
+        if( it->handler == signal ) {
+            *handlingThread = it->handlingThread;
+            bucket.erase( it );
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * The reply timeout to use when none is given.
+ */
+static const int DEFAULT_REPLY_TIMEOUT_MS = 20000;
+
+static std::chrono::steady_clock::time_point reply_deadline( int timeout_milliseconds ) {
+    if( timeout_milliseconds < 0 ) {
+        timeout_milliseconds = DEFAULT_REPLY_TIMEOUT_MS;
+    }
+
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds( timeout_milliseconds );
+}
+
+static std::shared_ptr<ErrorMessage> no_reply_error( uint32_t serial ) {
+    std::shared_ptr<ErrorMessage> errmsg = ErrorMessage::create();
+    errmsg->set_name( DBUSCXX_ERROR_NO_REPLY );
+    errmsg->set_message( "Did not receive a response in the alotted time" );
+    errmsg->set_reply_serial( serial );
+    return errmsg;
+}
+
+static std::shared_ptr<ErrorMessage> disconnected_error( uint32_t serial ) {
+    std::shared_ptr<ErrorMessage> errmsg = ErrorMessage::create();
+    errmsg->set_name( DBUSCXX_ERROR_DISCONNECTED );
+    errmsg->set_message( "The connection is closed" );
+    errmsg->set_reply_serial( serial );
+    return errmsg;
+}
+
 class Connection::priv_data {
 public:
     priv_data() :
         m_currentSerial( 1 ),
         m_dispatchingThread( std::this_thread::get_id() ),
-        m_dispatchStatus( DispatchStatus::COMPLETE )
+        m_dispatchStatus( DispatchStatus::COMPLETE ),
+        m_outstandingReplies( 0 ),
+        m_watchingDisconnects( false )
     {}
 
+    /* Serials are never 0, so skip it when we wrap around */
+    uint32_t next_serial() {
+        uint32_t serial;
+
+        do {
+            serial = m_currentSerial.fetch_add( 1, std::memory_order_relaxed );
+        } while( serial == 0 );
+
+        return serial;
+    }
+
     std::vector<uint8_t> m_sendBuffer;
-    uint32_t m_currentSerial;
+    std::atomic<uint32_t> m_currentSerial;
     std::shared_ptr<priv::Transport> m_transport;
     std::string m_uniqueName;
     std::thread::id m_dispatchingThread;
     std::queue<std::shared_ptr<Message>> m_incomingMessages;
-    std::mutex m_outgoingLock;
-    std::queue<OutgoingMessage> m_outgoingMessages;
-    std::mutex m_expectingResponsesLock;
-    std::map<uint32_t, std::shared_ptr<ExpectingResponse>> m_expectingResponses;
+    /* Held while writing to the transport; never needed to queue a message */
+    std::mutex m_writeLock;
+    priv::MpscQueue<OutgoingMessage> m_outgoingMessages;
+    /* Replies that threads other than the dispatching thread are blocked on */
+    priv::ReplySlotTable m_replySlots;
+    mutable std::mutex m_expectingResponsesLock;
+    /* Calls made with send_with_reply_async, protected by m_expectingResponsesLock */
+    std::map<uint32_t, std::shared_ptr<PendingCall>> m_pendingCalls;
+    /* Deadlines of the above, also protected by m_expectingResponsesLock */
+    priv::TimerWheel m_replyTimeouts;
     DispatchStatus m_dispatchStatus;
+    /* Held while changing m_path_handler; lookups don't need it */
     std::mutex m_pathHandlerLock;
-    std::map<std::string, PathHandlingEntry> m_path_handler;
+    priv::PathTrie<PathHandlingEntry> m_path_handler;
     std::mutex m_threadDispatcherLock;
     std::map<std::thread::id, std::weak_ptr<ThreadDispatcher>> m_threadDispatchers;
     std::shared_ptr<DBusDaemonProxy> m_daemonProxy;
     sigc::signal<void()> m_needsDispatching;
     std::mutex m_freeProxySignalsLock;
-    std::vector<FreeSignalThreadInfo> m_freeProxySignals;
+    SignalRoutingTable m_freeProxySignals;
     std::mutex m_objectProxiesLock;
     std::vector<ObjectProxyThreadInfo> m_objectProxies;
-    std::map<std::string,int> m_listeningSignals;
+    /* Match rules that the bus knows about; calls for them are queued under this lock */
+    std::mutex m_matchLock;
+    std::map<std::string, ListeningRule> m_listeningSignals;
+    /* AddMatch and RemoveMatch calls that have not been answered, by serial */
+    std::map<uint32_t, MatchCall> m_pendingMatchCalls;
+    sigc::signal<void(std::string, std::string, std::string)> m_matchError;
+    /* Calls to local methods that are waiting for a DeferredReply */
+    std::atomic<uint32_t> m_outstandingReplies;
+    /* Work to do at the start of the next dispatch */
+    priv::MpscQueue<std::function<void()>> m_deferredWork;
+    /* The owners of the names that are being watched */
+    mutable std::mutex m_watchedNamesLock;
+    std::map<std::string, WatchedName> m_watchedNames;
+    sigc::signal<void(std::string, std::string, std::string)> m_nameOwnerChanged;
+    /* Credentials of other connections by unique name; empty while the bus is being asked */
+    std::mutex m_credentialsLock;
+    std::map<std::string, std::optional<Credentials>> m_credentials;
+    /* Set once disconnected_rule() has been added for the credentials cache */
+    std::atomic<bool> m_watchingDisconnects;
 };
 
 Connection::Connection( BusType type ) {
@@ -193,6 +337,11 @@ std::shared_ptr<Connection> Connection::create( std::string address ) {
 }
 
 Connection::~Connection() {
+    std::unique_lock<std::mutex> lock( m_priv->m_expectingResponsesLock );
+
+    for( std::pair<const uint32_t, std::shared_ptr<PendingCall>>& pending : m_priv->m_pendingCalls ) {
+        pending.second->cancel();
+    }
 }
 
 Connection::operator bool() const {
@@ -278,9 +427,256 @@ ReleaseNameResponse Connection::release_name( const std::string& name ) {
 }
 
 bool Connection::name_has_owner( const std::string& name ) const {
+    {
+        std::scoped_lock lock( m_priv->m_watchedNamesLock );
+        std::map<std::string, WatchedName>::const_iterator it = m_priv->m_watchedNames.find( name );
+
+        if( it != m_priv->m_watchedNames.end() && it->second.resolved ) {
+            return !it->second.owner.empty();
+        }
+    }
+
     return m_priv->m_daemonProxy->NameHasOwner( name );
 }
 
+void Connection::watch_name( const std::string& name ) {
+    if( name.empty() || name[ 0 ] == ':' || name == DBUS_CXX_BUS_NAME || !m_priv->m_daemonProxy ) { return; }
+
+    {
+        std::scoped_lock lock( m_priv->m_watchedNamesLock );
+        WatchedName& watched = m_priv->m_watchedNames[ name ];
+
+        watched.watchers++;
+
+        if( watched.watchers > 1 ) { return; }
+    }
+
+    SIMPLELOGGER_DEBUG( LOGGER_NAME, "Watching the owner of " << name );
+
+    add_match_nonblocking( name_owner_rule( name ) );
+
+    /* Ask for the owner without waiting, as this may well be called from
+     * the dispatching thread */
+    std::shared_ptr<CallMessage> msg =
+        CallMessage::create( DBUS_CXX_BUS_NAME, DBUS_CXX_BUS_PATH, DBUS_CXX_BUS_NAME, "GetNameOwner" );
+    msg << name;
+
+    std::weak_ptr<Connection> weak_conn = weak_from_this();
+    std::shared_ptr<PendingCall> pending = send_with_reply_async( msg );
+
+    pending->set_notify( [weak_conn, name]( std::shared_ptr<Message> reply ) {
+        std::shared_ptr<Connection> conn = weak_conn.lock();
+
+        if( conn ) { conn->name_owner_reply( name, reply ); }
+    } );
+}
+
+void Connection::name_owner_reply( const std::string& name, std::shared_ptr<const Message> reply ) {
+    std::string owner;
+
+    if( !reply ) { return; }
+
+    if( reply->type() == MessageType::ERROR ) {
+        std::shared_ptr<const ErrorMessage> errmsg = std::static_pointer_cast<const ErrorMessage>( reply );
+
+        if( errmsg->name() != DBUSCXX_ERROR_NAME_HAS_NO_OWNER ) {
+            SIMPLELOGGER_ERROR( LOGGER_NAME, "Unable to get the owner of " << name << ": " << errmsg->message() );
+            return;
+        }
+    } else {
+        try {
+            reply >> owner;
+        } catch( const Error& ) {
+            return;
+        }
+    }
+
+    std::scoped_lock lock( m_priv->m_watchedNamesLock );
+    std::map<std::string, WatchedName>::iterator it = m_priv->m_watchedNames.find( name );
+
+    /* The match was added before asking, so if NameOwnerChanged has been
+     * seen since then, it is at least as new as the answer */
+    if( it != m_priv->m_watchedNames.end() && it->second.changes == 0 ) {
+        it->second.owner = owner;
+        it->second.resolved = true;
+    }
+}
+
+void Connection::unwatch_name( const std::string& name ) {
+    {
+        std::scoped_lock lock( m_priv->m_watchedNamesLock );
+        std::map<std::string, WatchedName>::iterator it = m_priv->m_watchedNames.find( name );
+
+        if( it == m_priv->m_watchedNames.end() ) { return; }
+
+        it->second.watchers--;
+
+        if( it->second.watchers > 0 ) { return; }
+
+        m_priv->m_watchedNames.erase( it );
+    }
+
+    remove_match( name_owner_rule( name ) );
+}
+
+std::string Connection::name_owner( const std::string& name ) const {
+    if( name.empty() || name[ 0 ] == ':' || name == DBUS_CXX_BUS_NAME ) { return name; }
+
+    {
+        std::scoped_lock lock( m_priv->m_watchedNamesLock );
+        std::map<std::string, WatchedName>::const_iterator it = m_priv->m_watchedNames.find( name );
+
+        if( it != m_priv->m_watchedNames.end() && it->second.resolved ) {
+            return it->second.owner;
+        }
+    }
+
+    try {
+        return m_priv->m_daemonProxy->GetNameOwner( name );
+    } catch( const Error& ) {
+        return std::string();
+    }
+}
+
+sigc::signal<void(std::string, std::string, std::string)>& Connection::signal_name_owner_changed() {
+    return m_priv->m_nameOwnerChanged;
+}
+
+Credentials Connection::credentials( const std::string& name ) {
+    if( !m_priv->m_daemonProxy ) {
+        throw ErrorDisconnected();
+    }
+
+    std::string unique_name = name;
+
+    if( name.empty() || name[ 0 ] != ':' ) {
+        unique_name = name_owner( name );
+
+        if( unique_name.empty() ) {
+            throw ErrorNameHasNoOwner( "Nothing owns the name " + name );
+        }
+    }
+
+    /* The bus itself never goes away, so there is nothing to watch */
+    if( unique_name[ 0 ] != ':' ) {
+        return Credentials( m_priv->m_daemonProxy->GetConnectionCredentials( unique_name ) );
+    }
+
+    {
+        std::scoped_lock lock( m_priv->m_credentialsLock );
+        std::map<std::string, std::optional<Credentials>>::iterator it = m_priv->m_credentials.find( unique_name );
+
+        if( it != m_priv->m_credentials.end() && it->second ) {
+            return *it->second;
+        }
+
+        if( it == m_priv->m_credentials.end() ) {
+            m_priv->m_credentials[ unique_name ];
+        }
+    }
+
+    /* Listen for connections going away before asking, so that the bus
+     * can't tell us about it in between.  One rule covers every cached
+     * name, so it is added once and kept. */
+    if( !m_priv->m_watchingDisconnects.exchange( true ) ) {
+        add_match_nonblocking( disconnected_rule() );
+    }
+
+    std::map<std::string, Variant> values;
+
+    try {
+        values = m_priv->m_daemonProxy->GetConnectionCredentials( unique_name );
+    } catch( const Error& ) {
+        forget_credentials( unique_name );
+        throw;
+    }
+
+    Credentials creds( values );
+
+    std::scoped_lock lock( m_priv->m_credentialsLock );
+    std::map<std::string, std::optional<Credentials>>::iterator it = m_priv->m_credentials.find( unique_name );
+
+    /* If the entry is gone, the connection went away while we were asking */
+    if( it != m_priv->m_credentials.end() ) {
+        it->second = creds;
+    }
+
+    return creds;
+}
+
+void Connection::forget_credentials( const std::string& unique_name ) {
+    std::scoped_lock lock( m_priv->m_credentialsLock );
+
+    m_priv->m_credentials.erase( unique_name );
+}
+
+bool Connection::sender_is( const std::string& name, const std::string& sender ) const {
+    if( name == sender ) { return true; }
+
+    if( name.empty() || name[ 0 ] == ':' ) { return false; }
+
+    std::scoped_lock lock( m_priv->m_watchedNamesLock );
+    std::map<std::string, WatchedName>::const_iterator it = m_priv->m_watchedNames.find( name );
+
+    if( it == m_priv->m_watchedNames.end() ) { return false; }
+
+    /* Until the owner has been looked up, let everything through rather
+     * than drop the signals that the name sends in the meantime */
+    if( !it->second.resolved ) { return true; }
+
+    return it->second.owner == sender;
+}
+
+void Connection::name_owner_changed( std::shared_ptr<const SignalMessage> msg ) {
+    std::string name;
+    std::string old_owner;
+    std::string new_owner;
+
+    try {
+        msg >> name >> old_owner >> new_owner;
+    } catch( const Error& ) {
+        return;
+    }
+
+    /* A unique name that loses its owner has disconnected for good */
+    if( !name.empty() && name[ 0 ] == ':' && new_owner.empty() ) {
+        forget_credentials( name );
+    }
+
+    {
+        std::scoped_lock lock( m_priv->m_watchedNamesLock );
+        std::map<std::string, WatchedName>::iterator it = m_priv->m_watchedNames.find( name );
+
+        if( it == m_priv->m_watchedNames.end() ) { return; }
+
+        it->second.owner = new_owner;
+        it->second.changes++;
+        it->second.resolved = true;
+    }
+
+    SIMPLELOGGER_DEBUG( LOGGER_NAME, "Owner of " << name << " changed from '" << old_owner << "' to '" << new_owner << "'" );
+
+    std::vector<std::shared_ptr<ObjectProxy>> proxies;
+
+    {
+        std::unique_lock lock( m_priv->m_objectProxiesLock );
+
+        for( ObjectProxyThreadInfo& thrInfo : m_priv->m_objectProxies ) {
+            // The others are told from their own thread, by their ownerChanged proxy
+            if( thrInfo.handlingThread == m_priv->m_dispatchingThread &&
+                thrInfo.handler->destination() == name ) {
+                proxies.push_back( thrInfo.handler );
+            }
+        }
+    }
+
+    for( std::shared_ptr<ObjectProxy> proxy : proxies ) {
+        proxy->destination_owner_changed( old_owner, new_owner );
+    }
+
+    m_priv->m_nameOwnerChanged.emit( name, old_owner, new_owner );
+}
+
 StartReply Connection::start_service( const std::string& name, uint32_t flags ) const {
     uint32_t retval = m_priv->m_daemonProxy->StartServiceByName( name, flags );
 
@@ -305,41 +701,196 @@ bool Connection::add_match( const std::string& rule ) {
 
     SIMPLELOGGER_DEBUG( LOGGER_NAME, "Adding the following match: " << rule );
 
-    if( m_priv->m_daemonProxy ) {
-        std::map<std::string,int>::iterator it =
-                m_priv->m_listeningSignals.find( rule );
-        if( it == m_priv->m_listeningSignals.end() ){
-            m_priv->m_listeningSignals[ rule ] = 1;
-        }else{
-            int count = m_priv->m_listeningSignals[ rule ];
-            m_priv->m_listeningSignals[ rule ] = count + 1;
+    if( !m_priv->m_daemonProxy ) { return true; }
+
+    std::shared_ptr<PendingCall> adding;
+
+    {
+        std::unique_lock<std::mutex> lock( m_priv->m_matchLock );
+        ListeningRule& listening = m_priv->m_listeningSignals[ rule ];
+        listening.count++;
+
+        /* Whoever added the rule first asked the bus; share its answer */
+        if( !listening.adding ) {
+            listening.adding = queue_match_call( "AddMatch", rule, false );
         }
-        m_priv->m_daemonProxy->AddMatch( rule );
+
+        adding = listening.adding;
     }
 
-    return true;
+    notify_dispatcher_or_dispatch();
+
+    std::shared_ptr<Message> reply = wait_for_match_reply( adding );
+
+    if( reply && reply->type() != MessageType::ERROR ) {
+        return true;
+    }
+
+    {
+        /* Only take back our own count; anyone else who added the rule in
+         * the meantime still holds theirs */
+        std::unique_lock<std::mutex> lock( m_priv->m_matchLock );
+        std::map<std::string, ListeningRule>::iterator it = m_priv->m_listeningSignals.find( rule );
+
+        if( it != m_priv->m_listeningSignals.end() && --it->second.count <= 0 ) {
+            m_priv->m_listeningSignals.erase( it );
+
+            /* With no answer, the bus may still have added it */
+            if( !reply ) {
+                queue_match_call( "RemoveMatch", rule, false );
+            }
+        }
+    }
+
+    if( !reply ) {
+        throw ErrorNoReply( "No reply to AddMatch for rule " + rule );
+    }
+
+    std::static_pointer_cast<ErrorMessage>( reply )->throw_error();
 }
 
 void Connection::add_match_nonblocking( const std::string& rule ) {
-    //    if ( not this->is_valid() ) return;
-    //    dbus_bus_add_match( m_cobj, rule.c_str(), nullptr );
+    if( !is_valid() ) {
+        throw ErrorDisconnected();
+    }
+
+    SIMPLELOGGER_DEBUG( LOGGER_NAME, "Adding the following match without blocking: " << rule );
+
+    if( !m_priv->m_daemonProxy ) { return; }
+
+    {
+        std::unique_lock<std::mutex> lock( m_priv->m_matchLock );
+        ListeningRule& listening = m_priv->m_listeningSignals[ rule ];
+        listening.count++;
+
+        if( listening.count > 1 ) { return; }
+
+        listening.adding = queue_match_call( "AddMatch", rule, true );
+    }
+
+    notify_dispatcher_or_dispatch();
 }
 
 bool Connection::remove_match( const std::string& rule ) {
-    if( m_priv->m_daemonProxy ){
-        std::map<std::string,int>::iterator it =
+    if( !m_priv->m_daemonProxy || !is_valid() ) { return true; }
+
+    {
+        std::unique_lock<std::mutex> lock( m_priv->m_matchLock );
+        std::map<std::string, ListeningRule>::iterator it =
                 m_priv->m_listeningSignals.find( rule );
-        if( it != m_priv->m_listeningSignals.end() ){
-            int count = m_priv->m_listeningSignals[ rule ];
-            count--;
-            m_priv->m_listeningSignals[ rule ] = count;
 
-            if( count == 0 ){
-                m_priv->m_daemonProxy->RemoveMatch( rule );
-            }
+        if( it == m_priv->m_listeningSignals.end() ) { return true; }
+
+        it->second.count--;
+
+        if( it->second.count > 0 ) { return true; }
+
+        m_priv->m_listeningSignals.erase( it );
+        queue_match_call( "RemoveMatch", rule, true );
+    }
+
+    notify_dispatcher_or_dispatch();
+
+    return true;
+}
+
+sigc::signal<void(std::string, std::string, std::string)>& Connection::signal_match_error() {
+    return m_priv->m_matchError;
+}
+
+std::shared_ptr<PendingCall> Connection::queue_match_call( const std::string& method, const std::string& rule, bool report_error ) {
+    std::shared_ptr<CallMessage> msg =
+        CallMessage::create( "org.freedesktop.DBus", "/org/freedesktop/DBus", "org.freedesktop.DBus", method );
+    msg << rule;
+
+    OutgoingMessage outgoing;
+    outgoing.msg = msg;
+    outgoing.serial = m_priv->next_serial();
+
+    MatchCall call;
+    call.method = method;
+    call.rule = rule;
+    call.pending = PendingCall::create( outgoing.serial );
+    call.report_error = report_error;
+
+    /* Register the serial before the message can be written, so that the
+     * reply can never arrive before we know about it.  The caller holds the
+     * lock that changed the count of the rule, so the calls for a rule go
+     * out in the same order that its count changed. */
+    m_priv->m_pendingMatchCalls[ outgoing.serial ] = call;
+    m_priv->m_outgoingMessages.push( outgoing );
+
+    return call.pending;
+}
+
+std::shared_ptr<Message> Connection::wait_for_match_reply( std::shared_ptr<PendingCall> pending ) {
+    std::chrono::steady_clock::time_point deadline = reply_deadline( -1 );
+
+    if( m_priv->m_dispatchingThread != std::this_thread::get_id() ) {
+        pending->block_until( deadline );
+        return pending->reply();
+    }
+
+    /* Nobody else is going to read the reply for us; any other message
+     * that comes in first is kept for the next dispatch */
+    flush();
+
+    std::vector<int> fds;
+    fds.push_back( m_priv->m_transport->fd() );
+
+    while( !pending->completed() ) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        if( now >= deadline || !m_priv->m_transport->is_valid() ) { break; }
+
+        DBus::priv::wait_for_fd_activity( fds, std::chrono::ceil<std::chrono::milliseconds>( deadline - now ).count() );
+
+        std::shared_ptr<Message> incoming = m_priv->m_transport->readMessage();
+
+        if( !incoming ) { continue; }
+
+        if( incoming->type() == MessageType::RETURN &&
+            process_match_reply( incoming, std::static_pointer_cast<ReturnMessage>( incoming )->reply_serial() ) ) {
+            continue;
+        }
+
+        if( incoming->type() == MessageType::ERROR &&
+            process_match_reply( incoming, std::static_pointer_cast<ErrorMessage>( incoming )->reply_serial() ) ) {
+            continue;
         }
+
+        m_priv->m_incomingMessages.push( incoming );
+    }
+
+    return pending->reply();
+}
+
+bool Connection::process_match_reply( std::shared_ptr<Message> msg, uint32_t reply_serial ) {
+    MatchCall call;
+
+    {
+        std::unique_lock<std::mutex> lock( m_priv->m_matchLock );
+        std::map<uint32_t, MatchCall>::iterator it =
+            m_priv->m_pendingMatchCalls.find( reply_serial );
+
+        if( it == m_priv->m_pendingMatchCalls.end() ) { return false; }
+
+        call = it->second;
+        m_priv->m_pendingMatchCalls.erase( it );
+    }
+
+    /* The rule stays counted even if the bus rejected it, so that whoever
+     * added it still removes it the same number of times */
+
+    if( msg->type() == MessageType::ERROR && call.report_error ) {
+        std::shared_ptr<const ErrorMessage> errmsg = std::static_pointer_cast<const ErrorMessage>( msg );
+        SIMPLELOGGER_ERROR( LOGGER_NAME, call.method << " failed for rule " << call.rule << ": " << errmsg->message() );
+        m_priv->m_matchError( call.rule, errmsg->name(), errmsg->message() );
     }
 
+    // Wake up anyone who is waiting for the rule to be added
+    call.pending->set_reply( msg );
+
     return true;
 }
 
@@ -372,15 +923,18 @@ uint32_t Connection::send( std::shared_ptr<const Message> msg ) {
 
     if( !msg ) { return 0; }
 
-    if( m_priv->m_currentSerial == 0 ) { m_priv->m_currentSerial = 1; }
+    if( !msg->is_valid() ) {
+        /* Replies to calls that were sent with NO_REPLY_EXPECTED are invalid
+         * from the start, so that handlers can run as normal and the reply is
+         * simply dropped here */
+        SIMPLELOGGER_DEBUG( LOGGER_NAME, "Not sending invalid message" );
+        return 0;
+    }
 
     OutgoingMessage outgoing;
-    {
-        std::unique_lock<std::mutex> lock( m_priv->m_outgoingLock );
-        outgoing.msg = msg;
-        outgoing.serial = m_priv->m_currentSerial++;
-        m_priv->m_outgoingMessages.push( outgoing );
-    }
+    outgoing.msg = msg;
+    outgoing.serial = m_priv->next_serial();
+    m_priv->m_outgoingMessages.push( outgoing );
 
     notify_dispatcher_or_dispatch();
 
@@ -397,175 +951,310 @@ std::shared_ptr<ReturnMessage> Connection::send_with_reply_blocking( std::shared
 
     if( !this->is_valid() ) { throw ErrorDisconnected(); }
 
-    if( !message ) { return std::shared_ptr<ReturnMessage>(); }
+    std::shared_ptr<Message> reply = send_with_reply_nothrow( message, timeout_milliseconds );
+
+    if( !reply ) { return std::shared_ptr<ReturnMessage>(); }
+
+    if( reply->type() == MessageType::ERROR ) {
+        std::static_pointer_cast<ErrorMessage>( reply )->throw_error();
+    }
+
+    if( reply->type() != MessageType::RETURN ) {
+        throw ErrorUnknown( "Why are we here" );
+    }
+
+    return std::static_pointer_cast<ReturnMessage>( reply );
+}
+
+std::shared_ptr<Message> Connection::send_with_reply_nothrow( std::shared_ptr<const CallMessage> message, int timeout_milliseconds ) {
+
+    if( !this->is_valid() ) { return disconnected_error( 0 ); }
+
+    if( !message ) { return std::shared_ptr<Message>(); }
+
+    if( !message->expects_reply() ) {
+        /* There will never be a reply to wait for */
+        send( message );
+        return std::shared_ptr<Message>();
+    }
 
-    std::shared_ptr<ReturnMessage> retmsg;
     int msToWait = timeout_milliseconds;
 
     if( msToWait == -1 ) {
         // Use a sane default value
-        msToWait = 20000;
+        msToWait = DEFAULT_REPLY_TIMEOUT_MS;
     }
 
-    if( m_priv->m_dispatchingThread == std::this_thread::get_id() ) {
-        uint32_t replySerialExpceted;
-        bool gotReply = false;
+    if( m_priv->m_dispatchingThread == std::this_thread::get_id() ) {
+        uint32_t replySerialExpceted;
+
+        /*
+         * We are trying to do a blocking method call in the dispatching thread.
+         * Don't queue up this message, just send it.
+         */
+        {
+            std::unique_lock<std::mutex> lock( m_priv->m_writeLock );
+            replySerialExpceted = write_single_message( message );
+        }
+
+        /*
+         * Read messages until we find the one with the serial that we are expecting
+         */
+        std::vector<int> fds;
+        fds.push_back( m_priv->m_transport->fd() );
+
+        for( ;; ) {
+            std::tuple<bool, int, std::vector<int>, std::chrono::milliseconds> fdResponse =
+                DBus::priv::wait_for_fd_activity( fds, msToWait );
+
+            msToWait -= std::get<3>( fdResponse ).count();
+
+            if( msToWait <= 0 ) {
+                return no_reply_error( replySerialExpceted );
+            }
+
+            if( !m_priv->m_transport->is_valid() ) {
+                return disconnected_error( replySerialExpceted );
+            }
+
+            std::shared_ptr<Message> incoming = m_priv->m_transport->readMessage();
+            {
+                std::ostringstream str;
+                str << incoming.get();
+                SIMPLELOGGER_DEBUG( LOGGER_NAME, "Got incoming " << str.str() );
+            }
+
+            if( !incoming ) { continue; }
+
+            // Check to see what type of message we have, and if it might be a reply to our
+            // method call.
+            if( incoming->type() == MessageType::ERROR &&
+                std::static_pointer_cast<ErrorMessage>( incoming )->reply_serial() == replySerialExpceted ) {
+                return incoming;
+            } else if( incoming->type() == MessageType::RETURN &&
+                std::static_pointer_cast<ReturnMessage>( incoming )->reply_serial() == replySerialExpceted ) {
+                return incoming;
+            }
+
+            m_priv->m_incomingMessages.push( incoming );
+        }
+    }
+
+    /*
+     * We are trying to do a blocking method call in a thread that is not the dispatcher thread.
+     * Queue up the message and notify the dispatcher thread.
+     */
+    uint32_t serial = m_priv->next_serial();
+    std::shared_ptr<Message> reply;
+
+    /* Reserve the reply slot before the message is queued, so that
+     * the reply can never arrive before we know about it */
+    if( m_priv->m_replySlots.reserve( serial ) ) {
+        OutgoingMessage outgoing;
+        outgoing.msg = message;
+        outgoing.serial = serial;
+        m_priv->m_outgoingMessages.push( outgoing );
+
+        notify_dispatcher_or_dispatch();
+
+        reply = m_priv->m_replySlots.wait( serial, reply_deadline( msToWait ) );
+
+        if( !reply ) {
+            return no_reply_error( serial );
+        }
+
+        return reply;
+    }
+
+    /*
+     * Another call that is still outstanding has the same slot; this
+     * is rare, so just wait for this one like an asynchronous call.
+     */
+    std::shared_ptr<PendingCall> pending = send_with_reply_async( message, msToWait );
+    pending->block();
+    reply = pending->reply();
+
+    if( !reply ) {
+        return disconnected_error( pending->serial() );
+    }
+
+    return reply;
+}
+
+std::shared_ptr<PendingCall> Connection::send_with_reply_async( std::shared_ptr<const CallMessage> message, int timeout_milliseconds ) {
+    if( !this->is_valid() ) { throw ErrorDisconnected(); }
+
+    if( !message ) { return std::shared_ptr<PendingCall>(); }
+
+    std::shared_ptr<PendingCall> pending;
+    OutgoingMessage outgoing;
+    outgoing.msg = message;
+    outgoing.serial = m_priv->next_serial();
+    pending = PendingCall::create( outgoing.serial );
+
+    {
+        /* Register the serial before the message is queued, so that
+         * the reply can never arrive before we know about it */
+        std::unique_lock<std::mutex> lock( m_priv->m_expectingResponsesLock );
+        m_priv->m_pendingCalls[ outgoing.serial ] = pending;
+        m_priv->m_replyTimeouts.add( outgoing.serial, reply_deadline( timeout_milliseconds ) );
+    }
+
+    m_priv->m_outgoingMessages.push( outgoing );
+
+    notify_dispatcher_or_dispatch();
+
+    return pending;
+}
+
+std::vector<std::shared_ptr<Message>> Connection::send_with_reply_batch( const std::vector<std::shared_ptr<const CallMessage>>& messages,
+                                                                         int timeout_milliseconds ) {
+    if( !this->is_valid() ) { throw ErrorDisconnected(); }
+
+    std::vector<std::shared_ptr<Message>> replies( messages.size() );
+    std::chrono::steady_clock::time_point deadline = reply_deadline( timeout_milliseconds );
+
+    if( messages.empty() ) { return replies; }
 
+    if( m_priv->m_dispatchingThread == std::this_thread::get_id() ) {
         /*
-         * We are trying to do a blocking method call in the dispatching thread.
-         * Don't queue up this message, just send it.
+         * Nobody else is going to read the replies for us, so write out
+         * everything and read until we have them all.
          */
+        std::map<uint32_t, size_t> outstanding;
+
         {
-            std::unique_lock<std::mutex> lock( m_priv->m_outgoingLock );
-            replySerialExpceted = write_single_message( message );
+            std::unique_lock<std::mutex> lock( m_priv->m_writeLock );
+
+            for( size_t x = 0; x < messages.size(); x++ ) {
+                outstanding[ write_single_message( messages[ x ] ) ] = x;
+            }
         }
 
-        /*
-         * Read messages until we find the one with the serial that we are expecting
-         */
         std::vector<int> fds;
         fds.push_back( m_priv->m_transport->fd() );
 
-        do {
-            std::tuple<bool, int, std::vector<int>, std::chrono::milliseconds> fdResponse =
-                DBus::priv::wait_for_fd_activity( fds, msToWait );
+        while( !outstanding.empty() ) {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 
-            msToWait -= std::get<3>( fdResponse ).count();
+            if( now >= deadline ) { break; }
 
-            if( msToWait <= 0 ) {
-                throw ErrorNoReply( "Did not receive a response in the alotted time" );
-            }
+            DBus::priv::wait_for_fd_activity( fds,
+                std::chrono::ceil<std::chrono::milliseconds>( deadline - now ).count() );
 
-            if( !m_priv->m_transport->is_valid() ) {
-                throw ErrorDisconnected();
-            }
+            /* Nothing more is coming; the replies that did arrive are still good */
+            if( !m_priv->m_transport->is_valid() ) { break; }
 
             std::shared_ptr<Message> incoming = m_priv->m_transport->readMessage();
-            {
-                std::ostringstream str;
-                str << incoming.get();
-                SIMPLELOGGER_DEBUG( LOGGER_NAME, "Got incoming " << str.str() );
+
+            if( !incoming ) { continue; }
+
+            uint32_t reply_serial = 0;
+
+            if( incoming->type() == MessageType::RETURN ) {
+                reply_serial = std::static_pointer_cast<ReturnMessage>( incoming )->reply_serial();
+            } else if( incoming->type() == MessageType::ERROR ) {
+                reply_serial = std::static_pointer_cast<ErrorMessage>( incoming )->reply_serial();
             }
 
-            if( incoming ) {
-                // Check to see what type of message we have, and if it might be a reply to our
-                // method call.
-                if( incoming->type() == MessageType::ERROR ) {
-                    std::shared_ptr<ErrorMessage> errmsg = std::static_pointer_cast<ErrorMessage>( incoming );
-
-                    if( errmsg->reply_serial() == replySerialExpceted ) {
-                        errmsg->throw_error();
-                    }
-                } else if( incoming->type() == MessageType::RETURN ) {
-                    retmsg = std::static_pointer_cast<ReturnMessage>( incoming );
-
-                    if( retmsg->reply_serial() == replySerialExpceted ) {
-                        gotReply = true;
-                    }
-                }
+            std::map<uint32_t, size_t>::iterator it = outstanding.find( reply_serial );
 
-                if( !gotReply ) {
-                    m_priv->m_incomingMessages.push( incoming );
-                }
+            if( it == outstanding.end() ) {
+                m_priv->m_incomingMessages.push( incoming );
+                continue;
+            }
+
+            replies[ it->second ] = incoming;
+            outstanding.erase( it );
+        }
 
+        for( std::pair<const uint32_t, size_t>& missing : outstanding ) {
+            if( m_priv->m_transport->is_valid() ) {
+                replies[ missing.second ] = no_reply_error( missing.first );
+            } else {
+                replies[ missing.second ] = disconnected_error( missing.first );
             }
-        } while( !gotReply );
+        }
 
-    } else {
-        /*
-         * We are trying to do a blocking method call in a thread that is not the dispatcher thread.
-         * Queue up the message and notify the dispatcher thread.
-         */
-        uint32_t serial;
-        std::shared_ptr<ExpectingResponse> ex;
+        return replies;
+    }
 
-        {
-            OutgoingMessage outgoing;
-            std::scoped_lock<std::mutex, std::mutex> lock( m_priv->m_outgoingLock, m_priv->m_expectingResponsesLock );
-            outgoing.msg = message;
-            outgoing.serial = m_priv->m_currentSerial++;
-            m_priv->m_outgoingMessages.push( outgoing );
-            serial = outgoing.serial;
-
-            // Add this to our expecting responses
-            ex = std::make_shared<ExpectingResponse>();
-            m_priv->m_expectingResponses[ serial ] = ex;
+    std::vector<std::shared_ptr<PendingCall>> pendings;
+    std::vector<OutgoingMessage> outgoing( messages.size() );
+
+    {
+        /* Register every serial before any message is queued */
+        std::unique_lock<std::mutex> lock( m_priv->m_expectingResponsesLock );
+
+        for( size_t x = 0; x < messages.size(); x++ ) {
+            outgoing[ x ].msg = messages[ x ];
+            outgoing[ x ].serial = m_priv->next_serial();
+            pendings.push_back( PendingCall::create( outgoing[ x ].serial ) );
+            m_priv->m_pendingCalls[ outgoing[ x ].serial ] = pendings.back();
+            m_priv->m_replyTimeouts.add( outgoing[ x ].serial, deadline );
         }
+    }
 
-        notify_dispatcher_or_dispatch();
+    m_priv->m_outgoingMessages.push_all( std::move( outgoing ) );
 
-        {
-            /*
-             * Lock on the expecting response; when the response comes in, we will notify from
-             * the dispatching thread
-             */
-            std::chrono::time_point now = std::chrono::steady_clock::now();
-            std::unique_lock<std::mutex> lock( ex->cv_lock );
-            bool status = ex->cv.wait_until( lock, now + std::chrono::milliseconds( msToWait ), [this, serial] {
-                std::unique_lock<std::mutex> lock( m_priv->m_expectingResponsesLock );
-                std::map<uint32_t, std::shared_ptr<ExpectingResponse>>::iterator it =
-                    m_priv->m_expectingResponses.find( serial );
+    notify_dispatcher_or_dispatch();
 
-                // return false if the waiting should be continued
-                return ( *it ).second->reply.get() != nullptr;
-            } );
-            std::shared_ptr<ExpectingResponse> resp;
+    /* Every call has the same deadline, so this waits no longer than the timeout in total */
+    for( size_t x = 0; x < pendings.size(); x++ ) {
+        uint32_t serial = pendings[ x ]->serial();
+
+        if( !pendings[ x ]->block_until( deadline ) ) {
+            /* The dispatcher may not be running the timer wheel, so expire
+             * the call here unless the dispatcher got to it first */
+            bool expired = false;
 
             {
-                /*
-                 * Now remove our expecting response to free up memory
-                 */
                 std::unique_lock<std::mutex> lock( m_priv->m_expectingResponsesLock );
-                std::map<uint32_t, std::shared_ptr<ExpectingResponse>>::iterator it =
-                        m_priv->m_expectingResponses.find( serial );
-                resp = ( *it ).second;
-
-                m_priv->m_expectingResponses.erase( it );
-            }
+                std::map<uint32_t, std::shared_ptr<PendingCall>>::iterator it =
+                    m_priv->m_pendingCalls.find( serial );
 
-            if( !resp ) {
-                throw ErrorUnexpectedResponse();
+                if( it != m_priv->m_pendingCalls.end() ) {
+                    m_priv->m_pendingCalls.erase( it );
+                    m_priv->m_replyTimeouts.remove( serial );
+                    expired = true;
+                }
             }
 
-            if( status ) {
-                std::shared_ptr<Message> gotMessage = resp->reply;
-
-                if( gotMessage->type() == MessageType::RETURN ) {
-                    retmsg = std::static_pointer_cast<ReturnMessage>( gotMessage );
-                } else if( gotMessage->type() == MessageType::ERROR ) {
-                    std::shared_ptr<ErrorMessage> errmsg = std::static_pointer_cast<ErrorMessage>( gotMessage );
-                    errmsg->throw_error();
-                } else if( gotMessage->type() == MessageType::SIGNAL ) {
-                } else {
-                    throw ErrorUnknown( "Why are we here" );
-                }
+            if( expired ) {
+                pendings[ x ]->set_reply( no_reply_error( serial ) );
             } else {
-                throw ErrorNoReply( "Did not receive a response in the alotted time" );
+                pendings[ x ]->block();
             }
         }
+
+        replies[ x ] = pendings[ x ]->reply();
+
+        if( !replies[ x ] ) {
+            replies[ x ] = disconnected_error( serial );
+        }
     }
 
-    return retmsg;
+    return replies;
 }
 
 void Connection::flush() {
     if( !this->is_valid() ) { return; }
 
-    {
-        std::unique_lock lock( m_priv->m_outgoingLock );
-
-        while( !m_priv->m_outgoingMessages.empty() ) {
-            OutgoingMessage outgoing = m_priv->m_outgoingMessages.front();
-            m_priv->m_outgoingMessages.pop();
+    /*
+     * Only writers wait on this lock; threads queueing up messages never do.
+     * Messages queued while we are writing go out on the next flush.
+     */
+    std::unique_lock<std::mutex> lock( m_priv->m_writeLock );
+    std::vector<OutgoingMessage> outgoing = m_priv->m_outgoingMessages.take_all();
 
-            m_priv->m_transport->writeMessage( outgoing.msg, outgoing.serial );
-        }
+    for( const OutgoingMessage& out : outgoing ) {
+        m_priv->m_transport->writeMessage( out.msg, out.serial );
     }
 }
 
 uint32_t Connection::write_single_message( std::shared_ptr<const Message> msg ) {
-    uint32_t retval = m_priv->m_currentSerial;
-    m_priv->m_transport->writeMessage( msg, m_priv->m_currentSerial++ );
+    uint32_t retval = m_priv->next_serial();
+    m_priv->m_transport->writeMessage( msg, retval );
     return retval;
 }
 
@@ -585,6 +1274,10 @@ DispatchStatus Connection::dispatch( ) {
         return DispatchStatus::COMPLETE;
     }
 
+    for( std::function<void()>& work : m_priv->m_deferredWork.take_all() ) {
+        work();
+    }
+
     // Write out any messages we have waiting to be written
     flush();
 
@@ -601,8 +1294,11 @@ DispatchStatus Connection::dispatch( ) {
     // Process any messages that we need to
     process_single_message();
 
+    process_reply_timeouts();
+
     if( m_priv->m_outgoingMessages.empty() &&
-        m_priv->m_incomingMessages.empty() ) {
+        m_priv->m_incomingMessages.empty() &&
+        m_priv->m_deferredWork.empty() ) {
         m_priv->m_dispatchStatus = DispatchStatus::COMPLETE;
     } else {
         m_priv->m_dispatchStatus = DispatchStatus::DATA_REMAINS;
@@ -611,6 +1307,56 @@ DispatchStatus Connection::dispatch( ) {
     return m_priv->m_dispatchStatus;
 }
 
+int Connection::next_timeout_milliseconds() const {
+    std::chrono::steady_clock::time_point deadline;
+
+    {
+        std::unique_lock<std::mutex> lock( m_priv->m_expectingResponsesLock );
+        deadline = m_priv->m_replyTimeouts.next_deadline();
+    }
+
+    if( deadline == std::chrono::steady_clock::time_point::max() ) {
+        return -1;
+    }
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    if( deadline <= now ) {
+        return 0;
+    }
+
+    return std::chrono::ceil<std::chrono::milliseconds>( deadline - now ).count();
+}
+
+void Connection::process_reply_timeouts() {
+    std::vector<std::pair<std::shared_ptr<PendingCall>, std::shared_ptr<ErrorMessage>>> timedOut;
+
+    {
+        std::unique_lock<std::mutex> lock( m_priv->m_expectingResponsesLock );
+
+        if( m_priv->m_replyTimeouts.empty() ) { return; }
+
+        std::vector<uint32_t> expired = m_priv->m_replyTimeouts.advance( std::chrono::steady_clock::now() );
+
+        for( uint32_t serial : expired ) {
+            std::shared_ptr<ErrorMessage> errmsg = no_reply_error( serial );
+
+            std::map<uint32_t, std::shared_ptr<PendingCall>>::iterator pendingIt =
+                m_priv->m_pendingCalls.find( serial );
+
+            if( pendingIt != m_priv->m_pendingCalls.end() ) {
+                timedOut.push_back( std::make_pair( pendingIt->second, errmsg ) );
+                m_priv->m_pendingCalls.erase( pendingIt );
+            }
+        }
+    }
+
+    for( std::pair<std::shared_ptr<PendingCall>, std::shared_ptr<ErrorMessage>>& expired : timedOut ) {
+        SIMPLELOGGER_DEBUG( LOGGER_NAME, "Call with serial " << expired.first->serial() << " timed out" );
+        expired.first->set_reply( expired.second );
+    }
+}
+
 void Connection::process_single_message() {
     std::shared_ptr<Message> msgToProcess;
 
@@ -629,22 +1375,42 @@ void Connection::process_single_message() {
             reply_serial = std::static_pointer_cast<ErrorMessage>( msgToProcess )->reply_serial();
         }
 
+        if( m_priv->m_replySlots.complete( reply_serial, msgToProcess ) ) {
+            // This is a response to something that a different thread is blocked on
+            return;
+        }
+
+        std::shared_ptr<PendingCall> pending;
+
         {
             std::unique_lock<std::mutex> lock( m_priv->m_expectingResponsesLock );
-            if( m_priv->m_expectingResponses.find( reply_serial ) != m_priv->m_expectingResponses.end() ) {
-                // This is a response to something that a different thread is waiting for.
-                // Update the data and notify the thread!
-                m_priv->m_expectingResponses[ reply_serial ]->reply = msgToProcess;
-                m_priv->m_expectingResponses[ reply_serial ]->cv.notify_one();
-                return;
+            m_priv->m_replyTimeouts.remove( reply_serial );
+
+            std::map<uint32_t, std::shared_ptr<PendingCall>>::iterator it =
+                m_priv->m_pendingCalls.find( reply_serial );
+
+            if( it != m_priv->m_pendingCalls.end() ) {
+                pending = it->second;
+                m_priv->m_pendingCalls.erase( it );
             }
         }
+
+        if( pending ) {
+            // Call the notify slot without holding any locks, it may well make another call
+            pending->set_reply( msgToProcess );
+            return;
+        }
+
+        if( process_match_reply( msgToProcess, reply_serial ) ) {
+            return;
+        }
     }
 
     std::shared_ptr<CallMessage> callmsg;
 
     if( msgToProcess->type() == MessageType::CALL ) {
         callmsg = std::static_pointer_cast<CallMessage>( msgToProcess );
+        callmsg->set_received_on( shared_from_this() );
         process_call_message( callmsg );
     } else if( msgToProcess->type() == MessageType::SIGNAL ) {
         std::shared_ptr<SignalMessage> signalmsg = std::static_pointer_cast<SignalMessage>( msgToProcess );
@@ -656,29 +1422,17 @@ void Connection::process_single_message() {
 }
 
 void Connection::process_call_message( std::shared_ptr<const CallMessage> callmsg ) {
-    std::string path = callmsg->path();
-    PathHandlingEntry entry;
-    bool error = false;
-
-    {
-        std::unique_lock<std::mutex> lock( m_priv->m_pathHandlerLock );
-        std::map<std::string, PathHandlingEntry>::iterator it;
-        it = m_priv->m_path_handler.find( path );
-
-        if( it != m_priv->m_path_handler.end() ) {
-            entry = it->second;
-        } else {
-            error = true;
-        }
-    }
+    std::optional<PathHandlingEntry> found = m_priv->m_path_handler.find( callmsg->path() );
 
-    if( error && callmsg ) {
+    if( !found ) {
         std::shared_ptr<ErrorMessage> errMsg =
             ErrorMessage::create( callmsg, DBUSCXX_ERROR_FAILED, "Could not find given path" );
         send( errMsg );
         return;
     }
 
+    PathHandlingEntry entry = *found;
+
     if( entry.handlingThread == m_priv->m_dispatchingThread ) {
         // We are in the dispatching thread here, so we can simply call the handle method
         HandlerResult res = entry.handler->handle_message( callmsg );
@@ -704,31 +1458,75 @@ void Connection::process_call_message( std::shared_ptr<const CallMessage> callms
 }
 
 void Connection::process_signal_message( std::shared_ptr<const SignalMessage> msg ) {
+    // Threads other than the dispatcher thread that have at least one
+    // proxy that this signal matches.  Only these ThreadDispatchers get the signal.
+    std::vector<std::thread::id> interestedThreads;
+    std::vector<std::shared_ptr<SignalProxyBase>> proxies;
+    const std::string interface_name = msg->interface_name();
+    const std::string member = msg->member();
+
+    // Keep the owners of watched names up to date before any proxy looks at them
+    if( member == "NameOwnerChanged" && interface_name == DBUS_CXX_BUS_NAME && msg->sender() == DBUS_CXX_BUS_NAME ) {
+        name_owner_changed( msg );
+    }
+
     {
-        // See if any of our free handlers can handle this
+        // Find the free handlers that can handle this
         std::unique_lock<std::mutex> lock( m_priv->m_freeProxySignalsLock );
+        const SignalRoutingKey keys[] = {
+            SignalRoutingKey( interface_name, member ),
+            SignalRoutingKey( interface_name, "" ),
+            SignalRoutingKey( "", member ),
+            SignalRoutingKey( "", "" )
+        };
+
+        for( size_t x = 0; x < 4; x++ ) {
+            // With an empty interface or member in the message, some keys are duplicates
+            if( std::find( keys, keys + x, keys[ x ] ) != keys + x ) {
+                continue;
+            }
 
-        for( FreeSignalThreadInfo& sigInfo : m_priv->m_freeProxySignals ) {
-            if( sigInfo.handlingThread != m_priv->m_dispatchingThread ){
+            SignalRoutingTable::iterator bucket = m_priv->m_freeProxySignals.find( keys[ x ] );
+
+            if( bucket == m_priv->m_freeProxySignals.end() ) {
                 continue;
             }
 
-            sigInfo.handler->handle_signal( msg );
+            for( FreeSignalThreadInfo& sigInfo : bucket->second ) {
+                if( !sigInfo.handler->matches( msg ) ) {
+                    continue;
+                }
+
+                if( sigInfo.handlingThread == m_priv->m_dispatchingThread ) {
+                    proxies.push_back( sigInfo.handler );
+                } else if( std::find( interestedThreads.begin(), interestedThreads.end(), sigInfo.handlingThread ) == interestedThreads.end() ) {
+                    interestedThreads.push_back( sigInfo.handlingThread );
+                }
+            }
         }
     }
 
-    std::vector<std::shared_ptr<SignalProxyBase>> proxies;
     {
-        // Tell all of our normal ObjectProxy classes to handle it as well
+        // Find our normal ObjectProxy classes that can handle it as well
         std::unique_lock lock( m_priv->m_objectProxiesLock );
+        const Path path = msg->path();
 
         for( ObjectProxyThreadInfo& thrInfo : m_priv->m_objectProxies ){
             if( thrInfo.handlingThread != m_priv->m_dispatchingThread ){
                 continue;
             }
 
-            for( std::pair<std::string,std::shared_ptr<InterfaceProxy>> iface : thrInfo.handler->interfaces() ){
-                for( std::shared_ptr<SignalProxyBase> signal : iface.second->signals() ){
+            if( thrInfo.handler->path() != path ){
+                continue;
+            }
+
+            std::shared_ptr<InterfaceProxy> iface = thrInfo.handler->interface_by_name( interface_name );
+            if( !iface ){
+                continue;
+            }
+
+            for( std::shared_ptr<SignalProxyBase> signal : iface->signals() ){
+                if( signal->name() == member ){
                     proxies.push_back( signal );
                 }
             }
@@ -739,12 +1537,23 @@ void Connection::process_signal_message( std::shared_ptr<const SignalMessage> ms
         proxyBase->handle_signal( msg );
     }
 
-    // Give this signal to all of our ThreadDispatchers as well
+    if( interestedThreads.empty() ) {
+        return;
+    }
+
+    // Give this signal to the ThreadDispatchers that can handle it
     {
         std::unique_lock<std::mutex> lock( m_priv->m_threadDispatcherLock );
 
-        for( auto const& x : m_priv->m_threadDispatchers ) {
-            std::shared_ptr<ThreadDispatcher> disp = x.second.lock();
+        for( std::thread::id threadId : interestedThreads ) {
+            std::map<std::thread::id, std::weak_ptr<ThreadDispatcher>>::iterator iter =
+                m_priv->m_threadDispatchers.find( threadId );
+
+            if( iter == m_priv->m_threadDispatchers.end() ) {
+                continue;
+            }
+
+            std::shared_ptr<ThreadDispatcher> disp = iter->second.lock();
 
             if( disp ) {
                 disp->add_signal( msg );
@@ -793,6 +1602,24 @@ void Connection::send_error_on_handler_result( std::shared_ptr<const CallMessage
     send( errMsg );
 }
 
+uint32_t Connection::outstanding_replies() const {
+    return m_priv->m_outstandingReplies.load( std::memory_order_relaxed );
+}
+
+void Connection::add_outstanding_reply() {
+    m_priv->m_outstandingReplies.fetch_add( 1, std::memory_order_relaxed );
+}
+
+void Connection::remove_outstanding_reply() {
+    m_priv->m_outstandingReplies.fetch_sub( 1, std::memory_order_relaxed );
+}
+
+void Connection::run_before_next_flush( std::function<void()> work ) {
+    m_priv->m_deferredWork.push( std::move( work ) );
+    m_priv->m_dispatchStatus = DispatchStatus::DATA_REMAINS;
+    m_priv->m_needsDispatching();
+}
+
 int Connection::unix_fd() const {
     if( !this->is_valid() ) { return -1; }
 
@@ -832,46 +1659,119 @@ RegistrationStatus Connection::register_object( std::shared_ptr<Object> object,
 
     SIMPLELOGGER_DEBUG( LOGGER_NAME, "Connection::register_object at path " << object->path() );
 
-    std::unique_lock<std::mutex> lock( m_priv->m_pathHandlerLock );
+    return register_object_on_thread( object, thread_id_from_calling( calling ), false );
+}
 
-    if( m_priv->m_path_handler.find( object->path() ) != m_priv->m_path_handler.end() ) {
-        return RegistrationStatus::Failed_Path_in_Use;
-    }
+RegistrationStatus Connection::register_fallback( std::shared_ptr<Object> object, ThreadForCalling calling ) {
+    if( !object ) { return RegistrationStatus::Failed_Invalid_Object; }
 
-    PathHandlingEntry entry;
-    entry.handler = object;
+    SIMPLELOGGER_DEBUG( LOGGER_NAME, "Connection::register_fallback at path " << object->path() );
 
-    if( calling == ThreadForCalling::DispatcherThread ) {
-        entry.handlingThread = m_priv->m_dispatchingThread;
-    } else {
-        entry.handlingThread = std::this_thread::get_id();
+    return register_object_on_thread( object, thread_id_from_calling( calling ), true );
+}
+
+RegistrationStatus Connection::register_child_object( const Object& parent, std::shared_ptr<Object> child ) {
+    if( !child ) { return RegistrationStatus::Failed_Invalid_Object; }
+
+    std::thread::id handlingThread = m_priv->m_dispatchingThread;
+
+    {
+        std::unique_lock<std::mutex> lock( m_priv->m_pathHandlerLock );
+
+        for( bool fallback : { false, true } ) {
+            std::optional<PathHandlingEntry> entry = m_priv->m_path_handler.get( parent.path(), fallback );
+
+            if( entry && entry->handler.get() == &parent ) {
+                handlingThread = entry->handlingThread;
+                break;
+            }
+        }
     }
 
-    m_priv->m_path_handler[ object->path() ] = entry;
+    SIMPLELOGGER_DEBUG( LOGGER_NAME, "Connection::register_child_object at path " << child->path() );
+
+    return register_object_on_thread( child, handlingThread, false );
+}
+
+RegistrationStatus Connection::register_object_on_thread( std::shared_ptr<Object> object, std::thread::id handlingThread, bool fallback ) {
+    {
+        std::unique_lock<std::mutex> lock( m_priv->m_pathHandlerLock );
+
+        if( m_priv->m_path_handler.get( object->path(), fallback ) ) {
+            return RegistrationStatus::Failed_Path_in_Use;
+        }
+
+        PathHandlingEntry entry;
+        entry.handler = object;
+        entry.handlingThread = handlingThread;
+
+        m_priv->m_path_handler.set( object->path(), entry, fallback );
+    }
 
     object->set_connection( shared_from_this() );
 
+    if( !fallback && !object->interfaces().empty() ) {
+        std::shared_ptr<Object> manager = object_manager_for( object->path() );
+
+        if( manager ) { manager->send_interfaces_added( object->path(), object->interface_list() ); }
+    }
+
     return RegistrationStatus::Success;
 }
 
+std::vector<std::shared_ptr<Object>> Connection::objects_below( const std::string& path ) {
+    std::vector<std::shared_ptr<Object>> objects;
+    std::unique_lock<std::mutex> lock( m_priv->m_pathHandlerLock );
+
+    m_priv->m_path_handler.for_each_below( path, [&objects]( const PathHandlingEntry & entry ) {
+        objects.push_back( entry.handler );
+    } );
+
+    return objects;
+}
+
+bool Connection::is_registered_at_path( const Object& object ) {
+    std::unique_lock<std::mutex> lock( m_priv->m_pathHandlerLock );
+    std::optional<PathHandlingEntry> entry = m_priv->m_path_handler.get( object.path(), false );
+
+    return entry && entry->handler.get() == &object;
+}
+
+std::shared_ptr<Object> Connection::object_manager_for( const std::string& path ) const {
+    std::string parent = path;
+
+    while( parent.size() > 1 ) {
+        size_t last_slash = parent.rfind( '/' );
+        parent.resize( last_slash == 0 ? 1 : last_slash );
+
+        std::optional<PathHandlingEntry> entry = m_priv->m_path_handler.find( parent );
+
+        if( entry && entry->handler->path() == parent && entry->handler->is_object_manager() ) {
+            return entry->handler;
+        }
+    }
+
+    return std::shared_ptr<Object>();
+}
+
 bool Connection::change_object_calling_thread( std::shared_ptr<Object> object,
                                    ThreadForCalling calling ){
     std::unique_lock lock( m_priv->m_pathHandlerLock );
-    std::map<std::string,PathHandlingEntry>::iterator it = m_priv->m_path_handler.find( object->path() );
+    bool found = false;
 
-    if( it == m_priv->m_path_handler.end() ) {
-        return false;
-    }
+    for( bool fallback : { false, true } ) {
+        std::optional<PathHandlingEntry> entry = m_priv->m_path_handler.get( object->path(), fallback );
 
-    PathHandlingEntry entry = it->second;
-    if( calling == ThreadForCalling::DispatcherThread ) {
-        entry.handlingThread = m_priv->m_dispatchingThread;
-    } else {
-        entry.handlingThread = std::this_thread::get_id();
+        if( !entry || entry->handler != object ) {
+            continue;
+        }
+
+        entry->handlingThread = thread_id_from_calling( calling );
+        m_priv->m_path_handler.set( object->path(), *entry, fallback );
+        found = true;
     }
-    m_priv->m_path_handler[ object->path() ] = entry;
 
-    return true;
+    return found;
 }
 
 std::shared_ptr<ObjectProxy> Connection::create_object_proxy( const std::string& path, ThreadForCalling calling ) {
@@ -887,16 +1787,29 @@ std::shared_ptr<ObjectProxy> Connection::create_object_proxy( const std::string&
 }
 
 bool Connection::unregister_object( const std::string& path ) {
-    std::unique_lock<std::mutex> lock( m_priv->m_pathHandlerLock );
-    std::map<std::string, PathHandlingEntry>::iterator it;
-    it = m_priv->m_path_handler.find( path );
+    std::optional<PathHandlingEntry> removed;
 
-    if( it != m_priv->m_path_handler.end() ) {
-        m_priv->m_path_handler.erase( it );
-        return true;
+    {
+        std::unique_lock<std::mutex> lock( m_priv->m_pathHandlerLock );
+
+        removed = m_priv->m_path_handler.get( path, false );
+
+        if( !removed ) {
+            return m_priv->m_path_handler.remove( path, true );
+        }
+
+        m_priv->m_path_handler.remove( path, false );
     }
 
-    return false;
+    std::vector<std::shared_ptr<Interface>> interfaces = removed->handler->interface_list();
+
+    if( !interfaces.empty() ) {
+        std::shared_ptr<Object> manager = object_manager_for( path );
+
+        if( manager ) { manager->send_interfaces_removed( path, interfaces ); }
+    }
+
+    return true;
 }
 
 std::shared_ptr<SignalProxyBase> Connection::add_free_signal_proxy( std::shared_ptr<SignalProxyBase> signal, ThreadForCalling calling ) {
@@ -912,8 +1825,9 @@ std::shared_ptr<SignalProxyBase> Connection::add_free_signal_proxy( std::shared_
 
     {
         std::unique_lock<std::mutex> lock( m_priv->m_freeProxySignalsLock );
+        SignalRoutingKey key( signal->interface_name(), signal->name() );
 
-        m_priv->m_freeProxySignals.push_back( signalThreadinfo );
+        m_priv->m_freeProxySignals[ key ].push_back( signalThreadinfo );
     }
 
     if( signalThreadinfo.handlingThread != m_priv->m_dispatchingThread ) {
@@ -937,9 +1851,12 @@ std::shared_ptr<SignalProxyBase> Connection::add_free_signal_proxy( std::shared_
         thrDispatch->add_signal_proxy( signal );
     }
 
-    this->add_match( signal->match_rule() );
+    this->add_match_nonblocking( signal->match_rule() );
     signal->set_connection( shared_from_this() );
 
+    // So that signals from the unique name that owns the sender can be matched
+    watch_name( signal->sender() );
+
     return signal;
 }
 
@@ -951,33 +1868,48 @@ bool Connection::remove_free_signal_proxy( std::shared_ptr<SignalProxyBase> sign
     this->remove_match( signal->match_rule() );
 
     bool removed = false;
+    std::thread::id handlingThread = m_priv->m_dispatchingThread;
 
     {
         std::unique_lock<std::mutex> lock( m_priv->m_freeProxySignalsLock );
 
-        std::vector<FreeSignalThreadInfo>::iterator it;
-        for( it = m_priv->m_freeProxySignals.begin();
-             it != m_priv->m_freeProxySignals.end();
-             it++ ){
-            if( it->handler == signal ){
-                break;
+        SignalRoutingTable::iterator bucket =
+            m_priv->m_freeProxySignals.find( SignalRoutingKey( signal->interface_name(), signal->name() ) );
+
+        if( bucket == m_priv->m_freeProxySignals.end() ||
+            !remove_signal_from_bucket( bucket->second, signal, &handlingThread ) ) {
+            // The interface or member has been changed since it was added; look everywhere
+            for( bucket = m_priv->m_freeProxySignals.begin(); bucket != m_priv->m_freeProxySignals.end(); bucket++ ){
+                if( remove_signal_from_bucket( bucket->second, signal, &handlingThread ) ){
+                    break;
+                }
             }
         }
 
-        if( it != m_priv->m_freeProxySignals.end() ) {
-            m_priv->m_freeProxySignals.erase( it );
+        if( bucket != m_priv->m_freeProxySignals.end() ) {
+            if( bucket->second.empty() ) {
+                m_priv->m_freeProxySignals.erase( bucket );
+            }
+
             removed = true;
         }
     }
 
-    {
+    if( removed ) {
+        unwatch_name( signal->sender() );
+    }
+
+    if( handlingThread != m_priv->m_dispatchingThread ) {
+        // Only the ThreadDispatcher for the handling thread knows about this proxy
         std::unique_lock<std::mutex> lock( m_priv->m_threadDispatcherLock );
+        std::map<std::thread::id, std::weak_ptr<ThreadDispatcher>>::iterator iter =
+            m_priv->m_threadDispatchers.find( handlingThread );
 
-        for( auto const& x : m_priv->m_threadDispatchers ) {
-            std::shared_ptr<ThreadDispatcher> disp = x.second.lock();
+        if( iter != m_priv->m_threadDispatchers.end() ) {
+            std::shared_ptr<ThreadDispatcher> disp = iter->second.lock();
 
-            if( disp && disp->remove_signal_proxy( signal ) ) {
-                removed = true;
+            if( disp ) {
+                disp->remove_signal_proxy( signal );
             }
         }
     }
@@ -989,19 +1921,24 @@ const std::vector<std::shared_ptr<SignalProxyBase>> Connection::get_free_signal_
     std::unique_lock lock( m_priv->m_freeProxySignalsLock );
     std::vector<std::shared_ptr<SignalProxyBase>> retval;
 
-    for( FreeSignalThreadInfo thrInfo : m_priv->m_freeProxySignals ){
-        retval.push_back( thrInfo.handler );
+    for( const std::pair<const SignalRoutingKey, std::vector<FreeSignalThreadInfo>>& bucket : m_priv->m_freeProxySignals ){
+        for( const FreeSignalThreadInfo& thrInfo : bucket.second ){
+            retval.push_back( thrInfo.handler );
+        }
     }
 
     return retval;
 }
 
 std::vector<std::shared_ptr<SignalProxyBase>> Connection::get_free_signal_proxies( const std::string& interface_name ) {
+    std::unique_lock lock( m_priv->m_freeProxySignalsLock );
     std::vector<std::shared_ptr<SignalProxyBase>> ret;
 
-    for( std::shared_ptr<SignalProxyBase> base : get_free_signal_proxies() ) {
-        if( base->interface_name().compare( interface_name ) == 0 ) {
-            ret.push_back( base );
+    for( SignalRoutingTable::iterator bucket = m_priv->m_freeProxySignals.lower_bound( SignalRoutingKey( interface_name, "" ) );
+         bucket != m_priv->m_freeProxySignals.end() && bucket->first.first == interface_name;
+         bucket++ ) {
+        for( const FreeSignalThreadInfo& thrInfo : bucket->second ) {
+            ret.push_back( thrInfo.handler );
         }
     }
 
@@ -1009,12 +1946,13 @@ std::vector<std::shared_ptr<SignalProxyBase>> Connection::get_free_signal_proxie
 }
 
 std::vector<std::shared_ptr<SignalProxyBase>> Connection::get_free_signal_proxies( const std::string& interface_name, const std::string& member ) {
+    std::unique_lock lock( m_priv->m_freeProxySignalsLock );
     std::vector<std::shared_ptr<SignalProxyBase>> ret;
+    SignalRoutingTable::iterator bucket = m_priv->m_freeProxySignals.find( SignalRoutingKey( interface_name, member ) );
 
-    for( std::shared_ptr<SignalProxyBase> base : get_free_signal_proxies() ) {
-        if( base->interface_name().compare( interface_name ) == 0 &&
-            base->name().compare( member ) == 0 ) {
-            ret.push_back( base );
+    if( bucket != m_priv->m_freeProxySignals.end() ) {
+        for( const FreeSignalThreadInfo& thrInfo : bucket->second ) {
+            ret.push_back( thrInfo.handler );
         }
     }
 
@@ -1084,47 +2022,104 @@ void Connection::remove_invalid_threaddispatchers_and_associated_objects() {
     {
         std::unique_lock<std::mutex> lock( m_priv->m_pathHandlerLock );
 
-        for( auto it = m_priv->m_path_handler.begin(); it != m_priv->m_path_handler.end(); ) {
-            if( std::find( invalidThreadIds.begin(), invalidThreadIds.end(), it->second.handlingThread ) != invalidThreadIds.end() ) {
-                it = m_priv->m_path_handler.erase( it );
-            } else {
-                it++;
-            }
-        }
+        m_priv->m_path_handler.remove_if( [&invalidThreadIds]( const PathHandlingEntry & entry ) {
+            return std::find( invalidThreadIds.begin(), invalidThreadIds.end(), entry.handlingThread ) != invalidThreadIds.end();
+        } );
     }
 }
 
 bool Connection::change_object_proxy_calling_thread( std::shared_ptr<ObjectProxy> object,
                                          ThreadForCalling calling ){
+    std::thread::id handlingThread = thread_id_from_calling( calling );
+    std::shared_ptr<SignalProxyBase> oldOwnerChanged;
+    std::shared_ptr<SignalProxyBase> newOwnerChanged;
     std::unique_lock lock( m_priv->m_objectProxiesLock );
+    std::vector<ObjectProxyThreadInfo>::iterator it =
+        std::find_if( m_priv->m_objectProxies.begin(), m_priv->m_objectProxies.end(),
+    [&object]( const ObjectProxyThreadInfo& thrInfo ) { return thrInfo.handler == object; } );
 
-    for( ObjectProxyThreadInfo& thrInfo : m_priv->m_objectProxies ){
-        if( thrInfo.handler == object ){
-            if( calling == ThreadForCalling::CurrentThread ){
-                thrInfo.handlingThread = std::this_thread::get_id();
-            }else{
-                thrInfo.handlingThread = m_priv->m_dispatchingThread;
-            }
+    if( it == m_priv->m_objectProxies.end() ){
+        return false;
+    }
 
-            return true;
+    it->handlingThread = handlingThread;
+    oldOwnerChanged.swap( it->ownerChanged );
+    lock.unlock();
+
+    // Adding and removing signal proxies takes other locks, so do it unlocked
+    remove_free_signal_proxy( oldOwnerChanged );
+
+    if( handlingThread != m_priv->m_dispatchingThread ){
+        newOwnerChanged = add_owner_changed_proxy( object );
+    }
+
+    if( newOwnerChanged ){
+        lock.lock();
+
+        for( ObjectProxyThreadInfo& thrInfo : m_priv->m_objectProxies ){
+            if( thrInfo.handler == object && thrInfo.handlingThread == handlingThread ){
+                thrInfo.ownerChanged = newOwnerChanged;
+                newOwnerChanged.reset();
+                break;
+            }
         }
+
+        lock.unlock();
+
+        // The proxy was changed again in the meantime
+        remove_free_signal_proxy( newOwnerChanged );
     }
 
-    return false;
+    return true;
 }
 
 bool Connection::register_object_proxy( std::shared_ptr<ObjectProxy> obj, ThreadForCalling calling ){
-    std::unique_lock lock( m_priv->m_objectProxiesLock );
-
     ObjectProxyThreadInfo newInfo;
     newInfo.handler = obj;
     newInfo.handlingThread = thread_id_from_calling( calling );
 
+    if( newInfo.handlingThread != m_priv->m_dispatchingThread ){
+        newInfo.ownerChanged = add_owner_changed_proxy( obj );
+    }
+
+    std::unique_lock lock( m_priv->m_objectProxiesLock );
     m_priv->m_objectProxies.push_back( newInfo );
+    lock.unlock();
+
+    // So that the proxy can be told when its destination changes owner
+    watch_name( obj->destination() );
 
     return true;
 }
 
+std::shared_ptr<SignalProxyBase> Connection::add_owner_changed_proxy( std::shared_ptr<ObjectProxy> obj ){
+    const std::string& destination = obj->destination();
+
+    // Only the owners of well-known names are watched
+    if( destination.empty() || destination[ 0 ] == ':' || destination == DBUS_CXX_BUS_NAME ){
+        return std::shared_ptr<SignalProxyBase>();
+    }
+
+    std::shared_ptr<SignalProxy<void(std::string, std::string, std::string)>> signal =
+        SignalProxy<void(std::string, std::string, std::string)>::create(
+            MatchRuleBuilder::create()
+            .set_sender( DBUS_CXX_BUS_NAME )
+            .set_path( DBUS_CXX_BUS_PATH )
+            .set_interface( DBUS_CXX_BUS_NAME )
+            .set_member( "NameOwnerChanged" )
+            .set_arg( 0, destination )
+            .as_signal_match() );
+    std::weak_ptr<ObjectProxy> weak_proxy = obj;
+
+    signal->connect( [weak_proxy]( std::string, std::string old_owner, std::string new_owner ){
+        std::shared_ptr<ObjectProxy> proxy = weak_proxy.lock();
+
+        if( proxy ){ proxy->destination_owner_changed( old_owner, new_owner ); }
+    } );
+
+    return add_free_signal_proxy( signal, ThreadForCalling::CurrentThread );
+}
+
 std::thread::id Connection::thread_id_from_calling( ThreadForCalling calling ){
     if( calling == ThreadForCalling::CurrentThread ){
         return std::this_thread::get_id();
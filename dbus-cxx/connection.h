@@ -8,12 +8,14 @@
  *   This file is part of the dbus-cxx library.                            *
  ***************************************************************************/
 #include <stdint.h>
+#include <dbus-cxx/credentials.h>
 #include <dbus-cxx/signal.h>
 #include <dbus-cxx/signalproxy.h>
 #include <dbus-cxx/threaddispatcher.h>
 #include <dbus-cxx/errormessage.h>
 #include <dbus-cxx/dbus-cxx-config.h>
 #include <deque>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -22,6 +24,7 @@
 #include <sigc++/sigc++.h>
 #include <future>
 #include <queue>
+#include <thread>
 
 #ifndef DBUSCXX_CONNECTION_H
 #define DBUSCXX_CONNECTION_H
@@ -46,6 +49,7 @@
 
 
 namespace DBus {
+class DeferredReplyBase;
 class Message;
 class Object;
 class ObjectPathHandler;
@@ -153,6 +157,53 @@ public:
      */
     bool name_has_owner( const std::string& name ) const;
 
+    /**
+     * Keep track of the unique name that owns the given name, from the
+     * NameOwnerChanged signals of the bus, so that name_owner() and
+     * name_has_owner() can answer without asking the bus.
+     *
+     * Watches are counted, so each call must be matched by a call to
+     * unwatch_name().  Free signal proxies that filter on a well-known
+     * sender, and object proxies with a well-known destination, watch
+     * their name automatically.
+     *
+     * @param name The well-known name to watch
+     */
+    void watch_name( const std::string& name );
+
+    void unwatch_name( const std::string& name );
+
+    /**
+     * @return The unique name that owns the given name, or an empty string
+     * if nothing owns it.  Unique names and watched names are answered
+     * locally; any other name is looked up on the bus.
+     */
+    std::string name_owner( const std::string& name ) const;
+
+    /**
+     * Emitted from the dispatcher when the owner of a watched name changes,
+     * with the name, the old owner and the new owner.
+     */
+    sigc::signal<void(std::string, std::string, std::string)>& signal_name_owner_changed();
+
+    /**
+     * Get the credentials of another connection to the bus, such as its Unix
+     * user ID, to decide if it is allowed to do something.
+     *
+     * The bus is only asked once for each unique name; after that the
+     * credentials are answered from a cache until the bus says that the
+     * connection has gone.  A well-known name is resolved to its current
+     * owner first, and the owner's credentials are returned.
+     *
+     * Inside of a method handler, CallMessage::sender_credentials() returns
+     * the credentials of the caller.
+     *
+     * @param name The unique or well-known name of the connection
+     * @throws Error If the bus is unable to return the credentials, for
+     * example because nothing has that name
+     */
+    Credentials credentials( const std::string& name );
+
     /**
      * @brief start_service
      * @param name
@@ -161,12 +212,55 @@ public:
      */
     StartReply start_service( const std::string& name, uint32_t flags = 0 ) const;
 
+    /**
+     * Ask the bus to send us messages that match the given rule, and wait
+     * for the bus to reply.
+     *
+     * Matches are reference counted: the bus is only told about a rule the
+     * first time that it is added.  Adding a rule that is still on its way
+     * to the bus waits for that first call, and gets the same result.
+     *
+     * @param rule The match rule
+     * @return true
+     * @throws Error If the bus rejected the rule or did not answer; the
+     * reference taken by this call is dropped again
+     */
     bool add_match( const std::string& rule );
 
+    /**
+     * Ask the bus to send us messages that match the given rule without
+     * waiting for a reply.  The AddMatch call is queued with any other
+     * outgoing messages, so many matches may be added with a single write
+     * to the bus.
+     *
+     * Matches are reference counted the same as add_match().  If the bus
+     * rejects the rule, signal_match_error() is emitted; the rule is still
+     * counted, so it must still be removed with remove_match().
+     *
+     * @param rule The match rule
+     */
     void add_match_nonblocking( const std::string& rule );
 
+    /**
+     * Remove a match that was added with add_match() or
+     * add_match_nonblocking().  The bus is only told to remove the rule once
+     * the last reference to it has been removed; this does not wait for a
+     * reply from the bus.
+     *
+     * @param rule The match rule
+     * @return true
+     */
     bool remove_match( const std::string& rule );
 
+    /**
+     * This signal is emitted when the bus returns an error for an AddMatch
+     * or RemoveMatch call that we did not wait for.  The parameters are the
+     * match rule, the name of the error and the error message.
+     *
+     * This is emitted from the dispatching thread.
+     */
+    sigc::signal<void(std::string, std::string, std::string)>& signal_match_error();
+
     bool is_connected() const;
 
     bool is_authenticated() const;
@@ -194,12 +288,63 @@ public:
      *
      * If a timeout is processed, this will throw ErrorNoReply
      *
+     * If the message has the NO_REPLY_EXPECTED flag set, it is queued and
+     * this returns an invalid pointer straight away.
+     *
      * @param msg The message to send
      * @param timeout_milliseconds How long to wait for.  If -1, will wait the maximum time
      * @return The return message
      */
     std::shared_ptr<ReturnMessage> send_with_reply_blocking( std::shared_ptr<const CallMessage> msg, int timeout_milliseconds = -1 );
 
+    /**
+     * Send a CallMessage, and wait for the reply, without throwing if the
+     * call fails.
+     *
+     * @param msg The message to send
+     * @param timeout_milliseconds How long to wait for.  If -1, will wait the maximum time
+     * @return The ReturnMessage or ErrorMessage that came back.  If no reply came
+     * back in time, or the connection is closed, an ErrorMessage that says so.  If
+     * the message has the NO_REPLY_EXPECTED flag set, an invalid pointer.
+     */
+    std::shared_ptr<Message> send_with_reply_nothrow( std::shared_ptr<const CallMessage> msg, int timeout_milliseconds = -1 );
+
+    /**
+     * Send a CallMessage without waiting for the reply.
+     *
+     * The reply serial is registered before the message is queued, and the
+     * returned PendingCall is completed from the dispatching thread when the
+     * ReturnMessage or ErrorMessage arrives.  No thread is used while the
+     * call is outstanding.
+     *
+     * If no reply arrives before the timeout, the PendingCall is completed
+     * with an org.freedesktop.DBus.Error.NoReply ErrorMessage.
+     *
+     * @param msg The message to send
+     * @param timeout_milliseconds How long to wait for.  If -1, will wait the maximum time
+     * @return The PendingCall that will receive the reply
+     */
+    std::shared_ptr<PendingCall> send_with_reply_async( std::shared_ptr<const CallMessage> msg, int timeout_milliseconds = -1 );
+
+    /**
+     * Send several CallMessages back to back and wait for all of the replies.
+     *
+     * All of the calls are queued at once, so they go out together on the
+     * next write to the bus, and the replies are collected as they come in;
+     * the whole batch takes about as long as the slowest call, rather than
+     * the sum of all of them.
+     *
+     * @param msgs The messages to send
+     * @param timeout_milliseconds How long to wait for all of the replies.  If -1,
+     * will wait the maximum time
+     * @return One reply for each message, in the same order.  Each reply is either a
+     * ReturnMessage or an ErrorMessage; calls that did not get a reply in time get an
+     * org.freedesktop.DBus.Error.NoReply ErrorMessage, and calls that were cut off by
+     * the connection closing get an org.freedesktop.DBus.Error.Disconnected ErrorMessage.
+     */
+    std::vector<std::shared_ptr<Message>> send_with_reply_batch( const std::vector<std::shared_ptr<const CallMessage>>& msgs,
+                                                                 int timeout_milliseconds = -1 );
+
     /**
      * Flushes all data out to the bus.  This should generally
      * be called from the dispatching thread, but it should be
@@ -225,6 +370,22 @@ public:
      */
     DispatchStatus dispatch( );
 
+    /**
+     * How long until the next outstanding method call times out.  An
+     * external event loop should call dispatch() once this time has passed,
+     * even if there is no activity on the connection.
+     *
+     * @return The number of milliseconds until the next call times out, 0
+     * if one already has, or -1 if no calls are outstanding.
+     */
+    int next_timeout_milliseconds() const;
+
+    /**
+     * How many calls to local methods are still waiting for a DeferredReply
+     * to be completed.
+     */
+    uint32_t outstanding_replies() const;
+
     int unix_fd() const;
 
     int socket() const;
@@ -264,6 +425,19 @@ public:
     RegistrationStatus register_object( std::shared_ptr<Object> object,
         ThreadForCalling calling = ThreadForCalling::DispatcherThread );
 
+    /**
+     * Register an object as a fallback handler.  The object handles calls to
+     * its own path, and to every path below it that has no object of its own
+     * registered.  A path may have both an object and a fallback handler
+     * registered at it, in which case the object handles calls to the path.
+     *
+     * @param object The object to export
+     * @param calling The thread in which this object's methods will be called in.  Defaults to being the dispatching thread.
+     * @return The status of registering the object.
+     */
+    RegistrationStatus register_fallback( std::shared_ptr<Object> object,
+        ThreadForCalling calling = ThreadForCalling::DispatcherThread );
+
     /**
      * Change the thread that the methods on this object will be called from.  Note that this
      * object must already be registered with register_object.
@@ -302,6 +476,11 @@ public:
     bool register_object_proxy( std::shared_ptr<ObjectProxy> obj,
                                 ThreadForCalling calling = ThreadForCalling::DispatcherThread );
 
+    /**
+     * Unregister the object at the given path.  If there is no object
+     * registered at the path, the fallback handler at the path is
+     * unregistered instead.
+     */
     bool unregister_object( const std::string& path );
 
     /**
@@ -326,6 +505,11 @@ public:
 
     /**
      * Adds the given signal proxy to the connection.
+     *
+     * Incoming signals are routed to free proxies by their interface and
+     * member, so these should not be changed after the proxy has been added.
+     * To listen on a different interface or member, remove the proxy, change
+     * it, and add it again.
      */
     std::shared_ptr<SignalProxyBase> add_free_signal_proxy( std::shared_ptr<SignalProxyBase> Signal,
                                                        ThreadForCalling calling = ThreadForCalling::DispatcherThread );
@@ -389,6 +573,82 @@ public:
     void add_thread_dispatcher( std::weak_ptr<ThreadDispatcher> disp );
 
 private:
+    friend class DeferredReplyBase;
+    friend class Interface;
+    friend class Object;
+    friend class SignalProxyBase;
+
+    /**
+     * Register an object that was added as a child of an object that is
+     * registered with this connection.  The child's methods are called
+     * from the same thread as the parent's.
+     */
+    RegistrationStatus register_child_object( const Object& parent, std::shared_ptr<Object> child );
+
+    RegistrationStatus register_object_on_thread( std::shared_ptr<Object> object, std::thread::id handlingThread, bool fallback );
+
+    /**
+     * @return The objects registered at paths below the given path
+     */
+    std::vector<std::shared_ptr<Object>> objects_below( const std::string& path );
+
+    /**
+     * @return True if the object is registered at exactly its own path
+     */
+    bool is_registered_at_path( const Object& object );
+
+    /**
+     * @return The closest object above the given path that is an object
+     * manager, if there is one
+     */
+    std::shared_ptr<Object> object_manager_for( const std::string& path ) const;
+
+    /**
+     * Check if a message from the given sender can be from the given name.
+     * A well-known name only matches if it is watched and the sender owns
+     * it, or if its owner has not been looked up yet.
+     */
+    bool sender_is( const std::string& name, const std::string& sender ) const;
+
+    /**
+     * Fill in the owner of a watched name from the reply to GetNameOwner.
+     */
+    void name_owner_reply( const std::string& name, std::shared_ptr<const Message> reply );
+
+    /**
+     * Update the owner of a watched name from a NameOwnerChanged signal.
+     */
+    void name_owner_changed( std::shared_ptr<const SignalMessage> msg );
+
+    /**
+     * Add a signal proxy on the current thread that tells the object proxy
+     * when the owner of its destination changes, for an object proxy that
+     * is not called from the dispatching thread.
+     */
+    std::shared_ptr<SignalProxyBase> add_owner_changed_proxy( std::shared_ptr<ObjectProxy> obj );
+
+    /**
+     * Drop the cached credentials of the given unique name, if there are any.
+     */
+    void forget_credentials( const std::string& unique_name );
+
+    /**
+     * Called when a DeferredReply is created and when it is completed, to
+     * keep count of the calls that have not been replied to yet.
+     */
+    void add_outstanding_reply();
+
+    void remove_outstanding_reply();
+
+    /**
+     * Run the given function on the dispatching thread, the next time that
+     * the connection is dispatched and before any queued messages are
+     * written.  Unlike sending a message, this never dispatches straight
+     * away, even when called from the dispatching thread, so that work
+     * queued while handling a message is done once that message is handled.
+     */
+    void run_before_next_flush( std::function<void()> work );
+
     /**
      * Depending on what thread this is called from,
      * will either notify the dispatcher that we need to be
@@ -398,7 +658,7 @@ private:
 
     /**
      * Write a single message, return the serial of this message.
-     * This should me called with a lock on m_outgoingLock
+     * This should me called with a lock on m_writeLock
      *
      * @param msg
      * @return
@@ -407,6 +667,12 @@ private:
 
     void process_single_message();
 
+    /**
+     * Complete every outstanding call whose deadline has passed with an
+     * ErrorNoReply.
+     */
+    void process_reply_timeouts();
+
     void remove_invalid_threaddispatchers_and_associated_objects();
 
     /**
@@ -419,6 +685,29 @@ private:
     void process_call_message( std::shared_ptr<const CallMessage> msg );
     void process_signal_message( std::shared_ptr<const SignalMessage> msg );
 
+    /**
+     * Queue an AddMatch or RemoveMatch call to the bus, remembering the
+     * serial so that the reply can be handled.  Must be called with the
+     * match lock held, and the dispatcher notified after it is released.
+     *
+     * @return The call, which is completed with the reply
+     */
+    std::shared_ptr<PendingCall> queue_match_call( const std::string& method, const std::string& rule, bool report_error );
+
+    /**
+     * Wait for the reply to a call from queue_match_call().  On the
+     * dispatching thread, this reads from the bus until the reply comes.
+     *
+     * @return The reply, or an invalid pointer if none came in time
+     */
+    std::shared_ptr<Message> wait_for_match_reply( std::shared_ptr<PendingCall> pending );
+
+    /**
+     * If the given message is a reply to a call from queue_match_call(),
+     * handle it and return true.
+     */
+    bool process_match_reply( std::shared_ptr<Message> msg, uint32_t reply_serial );
+
     std::thread::id thread_id_from_calling( ThreadForCalling calling );
 
 private:
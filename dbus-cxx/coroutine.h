@@ -0,0 +1,396 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#ifndef DBUSCXX_COROUTINE_H
+#define DBUSCXX_COROUTINE_H
+
+/*
+ * The library itself is built as C++17, so everything in this file is
+ * header-only and only available when the application is compiled with
+ * coroutine support(C++20).
+ */
+#if defined( __cpp_impl_coroutine ) && __has_include( <coroutine> )
+
+#include <dbus-cxx/connection.h>
+#include <dbus-cxx/dbus-error.h>
+#include <dbus-cxx/error.h>
+#include <dbus-cxx/errormessage.h>
+#include <dbus-cxx/methodbase.h>
+#include <dbus-cxx/methodproxybase.h>
+#include <dbus-cxx/pendingcall.h>
+#include <dbus-cxx/returnmessage.h>
+#include <dbus-cxx/standalonethreaddispatcher.h>
+#include <dbus-cxx/utility.h>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+
+#define DBUS_CXX_HAS_COROUTINES 1
+
+namespace DBus {
+
+/**
+ * Something that runs the given function, possibly on a different thread.
+ * An empty Executor means to run the function immediately.
+ */
+typedef std::function<void( std::function<void()> )> Executor;
+
+/**
+ * Returns an Executor that runs functions on the thread that owns the given
+ * StandaloneThreadDispatcher.  If the dispatcher has been destroyed, the
+ * function is dropped.
+ */
+inline Executor executor_for( std::shared_ptr<StandaloneThreadDispatcher> dispatcher ) {
+    std::weak_ptr<StandaloneThreadDispatcher> weak = dispatcher;
+
+    return [weak]( std::function<void()> work ) {
+        std::shared_ptr<StandaloneThreadDispatcher> disp = weak.lock();
+
+        if( disp ) { disp->post( [work]() { work(); } ); }
+    };
+}
+
+template <typename T_return> class Task;
+
+namespace priv {
+
+class TaskStateBase {
+public:
+    TaskStateBase() : m_done( false ) {}
+
+    /**
+     * Mark the task as done and run the continuation, if there is one.
+     */
+    void complete() {
+        std::function<void()> continuation;
+
+        {
+            std::unique_lock<std::mutex> lock( m_lock );
+            m_done = true;
+            continuation.swap( m_continuation );
+        }
+
+        if( continuation ) { continuation(); }
+    }
+
+    /**
+     * Run the continuation once the task is done; if it is already done,
+     * run it now on this thread.
+     */
+    void then( std::function<void()> continuation ) {
+        {
+            std::unique_lock<std::mutex> lock( m_lock );
+
+            if( !m_done ) {
+                m_continuation = continuation;
+                return;
+            }
+        }
+
+        continuation();
+    }
+
+    bool done() {
+        std::unique_lock<std::mutex> lock( m_lock );
+        return m_done;
+    }
+
+    std::exception_ptr m_error;
+
+private:
+    std::mutex m_lock;
+    bool m_done;
+    std::function<void()> m_continuation;
+};
+
+template <typename T_return>
+class TaskState : public TaskStateBase {
+public:
+    std::optional<T_return> m_value;
+};
+
+template <>
+class TaskState<void> : public TaskStateBase {
+};
+
+template <typename T_return>
+class TaskPromiseBase {
+public:
+    TaskPromiseBase() : m_state( std::make_shared<TaskState<T_return>>() ) {}
+
+    struct FinalAwaiter {
+        std::shared_ptr<TaskState<T_return>> state;
+
+        bool await_ready() noexcept {
+            state->complete();
+            return true;
+        }
+
+        void await_suspend( std::coroutine_handle<> ) noexcept {}
+
+        void await_resume() noexcept {}
+    };
+
+    /* Tasks start running immediately, and free themselves when done */
+    std::suspend_never initial_suspend() noexcept { return {}; }
+
+    FinalAwaiter final_suspend() noexcept { return FinalAwaiter{ m_state }; }
+
+    void unhandled_exception() { m_state->m_error = std::current_exception(); }
+
+    std::shared_ptr<TaskState<T_return>> m_state;
+};
+
+template <typename T_return>
+class TaskPromise : public TaskPromiseBase<T_return> {
+public:
+    void return_value( T_return value ) { this->m_state->m_value = std::move( value ); }
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase<void> {
+public:
+    void return_void() {}
+};
+
+} /* namespace priv */
+
+/**
+ * The return type of a coroutine that can be awaited with co_await, or used
+ * as the return type of a local Method.
+ *
+ * A Task starts running as soon as it is called, and keeps running even if
+ * the Task object is destroyed.
+ */
+template <typename T_return>
+class Task {
+public:
+    class promise_type : public priv::TaskPromise<T_return> {
+    public:
+        Task get_return_object() { return Task( this->m_state ); }
+    };
+
+    bool done() const { return m_state->done(); }
+
+    /**
+     * Call the given function once this task is done.  The function is
+     * called from whichever thread completed the task, or from this thread
+     * if the task is already done.
+     */
+    void then( std::function<void()> continuation ) { m_state->then( continuation ); }
+
+    /**
+     * The value that the task returned.  If the task threw an exception,
+     * it is rethrown.  Only valid once done() is true.
+     */
+    T_return result() {
+        if( m_state->m_error ) { std::rethrow_exception( m_state->m_error ); }
+
+        if constexpr( !std::is_void_v<T_return> ) {
+            return *m_state->m_value;
+        }
+    }
+
+    bool await_ready() const { return m_state->done(); }
+
+    void await_suspend( std::coroutine_handle<> handle ) {
+        m_state->then( [handle]() { handle.resume(); } );
+    }
+
+    T_return await_resume() { return result(); }
+
+private:
+    Task( std::shared_ptr<priv::TaskState<T_return>> state ) : m_state( state ) {}
+
+    std::shared_ptr<priv::TaskState<T_return>> m_state;
+};
+
+/**
+ * Awaits the reply to a remote method call.  Create one with co_call().
+ *
+ * By default, the awaiting coroutine is resumed on the dispatching thread
+ * of the connection; use resume_on() to resume it elsewhere.  If the
+ * connection is destroyed before the reply comes back, the coroutine is
+ * never resumed.
+ */
+template <typename T_return>
+class CallAwaiter {
+public:
+    CallAwaiter( std::shared_ptr<PendingCall> pending ) : m_pending( pending ) {}
+
+    /**
+     * Resume the awaiting coroutine using the given Executor.
+     */
+    CallAwaiter resume_on( Executor executor ) && {
+        m_executor = executor;
+        return std::move( *this );
+    }
+
+    bool await_ready() const { return !m_pending; }
+
+    void await_suspend( std::coroutine_handle<> handle ) {
+        std::shared_ptr<Message>* reply = &m_reply;
+        Executor executor = m_executor;
+
+        m_pending->set_notify( [reply, handle, executor]( std::shared_ptr<Message> msg ) {
+            *reply = msg;
+
+            if( executor ) {
+                executor( [handle]() { handle.resume(); } );
+            } else {
+                handle.resume();
+            }
+        } );
+    }
+
+    T_return await_resume() {
+        if( !m_reply ) { throw ErrorDisconnected(); }
+
+        if( m_reply->type() == MessageType::ERROR ) {
+            std::static_pointer_cast<ErrorMessage>( m_reply )->throw_error();
+        }
+
+        if constexpr( !std::is_void_v<T_return> ) {
+            T_return retval;
+            std::shared_ptr<const Message>( m_reply ) >> retval;
+            return retval;
+        }
+    }
+
+private:
+    std::shared_ptr<PendingCall> m_pending;
+    std::shared_ptr<Message> m_reply;
+    Executor m_executor;
+};
+
+/**
+ * Call a remote method from a coroutine:
+ *
+ * @code
+ * double result = co_await DBus::co_call( proxy, 1.0, 2.0 );
+ * @endcode
+ *
+ * @param proxy The method to call
+ * @param args The arguments to the method
+ * @return A CallAwaiter for the reply
+ */
+template <typename T_return, typename... T_arg>
+CallAwaiter<T_return> co_call( std::shared_ptr<MethodProxy<T_return( T_arg... )>> proxy,
+                               typename std::type_identity<T_arg>::type... args ) {
+    std::shared_ptr<CallMessage> _callmsg = proxy->create_call_message();
+
+    if( !_callmsg ) { return CallAwaiter<T_return>( std::shared_ptr<PendingCall>() ); }
+
+    MessageAppendIterator iter = _callmsg->append();
+    ( void )( iter << ... << args );
+
+    return CallAwaiter<T_return>( proxy->MethodProxyBase::call_async( _callmsg ) );
+}
+
+/**
+ * Method specialization for coroutine handlers.  The handler is called from
+ * the thread that the object is handled on, and the reply is sent when the
+ * returned Task finishes, from whichever thread finished it.
+ */
+template <typename T_return, typename... T_arg>
+class Method<Task<T_return>( T_arg... )> : public MethodBase {
+private:
+    Method( const std::string& name ) : MethodBase( name ) {}
+
+public:
+    static std::shared_ptr<Method> create( const std::string& name ) {
+        return std::shared_ptr<Method>( new Method( name ) );
+    }
+
+    void set_method( sigc::slot<Task<T_return>( T_arg... )> slot ) { m_slot = slot; }
+
+    virtual std::string introspect( int space_depth = 0 ) const {
+        std::ostringstream sout;
+        std::string spaces;
+        DBus::priv::dbus_function_traits<std::function<T_return( T_arg... )>> method_sig_gen;
+
+        for( int i = 0; i < space_depth; i++ ) { spaces += " "; }
+
+        sout << spaces << "<method name=\"" << name() << "\">\n";
+        sout << method_sig_gen.introspect( arg_names(), 0, spaces + "  " );
+        sout << spaces << "</method>\n";
+        return sout.str();
+    }
+
+    virtual HandlerResult handle_call_message( std::shared_ptr<Connection> connection, std::shared_ptr<const CallMessage> message ) {
+        if( !connection || !message ) { return HandlerResult::Not_Handled; }
+
+        std::shared_ptr<ReturnMessage> retmsg = message->create_reply();
+
+        if( !retmsg ) { return HandlerResult::Not_Handled; }
+
+        DBus::priv::dbus_function_traits<std::function<T_return( T_arg... )>> method_sig_gen;
+
+        if( !priv::signature_is_compatible( message->signature(), method_sig_gen.dbus_sig() ) ) {
+            send_error( connection, message, DBUSCXX_ERROR_INVALID_SIGNATURE,
+                "Expected signature " + method_sig_gen.dbus_sig() + ", got " + message->signature().str() );
+            return HandlerResult::Handled;
+        }
+
+        try {
+            MessageIterator i = message->begin();
+            std::tuple<T_arg...> tup_args;
+            std::apply( [i]( auto&& ...arg ) mutable {
+                ( void )( i >> ... >> arg );
+            },
+            tup_args );
+
+            Task<T_return> task = std::apply( m_slot, tup_args );
+
+            task.then( [task, connection, message, retmsg]() mutable {
+                try {
+                    if constexpr( std::is_void_v<T_return> ) {
+                        task.result();
+                    } else {
+                        retmsg << task.result();
+                    }
+
+                    connection->send( retmsg );
+                } catch( const std::exception& e ) {
+                    send_error( connection, message, DBUSCXX_ERROR_FAILED, e.what() );
+                } catch( ... ) {
+                    send_error( connection, message, DBUSCXX_ERROR_FAILED, "unknown error(uncaught exception)" );
+                }
+            } );
+        } catch( ErrorInvalidTypecast& e ) {
+            send_error( connection, message, DBUSCXX_ERROR_INVALID_SIGNATURE, e.what() );
+        } catch( const std::exception& e ) {
+            send_error( connection, message, DBUSCXX_ERROR_FAILED, e.what() );
+        }
+
+        return HandlerResult::Handled;
+    }
+
+private:
+    static void send_error( std::shared_ptr<Connection> connection,
+                            std::shared_ptr<const CallMessage> message,
+                            const char* name,
+                            const std::string& what ) {
+        std::shared_ptr<ErrorMessage> errmsg = ErrorMessage::create( message, name, what );
+
+        if( errmsg ) { connection->send( errmsg ); }
+    }
+
+private:
+    sigc::slot<Task<T_return>( T_arg... )> m_slot;
+};
+
+} /* namespace DBus */
+
+#endif
+
+#endif /* DBUSCXX_COROUTINE_H */
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#include "credentials.h"
+#include "types.h"
+
+namespace DBus {
+
+Credentials::Credentials() {
+}
+
+Credentials::Credentials( const std::map<std::string, Variant>& values ) :
+    m_values( values ) {
+}
+
+std::optional<uint32_t> Credentials::unix_user_id() const {
+    std::map<std::string, Variant>::const_iterator it = m_values.find( "UnixUserID" );
+
+    if( it == m_values.end() || it->second.type() != DataType::UINT32 ) {
+        return std::optional<uint32_t>();
+    }
+
+    return it->second.to_uint32();
+}
+
+std::vector<uint32_t> Credentials::unix_group_ids() const {
+    std::map<std::string, Variant>::const_iterator it = m_values.find( "UnixGroupIDs" );
+
+    if( it == m_values.end() || it->second.signature().str() != "au" ) {
+        return std::vector<uint32_t>();
+    }
+
+    Variant value = it->second;
+    return value.to_vector<uint32_t>();
+}
+
+std::optional<uint32_t> Credentials::process_id() const {
+    std::map<std::string, Variant>::const_iterator it = m_values.find( "ProcessID" );
+
+    if( it == m_values.end() || it->second.type() != DataType::UINT32 ) {
+        return std::optional<uint32_t>();
+    }
+
+    return it->second.to_uint32();
+}
+
+std::string Credentials::linux_security_label() const {
+    std::map<std::string, Variant>::const_iterator it = m_values.find( "LinuxSecurityLabel" );
+
+    if( it == m_values.end() || it->second.signature().str() != "ay" ) {
+        return std::string();
+    }
+
+    Variant value = it->second;
+    std::vector<uint8_t> label = value.to_vector<uint8_t>();
+
+    /* The label is sent with its NUL terminator */
+    while( !label.empty() && label.back() == 0 ) {
+        label.pop_back();
+    }
+
+    return std::string( label.begin(), label.end() );
+}
+
+std::string Credentials::windows_sid() const {
+    std::map<std::string, Variant>::const_iterator it = m_values.find( "WindowsSID" );
+
+    if( it == m_values.end() || it->second.type() != DataType::STRING ) {
+        return std::string();
+    }
+
+    return it->second.to_string();
+}
+
+const std::map<std::string, Variant>& Credentials::values() const {
+    return m_values;
+}
+
+} /* namespace DBus */
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#ifndef DBUSCXX_CREDENTIALS_H
+#define DBUSCXX_CREDENTIALS_H
+
+#include <dbus-cxx/variant.h>
+#include <map>
+#include <optional>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace DBus {
+
+/**
+ * The credentials of a connection to the bus, as returned by the bus from
+ * org.freedesktop.DBus.GetConnectionCredentials.
+ *
+ * The bus only returns the credentials that it knows about, so each of them
+ * may be missing.  Use Connection::credentials() or
+ * CallMessage::sender_credentials() to get them; both are cached.
+ *
+ * @ingroup local
+ */
+class Credentials {
+public:
+    Credentials();
+
+    Credentials( const std::map<std::string, Variant>& values );
+
+    /**
+     * @return The Unix user ID of the process that the connection belongs to
+     */
+    std::optional<uint32_t> unix_user_id() const;
+
+    /**
+     * @return The Unix group IDs of the process; empty if not known
+     */
+    std::vector<uint32_t> unix_group_ids() const;
+
+    std::optional<uint32_t> process_id() const;
+
+    /**
+     * @return The security label of the process, such as an SELinux context;
+     * empty if not known
+     */
+    std::string linux_security_label() const;
+
+    /**
+     * @return The Windows security identifier of the process; empty if not known
+     */
+    std::string windows_sid() const;
+
+    /**
+     * @return All of the credentials that the bus returned, including any
+     * that are not known here
+     */
+    const std::map<std::string, Variant>& values() const;
+
+private:
+    std::map<std::string, Variant> m_values;
+};
+
+} /* namespace DBus */
+
+#endif /* DBUSCXX_CREDENTIALS_H */
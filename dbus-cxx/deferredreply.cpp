@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#include "deferredreply.h"
+#include <atomic>
+#include "connection.h"
+#include "dbus-cxx-private.h"
+
+using DBus::DeferredReplyBase;
+
+static const char* LOGGER_NAME = "DBus.DeferredReply";
+
+class DeferredReplyBase::priv_data {
+public:
+    priv_data( std::shared_ptr<Connection> connection, std::shared_ptr<const CallMessage> call ) :
+        m_connection( connection ),
+        m_call( call ),
+        m_completed( false ) {}
+
+    std::weak_ptr<Connection> m_connection;
+    std::shared_ptr<const CallMessage> m_call;
+    std::atomic<bool> m_completed;
+};
+
+DeferredReplyBase::DeferredReplyBase( std::shared_ptr<Connection> connection, std::shared_ptr<const CallMessage> call ) :
+    m_priv( std::make_unique<priv_data>( connection, call ) ) {
+    if( connection ) {
+        connection->add_outstanding_reply();
+    }
+}
+
+DeferredReplyBase::~DeferredReplyBase() {
+    if( !claim() ) { return; }
+
+    SIMPLELOGGER_DEBUG( LOGGER_NAME, "No reply sent to call of " << m_priv->m_call->member() << ", sending an error" );
+
+    send_reply( ErrorMessage::create( m_priv->m_call, DBUSCXX_ERROR_FAILED, "The method did not reply" ) );
+}
+
+void DeferredReplyBase::error( const Error& err ) {
+    if( !claim() ) { return; }
+
+    send_reply( ErrorMessage::create( m_priv->m_call, err.name(), err.message() ) );
+}
+
+bool DeferredReplyBase::is_completed() const {
+    return m_priv->m_completed.load( std::memory_order_acquire );
+}
+
+std::shared_ptr<const DBus::CallMessage> DeferredReplyBase::call_message() const {
+    return m_priv->m_call;
+}
+
+bool DeferredReplyBase::claim() {
+    bool expected = false;
+
+    return m_priv->m_completed.compare_exchange_strong( expected, true, std::memory_order_acq_rel );
+}
+
+void DeferredReplyBase::send_reply( std::shared_ptr<const Message> reply ) {
+    std::shared_ptr<Connection> connection = m_priv->m_connection.lock();
+
+    if( !connection ) {
+        SIMPLELOGGER_DEBUG( LOGGER_NAME, "Connection is gone, not sending reply" );
+        return;
+    }
+
+    /* Count it as done first, so that the caller never sees it outstanding after getting the reply */
+    connection->remove_outstanding_reply();
+
+    if( reply ) {
+        connection->send( reply );
+    }
+}
@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#ifndef DBUSCXX_DEFERREDREPLY_H
+#define DBUSCXX_DEFERREDREPLY_H
+
+#include <dbus-cxx/callmessage.h>
+#include <dbus-cxx/dbus-cxx-config.h>
+#include <dbus-cxx/error.h>
+#include <dbus-cxx/errormessage.h>
+#include <dbus-cxx/methodbase.h>
+#include <dbus-cxx/returnmessage.h>
+#include <dbus-cxx/utility.h>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <sigc++/sigc++.h>
+
+namespace DBus {
+
+class Connection;
+
+/**
+ * The part of a DeferredReply that does not depend on the return type.
+ *
+ * A deferred reply is created for every call to a local method that replies
+ * later instead of returning its value.  It may be completed from any thread,
+ * and only the first reply or error is sent.  If it is destroyed without being
+ * completed, the caller gets an error so that it is not left waiting until
+ * it times out.
+ *
+ * While a deferred reply is outstanding, the Connection counts it in
+ * Connection::outstanding_replies().
+ */
+class DeferredReplyBase {
+protected:
+    DeferredReplyBase( std::shared_ptr<Connection> connection, std::shared_ptr<const CallMessage> call );
+
+public:
+    virtual ~DeferredReplyBase();
+
+    /**
+     * Send an error back to the caller instead of a return value.
+     */
+    void error( const Error& err );
+
+    /**
+     * @return true once a reply or error has been sent
+     */
+    bool is_completed() const;
+
+    /**
+     * @return The call that this is the reply to
+     */
+    std::shared_ptr<const CallMessage> call_message() const;
+
+protected:
+    /**
+     * Mark this reply as completed.
+     *
+     * @return false if it had already been completed
+     */
+    bool claim();
+
+    /**
+     * Send the reply for a call that has been claimed.
+     */
+    void send_reply( std::shared_ptr<const Message> reply );
+
+private:
+    class priv_data;
+
+    DBUS_CXX_PROPAGATE_CONST( std::unique_ptr<priv_data> ) m_priv;
+};
+
+/**
+ * A handle that a local method uses to send its return value later, possibly
+ * from a different thread.
+ *
+ * To create a method that replies this way, make the first argument of the
+ * method a std::shared_ptr<DeferredReply<T_return>>, and give the method
+ * a void return type:
+ *
+ * @code
+ * void lookup( std::shared_ptr<DBus::DeferredReply<std::string>> reply, int id ){
+ *     std::thread( [reply, id](){
+ *         reply->reply( slow_lookup( id ) );
+ *     } ).detach();
+ * }
+ *
+ * object->create_method<void(std::shared_ptr<DBus::DeferredReply<std::string>>, int)>( "lookup", sigc::ptr_fun( lookup ) );
+ * @endcode
+ *
+ * The method is introspected and called as if it were std::string(int).
+ */
+template <typename T_return>
+class DeferredReply : public DeferredReplyBase {
+private:
+    DeferredReply( std::shared_ptr<Connection> connection, std::shared_ptr<const CallMessage> call ) :
+        DeferredReplyBase( connection, call ) {}
+
+public:
+    static std::shared_ptr<DeferredReply> create( std::shared_ptr<Connection> connection, std::shared_ptr<const CallMessage> call ) {
+        return std::shared_ptr<DeferredReply>( new DeferredReply( connection, call ) );
+    }
+
+    /**
+     * Send the return value back to the caller.
+     */
+    void reply( const T_return& value ) {
+        if( !claim() ) { return; }
+
+        std::shared_ptr<ReturnMessage> retmsg = call_message()->create_reply();
+
+        if( retmsg ) { retmsg << value; }
+
+        send_reply( retmsg );
+    }
+};
+
+/**
+ * DeferredReply specialization for methods that return nothing.
+ */
+template <>
+class DeferredReply<void> : public DeferredReplyBase {
+private:
+    DeferredReply( std::shared_ptr<Connection> connection, std::shared_ptr<const CallMessage> call ) :
+        DeferredReplyBase( connection, call ) {}
+
+public:
+    static std::shared_ptr<DeferredReply> create( std::shared_ptr<Connection> connection, std::shared_ptr<const CallMessage> call ) {
+        return std::shared_ptr<DeferredReply>( new DeferredReply( connection, call ) );
+    }
+
+    /**
+     * Tell the caller that the method is done.
+     */
+    void reply() {
+        if( !claim() ) { return; }
+
+        send_reply( call_message()->create_reply() );
+    }
+};
+
+/**
+ * Method specialization for methods that reply through a DeferredReply.
+ * The handler returns straight away, so the thread that called it is free
+ * to handle other calls while the reply is outstanding.
+ */
+template <typename T_return, typename... T_arg>
+class Method<void( std::shared_ptr<DeferredReply<T_return>>, T_arg... )> : public MethodBase {
+private:
+    Method( const std::string& name ) : MethodBase( name ) {}
+
+public:
+    static std::shared_ptr<Method> create( const std::string& name ) {
+        return std::shared_ptr<Method>( new Method( name ) );
+    }
+
+    void set_method( sigc::slot<void( std::shared_ptr<DeferredReply<T_return>>, T_arg... )> slot ) { m_slot = slot; }
+
+    virtual std::string introspect( int space_depth = 0 ) const {
+        std::ostringstream sout;
+        std::string spaces;
+        DBus::priv::dbus_function_traits<std::function<T_return( T_arg... )>> method_sig_gen;
+
+        for( int i = 0; i < space_depth; i++ ) { spaces += " "; }
+
+        sout << spaces << "<method name=\"" << name() << "\">\n";
+        sout << method_sig_gen.introspect( arg_names(), 0, spaces + "  " );
+        sout << spaces << "</method>\n";
+        return sout.str();
+    }
+
+    virtual HandlerResult handle_call_message( std::shared_ptr<Connection> connection, std::shared_ptr<const CallMessage> message ) {
+        DBus::priv::dbus_function_traits<std::function<T_return( T_arg... )>> method_sig_gen;
+
+        if( !connection || !message ) { return HandlerResult::Not_Handled; }
+
+        std::shared_ptr<DeferredReply<T_return>> reply = DeferredReply<T_return>::create( connection, message );
+
+        if( !priv::signature_is_compatible( message->signature(), method_sig_gen.dbus_sig() ) ) {
+            reply->error( ErrorInvalidSignature( "Expected signature " + method_sig_gen.dbus_sig() + ", got " + message->signature().str() ) );
+            return HandlerResult::Handled;
+        }
+
+        try {
+            MessageIterator i = message->begin();
+            std::tuple<T_arg...> tup_args;
+            std::apply( [i]( auto&& ...arg ) mutable {
+                ( void )( i >> ... >> arg );
+            },
+            tup_args );
+
+            std::apply( m_slot, std::tuple_cat( std::make_tuple( reply ), tup_args ) );
+        } catch( ErrorInvalidTypecast& e ) {
+            reply->error( ErrorInvalidSignature( e.what() ) );
+        } catch( const std::exception& e ) {
+            reply->error( ErrorFailed( e.what() ) );
+        }
+
+        return HandlerResult::Handled;
+    }
+
+private:
+    sigc::slot<void( std::shared_ptr<DeferredReply<T_return>>, T_arg... )> m_slot;
+};
+
+} /* namespace DBus */
+
+#endif /* DBUSCXX_DEFERREDREPLY_H */
@@ -429,6 +429,14 @@ public:
         : Error( nullptr, message ) {}
 };
 
+/**
+ * Throw the subclass of Error that goes with the given D-Bus error name,
+ * or a plain Error if the name is not one of the standard errors.
+ *
+ * @ingroup errors
+ */
+[[ noreturn ]] void throw_named_error( const std::string& name, const std::string& message );
+
 }
 
 #endif
@@ -12,8 +12,6 @@
 #include "types.h"
 #include "dbus-error.h"
 
-#define DBUS_ERROR_CHECK(err_name,error_throw) do{ if( name() == err_name ) throw error_throw( message() ); }while(0)
-
 namespace DBus {
 
 ErrorMessage::ErrorMessage() {
@@ -22,10 +20,19 @@ ErrorMessage::ErrorMessage() {
 ErrorMessage::ErrorMessage( std::shared_ptr<const CallMessage> to_reply, const std::string& name, const std::string& message ) {
     if( to_reply ) {
         set_header_field( MessageHeaderFields::Reply_Serial, Variant( to_reply->serial() ) );
+
+        if( !to_reply->sender().empty() ) {
+            set_destination( to_reply->sender() );
+        }
     }
 
     set_header_field( MessageHeaderFields::Error_Name, Variant( name ) );
     append() << message;
+
+    if( to_reply && !to_reply->expects_reply() ) {
+        // Nobody is listening for this error, so make sure that it never gets sent
+        invalidate();
+    }
 }
 
 std::shared_ptr<ErrorMessage> ErrorMessage::create() {
@@ -95,34 +102,7 @@ uint32_t ErrorMessage::reply_serial() const {
 }
 
 void ErrorMessage::throw_error() {
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_FAILED, ErrorFailed );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_SERVICE_UNKNOWN, ErrorServiceUnknown );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_NAME_HAS_NO_OWNER, ErrorNameHasNoOwner );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_NO_REPLY, ErrorNoReply );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_IO_ERROR, ErrorIOError );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_BAD_ADDRESS, ErrorBadAddress );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_NOT_SUPPORTED, ErrorNotSupported );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_LIMITS_EXCEEDED, ErrorLimitsExceeded );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_ACCESS_DENIED, ErrorAccessDenied );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_AUTH_FAILED, ErrorAuthFailed );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_NO_SERVER, ErrorNoServer );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_TIMEOUT, ErrorTimeout );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_NO_NETWORK, ErrorNoNetwork );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_ADDRESS_IN_USE, ErrorAddressInUse );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_DISCONNECTED, ErrorDisconnected );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_INVALID_ARGS, ErrorInvalidArgs );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_FILE_NOT_FOUND, ErrorFileNotFound );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_FILE_EXISTS, ErrorFileExists );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_UNKNOWN_METHOD, ErrorUnknownMethod );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_UNKNOWN_OBJECT, ErrorUnknownObject );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_UNKNOWN_INTERFACE, ErrorUnknownInterface );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_UNKNOWN_PROPERTY, ErrorUnknownProperty );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_PROPERTY_READ_ONLY, ErrorPropertyReadOnly );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_TIMED_OUT, ErrorTimedOut );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_MATCH_RULE_NOT_FOUND, ErrorMatchRuleNotFound );
-    DBUS_ERROR_CHECK( DBUSCXX_ERROR_MATCH_RULE_INVALID, ErrorMatchRuleInvalid );
-
-    throw Error( name(), message() );
+    throw_named_error( name(), message() );
 }
 
 }
@@ -7,7 +7,9 @@
  ***************************************************************************/
 #include "interface.h"
 #include <dbus-cxx/object.h>
+#include <atomic>
 #include <map>
+#include <unordered_map>
 #include <utility>
 #include "callmessage.h"
 #include "dbus-cxx-private.h"
@@ -21,22 +23,44 @@ static const char* LOGGER_NAME = "DBus.Interface";
 namespace DBus {
 class Connection;
 
+typedef std::unordered_map<std::string_view, std::shared_ptr<PropertyBase>> PropertiesByName;
+
 class Interface::priv_data {
 public:
     priv_data( std::string name ):
-        m_name( name ) {}
+        m_name( name ),
+        m_properties_generation( 0 ),
+        m_get_all_generation( 0 ),
+        m_change_batches( 0 ),
+        m_coalesce_changes( false ),
+        m_send_changes_queued( false ) {}
 
     const std::string m_name;
     std::string m_path;
     Methods m_methods;
     Signals m_signals;
     std::set<std::shared_ptr<PropertyBase>> m_properties;
+    /* The keys refer to the names held by the properties themselves */
+    PropertiesByName m_properties_by_name;
     mutable std::shared_mutex m_methods_rwlock;
     mutable std::shared_mutex m_signals_rwlock;
     mutable std::shared_mutex m_properties_rwlock;
     sigc::signal<void( std::shared_ptr<MethodBase> )> m_signal_method_added;
     sigc::signal<void( std::shared_ptr<MethodBase> )> m_signal_method_removed;
     std::weak_ptr<DBus::Connection> m_connection;
+    /* Changes every time a property is added or set */
+    std::atomic<uint64_t> m_properties_generation;
+    /* The body of the reply to GetAll, and the generation it was built at */
+    mutable std::mutex m_get_all_mutex;
+    mutable std::shared_ptr<ReturnMessage> m_get_all_reply;
+    mutable uint64_t m_get_all_generation;
+    /* Property changes that have not been sent yet, protected by m_changes_mutex */
+    mutable std::mutex m_changes_mutex;
+    std::map<std::string, DBus::Variant> m_changed;
+    std::set<std::string> m_invalidated;
+    int m_change_batches;
+    bool m_coalesce_changes;
+    bool m_send_changes_queued;
 };
 
 Interface::Interface( const std::string& name ) {
@@ -90,6 +114,8 @@ bool Interface::add_method( std::shared_ptr<MethodBase> method ) {
         m_priv->m_methods.insert( std::make_pair( method->name(), method ) );
     }
 
+    priv::introspection_changed();
+
     m_priv->m_signal_method_added.emit( method );
 
     return result;
@@ -111,6 +137,7 @@ bool Interface::remove_method( const std::string& name ) {
     }
 
     if( method ) {
+        priv::introspection_changed();
         m_priv->m_signal_method_removed.emit( method );
         return true;
     }
@@ -137,6 +164,7 @@ bool Interface::remove_method( std::shared_ptr<MethodBase> torem ) {
     }
 
     if( method ) {
+        priv::introspection_changed();
         m_priv->m_signal_method_removed.emit( method );
         return true;
     }
@@ -172,6 +200,7 @@ bool Interface::add_signal( std::shared_ptr<SignalBase> sig ) {
         m_priv->m_signals.insert( sig );
         sig->set_path( this->path() );
         sig->set_interface( m_priv->m_name );
+        priv::introspection_changed();
         result = true;
     }
 
@@ -188,6 +217,7 @@ bool Interface::remove_signal( std::shared_ptr<SignalBase> signal ) {
 
     if( i != m_priv->m_signals.end() ) {
         m_priv->m_signals.erase( i );
+        priv::introspection_changed();
         result = true;
     }
 
@@ -204,6 +234,7 @@ bool Interface::remove_signal( const std::string& name ) {
         if( ( *i )->name() == name ) {
             Signals::iterator temp = i++;
             m_priv->m_signals.erase( temp );
+            priv::introspection_changed();
         } else {
             i++;
         }
@@ -311,25 +342,12 @@ HandlerResult Interface::handle_properties_message( std::shared_ptr<Connection>
     std::string errName = DBUSCXX_ERROR_UNKNOWN_PROPERTY;
 
     if( message->member() == "GetAll" ){
-        std::map<std::string,DBus::Variant> retval;
-
-        for( std::shared_ptr<DBus::PropertyBase> prop : m_priv->m_properties ){
-            if( prop->variant_value().type() == DataType::INVALID ){
-                // The property has not been set, so we must assume that it does not exist
-                continue;
-            }
-
-            switch( prop->access_type() ){
-            case DBus::PropertyAccess::ReadOnly:
-            case DBus::PropertyAccess::ReadWrite:
-                retval[ prop->name() ] = prop->variant_value();
-                break;
-            case DBus::PropertyAccess::WriteOnly:
-                continue;
-            }
+        if( retmsg && !retmsg->set_body_from( *get_all_reply() ) ){
+            /* The cached body can't be copied into this reply, so marshal it again */
+            MessageAppendIterator iter( *retmsg );
+            append_readable_properties( iter );
         }
 
-        retmsg << retval;
         conn << retmsg;
         return HandlerResult::Handled;
     } else if( message->member() == "Get" ){
@@ -338,18 +356,17 @@ HandlerResult Interface::handle_properties_message( std::shared_ptr<Connection>
 
         message >> interfaceName >> propertyName;
 
-        for( std::shared_ptr<DBus::PropertyBase> prop : m_priv->m_properties ){
-            if( prop->variant_value().type() == DataType::INVALID ){
-                // The property has not been set, so we must assume that it does not exist
-                continue;
-            }
+        PropertiesByName::const_iterator it = m_priv->m_properties_by_name.find( propertyName );
 
-            if( prop->name() == propertyName ){
-                if( prop->access_type() != DBus::PropertyAccess::WriteOnly ){
-                    retmsg << prop->variant_value();
-                    conn << retmsg;
-                    return HandlerResult::Handled;
-                }
+        if( it != m_priv->m_properties_by_name.end() &&
+            it->second->access_type() != DBus::PropertyAccess::WriteOnly ){
+            std::shared_ptr<const Variant> value = it->second->shared_value();
+
+            // If the property has not been set, we must assume that it does not exist
+            if( value->type() != DataType::INVALID ){
+                retmsg << *value;
+                conn << retmsg;
+                return HandlerResult::Handled;
             }
         }
 
@@ -362,22 +379,21 @@ HandlerResult Interface::handle_properties_message( std::shared_ptr<Connection>
         message >> interfaceName >> propertyName >> variantValue;
         errMsg = "Unable to find property " + propertyName + " on interface " + interfaceName;
 
-        for( std::shared_ptr<DBus::PropertyBase> prop : m_priv->m_properties ){
-            if( prop->variant_value().type() == DataType::INVALID ){
-                // The property has not been set, so we must assume that it does not exist
-                continue;
-            }
+        PropertiesByName::const_iterator it = m_priv->m_properties_by_name.find( propertyName );
+
+        // If the property has not been set, we must assume that it does not exist
+        if( it != m_priv->m_properties_by_name.end() &&
+            it->second->shared_value()->type() != DataType::INVALID ){
+            std::shared_ptr<DBus::PropertyBase> prop = it->second;
 
-            if( prop->name() == propertyName ){
-                if( prop->access_type() != DBus::PropertyAccess::ReadOnly ){
-                    prop->set_value( variantValue );
-                    conn << retmsg;
-                    return HandlerResult::Handled;
-                }
-                errName = DBUSCXX_ERROR_PROPERTY_READ_ONLY;
-                errMsg = "Property " + propertyName + " on interface " + interfaceName + " is read-only";
-                break;
+            if( prop->access_type() != DBus::PropertyAccess::ReadOnly ){
+                prop->set_value( variantValue );
+                conn << retmsg;
+                return HandlerResult::Handled;
             }
+
+            errName = DBUSCXX_ERROR_PROPERTY_READ_ONLY;
+            errMsg = "Property " + propertyName + " on interface " + interfaceName + " is read-only";
         }
     }
 
@@ -401,56 +417,216 @@ bool Interface::add_property( std::shared_ptr<PropertyBase> prop ) {
 
     if( !prop ) { return false; }
 
-    if( has_property( prop->name() ) ) { return false; }
-
     {
         std::unique_lock lock( m_priv->m_properties_rwlock );
 
+        if( !m_priv->m_properties_by_name.emplace( prop->name(), prop ).second ) { return false; }
+
         m_priv->m_properties.insert( prop );
     }
 
+    priv::introspection_changed();
+    m_priv->m_properties_generation.fetch_add( 1, std::memory_order_acq_rel );
+
     //m_priv->m_signal_method_added.emit( method );
     prop->setInterface( this );
 
     return result;
 }
 
-bool Interface::has_property( const std::string& name ) const {
-    bool result = false;
+bool Interface::has_property( std::string_view name ) const {
     std::shared_lock lock( m_priv->m_properties_rwlock );
 
-    for( std::set<std::shared_ptr<PropertyBase>>::iterator i = m_priv->m_properties.begin();
-         i != m_priv->m_properties.end();
-         i++ ) {
-        if( ( *i )->name() == name ) {
-            result = true;
+    return m_priv->m_properties_by_name.find( name ) != m_priv->m_properties_by_name.end();
+}
+
+std::shared_ptr<PropertyBase> Interface::property( std::string_view name ) const {
+    std::shared_lock lock( m_priv->m_properties_rwlock );
+    PropertiesByName::const_iterator it = m_priv->m_properties_by_name.find( name );
+
+    if( it == m_priv->m_properties_by_name.end() ) { return std::shared_ptr<PropertyBase>(); }
+
+    return it->second;
+}
+
+std::shared_ptr<const ReturnMessage> Interface::get_all_reply() const {
+    std::scoped_lock lock( m_priv->m_get_all_mutex );
+    uint64_t generation = m_priv->m_properties_generation.load( std::memory_order_acquire );
+
+    if( m_priv->m_get_all_reply && m_priv->m_get_all_generation == generation ){
+        return m_priv->m_get_all_reply;
+    }
+
+    std::map<std::string,DBus::Variant> retval;
+
+    for( std::shared_ptr<DBus::PropertyBase> prop : m_priv->m_properties ){
+        std::shared_ptr<const Variant> value = prop->shared_value();
+
+        if( value->type() == DataType::INVALID ){
+            // The property has not been set, so we must assume that it does not exist
+            continue;
+        }
+
+        switch( prop->access_type() ){
+        case DBus::PropertyAccess::ReadOnly:
+        case DBus::PropertyAccess::ReadWrite:
+            retval[ prop->name() ] = *value;
             break;
+        case DBus::PropertyAccess::WriteOnly:
+            continue;
         }
     }
 
-    return result;
+    /* Replies are only ever copied from this, so it never needs a serial or destination */
+    m_priv->m_get_all_reply = ReturnMessage::create();
+    m_priv->m_get_all_reply << retval;
+    m_priv->m_get_all_generation = generation;
+
+    return m_priv->m_get_all_reply;
+}
+
+void Interface::append_properties( MessageAppendIterator& iter ) const {
+    std::shared_lock lock( m_priv->m_properties_rwlock );
+
+    append_readable_properties( iter );
+}
+
+void Interface::append_readable_properties( MessageAppendIterator& iter ) const {
+    iter.open_container( ContainerType::ARRAY, "{sv}" );
+
+    for( std::shared_ptr<DBus::PropertyBase> prop : m_priv->m_properties ){
+        std::shared_ptr<const Variant> value = prop->shared_value();
+
+        if( value->type() == DataType::INVALID ||
+            prop->access_type() == DBus::PropertyAccess::WriteOnly ){
+            continue;
+        }
+
+        iter.sub_iterator()->open_container( ContainerType::DICT_ENTRY, std::string() );
+        *( iter.sub_iterator()->sub_iterator() ) << prop->name() << *value;
+        iter.sub_iterator()->close_container();
+    }
+
+    iter.close_container();
 }
 
 void Interface::property_updated( DBus::PropertyBase* prop ){
-    std::shared_ptr<SignalMessage> sigChanged = SignalMessage::create( m_priv->m_path,
-                                                                       DBUS_CXX_PROPERTIES_INTERFACE,
-                                                                       "PropertiesChanged" );
+    m_priv->m_properties_generation.fetch_add( 1, std::memory_order_acq_rel );
+
+    switch( prop->update_type() ){
+    case DBus::PropertyUpdateType::Const:
+    case DBus::PropertyUpdateType::DoesNotUpdate:
+        return;
+    case DBus::PropertyUpdateType::Updates:
+    case DBus::PropertyUpdateType::Invalidates:
+        break;
+    }
 
+    std::shared_ptr<Connection> conn = m_priv->m_connection.lock();
+
+    {
+        std::scoped_lock lock( m_priv->m_changes_mutex );
+
+        if( prop->update_type() == DBus::PropertyUpdateType::Invalidates ){
+            m_priv->m_changed.erase( prop->name() );
+            m_priv->m_invalidated.insert( prop->name() );
+        } else {
+            m_priv->m_invalidated.erase( prop->name() );
+            m_priv->m_changed[ prop->name() ] = *prop->shared_value();
+        }
+
+        if( m_priv->m_change_batches > 0 ){
+            return;
+        }
+
+        if( m_priv->m_coalesce_changes && conn ){
+            if( !m_priv->m_send_changes_queued ){
+                std::weak_ptr<Interface> weak_this = weak_from_this();
+
+                m_priv->m_send_changes_queued = true;
+                conn->run_before_next_flush( [weak_this](){
+                    std::shared_ptr<Interface> iface = weak_this.lock();
+
+                    if( iface ){ iface->send_property_changes(); }
+                } );
+            }
+
+            return;
+        }
+    }
+
+    send_property_changes();
+}
+
+void Interface::send_property_changes(){
     std::map<std::string,DBus::Variant> changed;
-    std::vector<std::string> invalidated;
+    std::set<std::string> invalidatedSet;
 
-    changed[ prop->name() ] = prop->variant_value();
+    {
+        std::scoped_lock lock( m_priv->m_changes_mutex );
 
-    sigChanged << m_priv->m_name << changed << invalidated;
+        changed.swap( m_priv->m_changed );
+        invalidatedSet.swap( m_priv->m_invalidated );
+        m_priv->m_send_changes_queued = false;
+    }
+
+    if( changed.empty() && invalidatedSet.empty() ){
+        return;
+    }
 
     std::shared_ptr<Connection> conn = m_priv->m_connection.lock();
     if( !conn ){
         return;
     }
 
+    std::vector<std::string> invalidated( invalidatedSet.begin(), invalidatedSet.end() );
+    std::shared_ptr<SignalMessage> sigChanged = SignalMessage::create( m_priv->m_path,
+                                                                       DBUS_CXX_PROPERTIES_INTERFACE,
+                                                                       "PropertiesChanged" );
+
+    sigChanged << m_priv->m_name << changed << invalidated;
+
     conn << sigChanged;
 }
 
+void Interface::begin_property_changes(){
+    std::scoped_lock lock( m_priv->m_changes_mutex );
+
+    m_priv->m_change_batches++;
+}
+
+void Interface::end_property_changes(){
+    {
+        std::scoped_lock lock( m_priv->m_changes_mutex );
+
+        if( m_priv->m_change_batches == 0 || --m_priv->m_change_batches > 0 ){
+            return;
+        }
+    }
+
+    send_property_changes();
+}
+
+void Interface::set_coalesce_property_changes( bool coalesce ){
+    {
+        std::scoped_lock lock( m_priv->m_changes_mutex );
+
+        m_priv->m_coalesce_changes = coalesce;
+
+        if( coalesce || m_priv->m_change_batches > 0 ){
+            return;
+        }
+    }
+
+    send_property_changes();
+}
+
+bool Interface::coalesce_property_changes() const {
+    std::scoped_lock lock( m_priv->m_changes_mutex );
+
+    return m_priv->m_coalesce_changes;
+}
+
 void Interface::set_connection( std::weak_ptr<Connection> conn ){
     m_priv->m_connection = conn;
 
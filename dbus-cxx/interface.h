@@ -14,8 +14,10 @@
 #include <sigc++/sigc++.h>
 #include <set>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <string_view>
 
 #ifndef DBUSCXX_INTERFACE_H
 #define DBUSCXX_INTERFACE_H
@@ -23,7 +25,9 @@
 namespace DBus {
 class CallMessage;
 class Connection;
+class MessageAppendIterator;
 class Object;
+class ReturnMessage;
 class SignalBase;
 
 /**
@@ -38,7 +42,7 @@ class SignalBase;
  *
  * @author Rick L Vinyard Jr <rvinyard@cs.nmsu.edu>
  */
-class Interface {
+class Interface : public std::enable_shared_from_this<Interface> {
 protected:
     /**
      * This class has a protected constructor. Use the \c create() methods
@@ -157,7 +161,13 @@ public:
 
     bool add_property( std::shared_ptr<PropertyBase> prop );
 
-    bool has_property( const std::string& name ) const;
+    bool has_property( std::string_view name ) const;
+
+    /**
+     * Returns the property with the given name, or an empty pointer if this
+     * interface has no such property.
+     */
+    std::shared_ptr<PropertyBase> property( std::string_view name ) const;
 
     /** Adds the named method */
     bool add_method( std::shared_ptr<MethodBase> method );
@@ -238,9 +248,56 @@ public:
     /** Returns a DBus XML description of this interface */
     std::string introspect( int space_depth = 0 ) const;
 
+    /**
+     * Hold back PropertiesChanged signals from this interface until
+     * end_property_changes() has been called as many times as this.  All
+     * of the properties set in between are then sent in one signal.
+     *
+     * PropertyChangeBatch does this for the scope that it is in.
+     */
+    void begin_property_changes();
+
+    void end_property_changes();
+
+    /**
+     * If set, a PropertiesChanged signal is not sent as soon as a property
+     * is set, but the next time that the connection is dispatched.  All of
+     * the properties that are set while handling one message, or from
+     * another thread before the dispatcher gets to them, are then sent in
+     * one signal.  Off by default.
+     */
+    void set_coalesce_property_changes( bool coalesce );
+
+    bool coalesce_property_changes() const;
+
 private:
     void set_path( const std::string& new_path );
     void property_updated( DBus::PropertyBase* prop );
+
+    /**
+     * A reply to GetAll that holds the values of the properties.  It is kept
+     * until a property is added or set, so that repeated calls to GetAll only
+     * copy the marshaled values.  Must be called with the properties locked.
+     */
+    std::shared_ptr<const ReturnMessage> get_all_reply() const;
+
+    /**
+     * Append the properties that GetAll would return as an a{sv}, straight
+     * into the message without building a map of them first.
+     */
+    void append_properties( MessageAppendIterator& iter ) const;
+
+    /**
+     * Does the work of append_properties().  Must be called with the
+     * properties locked.
+     */
+    void append_readable_properties( MessageAppendIterator& iter ) const;
+
+    /**
+     * Send the property changes that are being held back, if there are any.
+     */
+    void send_property_changes();
+
     void set_connection( std::weak_ptr<Connection> conn );
 
 private:
@@ -252,6 +309,37 @@ private:
     friend class PropertyBase;
 };
 
+/**
+ * Holds back PropertiesChanged signals from an interface for as long as it
+ * exists, so that properties set together are sent in one signal.
+ *
+ * @code
+ * {
+ *     DBus::PropertyChangeBatch batch( interface );
+ *     voltage->set_value( 12.1 );
+ *     current->set_value( 0.5 );
+ * } // One PropertiesChanged signal is sent here
+ * @endcode
+ */
+class PropertyChangeBatch {
+public:
+    PropertyChangeBatch( std::shared_ptr<Interface> interface_ptr ) :
+        m_interface( interface_ptr ) {
+        if( m_interface ) { m_interface->begin_property_changes(); }
+    }
+
+    ~PropertyChangeBatch() {
+        if( m_interface ) { m_interface->end_property_changes(); }
+    }
+
+    PropertyChangeBatch( const PropertyChangeBatch& ) = delete;
+
+    PropertyChangeBatch& operator=( const PropertyChangeBatch& ) = delete;
+
+private:
+    std::shared_ptr<Interface> m_interface;
+};
+
 } /* namespace DBus */
 
 #endif /* DBUS_CXX_INTERFACE_H */
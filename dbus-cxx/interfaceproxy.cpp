@@ -6,9 +6,12 @@
  *   This file is part of the dbus-cxx library.                            *
  ***************************************************************************/
 #include "interfaceproxy.h"
+#include <atomic>
 #include <map>
 #include <utility>
 #include "connection.h"
+#include "dbus-error.h"
+#include "errormessage.h"
 #include "methodproxybase.h"
 #include "objectproxy.h"
 #include <sigc++/sigc++.h>
@@ -27,7 +30,9 @@ class InterfaceProxy::priv_data {
 public:
     priv_data( const std::string& name ):
         m_object( nullptr ),
-        m_name( name ) {}
+        m_name( name ),
+        m_cache_properties( false ),
+        m_property_generation( 0 ) {}
 
     ObjectProxy* m_object;
     const std::string m_name;
@@ -37,6 +42,8 @@ public:
     mutable std::shared_mutex m_properties_rwlock;
     std::map<std::string,std::shared_ptr<PropertyProxyBase>> m_properties;
     std::shared_ptr<DBus::SignalProxy<void(std::string,std::map<std::string,DBus::Variant>,std::vector<std::string>)>> m_updated_proxy;
+    std::atomic<bool> m_cache_properties;
+    std::atomic<uint64_t> m_property_generation;
 };
 
 InterfaceProxy::InterfaceProxy( const std::string& name ) {
@@ -67,13 +74,19 @@ void InterfaceProxy::set_object( ObjectProxy* obj ) {
 
     std::shared_ptr<Connection> conn = connection().lock();
     if( conn ){
+        DBus::MatchRuleBuilder rule = DBus::MatchRuleBuilder::create()
+            .set_path( path() )
+            .set_interface( DBUS_CXX_PROPERTIES_INTERFACE )
+            .set_member( "PropertiesChanged" );
+
+        // Only get the changes for this interface, instead of every interface on the object
+        if( !m_priv->m_name.empty() ){
+            rule.set_arg( 0, m_priv->m_name );
+        }
+
         m_priv->m_updated_proxy =
             conn->create_free_signal_proxy<void(std::string,std::map<std::string,DBus::Variant>,std::vector<std::string>)>(
-                DBus::MatchRuleBuilder::create()
-                .set_path( path() )
-                .set_interface( DBUS_CXX_PROPERTIES_INTERFACE )
-                .set_member( "PropertiesChanged" )
-                .as_signal_match()
+                rule.as_signal_match()
                 );
 
         m_priv->m_updated_proxy->connect( sigc::mem_fun( *this, &InterfaceProxy::property_updated ) );
@@ -87,7 +100,7 @@ void InterfaceProxy::set_object( ObjectProxy* obj ) {
             conn->remove_match( sig->match_rule() );
             sig->set_path( path() );
             sig->update_match_rule();
-            conn->add_match( sig->match_rule() );
+            conn->add_match_nonblocking( sig->match_rule() );
         }
     }
 }
@@ -224,11 +237,19 @@ std::shared_ptr<const ReturnMessage> InterfaceProxy::call( std::shared_ptr<const
     return m_priv->m_object->call( call_message, timeout_milliseconds );
 }
 
-//  std::shared_ptr<PendingCall> InterfaceProxy::call_async( std::shared_ptr<const CallMessage> call_message, int timeout_milliseconds ) const
-//  {
-//    if ( not m_priv->m_object ) return std::shared_ptr<PendingCall>();
-//    return m_priv->m_object->call_async( call_message, timeout_milliseconds );
-//  }
+std::shared_ptr<PendingCall> InterfaceProxy::call_async( std::shared_ptr<const CallMessage> call_message, int timeout_milliseconds ) const {
+    if( !m_priv->m_object ) { return std::shared_ptr<PendingCall>(); }
+
+    return m_priv->m_object->call_async( call_message, timeout_milliseconds );
+}
+
+std::shared_ptr<Message> InterfaceProxy::call_nothrow( std::shared_ptr<const CallMessage> call_message, int timeout_milliseconds ) const {
+    if( !m_priv->m_object ) {
+        return ErrorMessage::create( call_message, DBUSCXX_ERROR_DISCONNECTED, "Interface is not on an object" );
+    }
+
+    return m_priv->m_object->call_nothrow( call_message, timeout_milliseconds );
+}
 
 const InterfaceProxy::Signals& InterfaceProxy::signals() const {
     return m_priv->m_signals;
@@ -258,7 +279,7 @@ bool InterfaceProxy::add_signal( std::shared_ptr<SignalProxyBase> sig ) {
 
     std::shared_ptr<Connection> conn = connection().lock();
     if( conn ){
-        conn->add_match( sig->match_rule() );
+        conn->add_match_nonblocking( sig->match_rule() );
     }
 
     return true;
@@ -400,6 +421,10 @@ void InterfaceProxy::remove_property( std::shared_ptr<PropertyProxyBase> propert
 }
 
 void InterfaceProxy::cache_properties(){
+    if( !m_priv->m_object ){
+        return;
+    }
+
     std::shared_ptr<CallMessage> msg =
             CallMessage::create( m_priv->m_object->destination(), m_priv->m_object->path(), "org.freedesktop.DBus.Properties", "GetAll" );
     msg << m_priv->m_name;
@@ -416,10 +441,43 @@ void InterfaceProxy::cache_properties(){
          it++ ){
         SIMPLELOGGER_TRACE( LOGGER_NAME, "Caching property " << it->first << "=" << it->second );
         std::shared_ptr<DBus::PropertyProxyBase> prop = property( it->first );
-        prop->updated_value( it->second );
+
+        if( prop ){
+            prop->updated_value( it->second );
+        }
+    }
+
+    m_priv->m_property_generation.fetch_add( 1, std::memory_order_acq_rel );
+}
+
+void InterfaceProxy::set_property_caching( bool cache ){
+    m_priv->m_cache_properties = cache;
+
+    if( cache && !connection().expired() ){
+        cache_properties();
     }
 }
 
+bool InterfaceProxy::property_caching() const {
+    return m_priv->m_cache_properties;
+}
+
+void InterfaceProxy::invalidate_properties(){
+    {
+        std::shared_lock lock( m_priv->m_properties_rwlock );
+
+        for( std::pair<const std::string,std::shared_ptr<PropertyProxyBase>>& entry : m_priv->m_properties ){
+            entry.second->invalidate();
+        }
+    }
+
+    m_priv->m_property_generation.fetch_add( 1, std::memory_order_acq_rel );
+}
+
+uint64_t InterfaceProxy::property_generation() const {
+    return m_priv->m_property_generation.load( std::memory_order_acquire );
+}
+
 void InterfaceProxy::property_updated( std::string iface,
                                   std::map<std::string,DBus::Variant> changed,
                                   std::vector<std::string> invalidated ){
@@ -428,7 +486,6 @@ void InterfaceProxy::property_updated( std::string iface,
         return;
     }
 
-    std::shared_lock lock( m_priv->m_properties_rwlock );
     for( std::pair<std::string,DBus::Variant> entry : changed ){
         std::shared_ptr<PropertyProxyBase> prop = property( entry.first );
 
@@ -441,6 +498,21 @@ void InterfaceProxy::property_updated( std::string iface,
             prop->updated_value( entry.second );
         }
     }
+
+    // The new values are not sent, so they are fetched again the next time they are read
+    for( const std::string& name : invalidated ){
+        std::shared_ptr<PropertyProxyBase> prop = property( name );
+
+        if( prop ){
+            SIMPLELOGGER_TRACE( LOGGER_NAME, "Invalidating property '"
+                                << name
+                                << "' on interface '"
+                                << m_priv->m_name << "'" );
+            prop->invalidate();
+        }
+    }
+
+    m_priv->m_property_generation.fetch_add( 1, std::memory_order_acq_rel );
 }
 
 }
@@ -143,11 +143,33 @@ public:
      */
     void cache_properties();
 
+    /**
+     * Keep the values of the properties of this interface in memory, so
+     * that reading a property does not call the remote object.
+     *
+     * Turning this on fetches all of the properties with one GetAll call.
+     * After that, values are kept up to date from PropertiesChanged.  When
+     * the remote object invalidates a property, the next read of any stale
+     * property fetches them all again with one GetAll call.  Off by default,
+     * in which case each stale property is fetched on its own with Get.
+     */
+    void set_property_caching( bool cache );
+
+    bool property_caching() const;
+
+    /**
+     * @return The number of times the cached property values have changed,
+     * whether from a GetAll call, a new value, or an invalidation
+     */
+    uint64_t property_generation() const;
+
     std::shared_ptr<CallMessage> create_call_message( const std::string& method_name ) const;
 
     std::shared_ptr<const ReturnMessage> call( std::shared_ptr<const CallMessage>, int timeout_milliseconds = -1 ) const;
 
-    //      std::shared_ptr<PendingCall> call_async( std::shared_ptr<const CallMessage>, int timeout_milliseconds=-1 ) const;
+    std::shared_ptr<PendingCall> call_async( std::shared_ptr<const CallMessage>, int timeout_milliseconds = -1 ) const;
+
+    std::shared_ptr<Message> call_nothrow( std::shared_ptr<const CallMessage>, int timeout_milliseconds = -1 ) const;
 
     template <class T_arg>
     std::shared_ptr<SignalProxy<T_arg >> create_signal( const std::string& sig_name ) {
@@ -183,6 +205,12 @@ private:
 
     void property_updated( std::string,std::map<std::string,DBus::Variant>,std::vector<std::string> );
 
+    /**
+     * Mark every property as stale, so that it is fetched again the next
+     * time that it is read.
+     */
+    void invalidate_properties();
+
 private:
     class priv_data;
 
@@ -6,8 +6,17 @@
  *   This file is part of the dbus-cxx library.                            *
  ***************************************************************************/
 #include "matchrule.h"
-
+#include "error.h"
+#include "message.h"
+#include "signature.h"
+#include "variant.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
 #include <string>
+#include <string_view>
+#include <vector>
 
 using DBus::MatchRuleBuilder;
 using DBus::MatchRule;
@@ -17,18 +26,370 @@ using DBus::MethodReturnMatchRule;
 using DBus::ErrorMatchRule;
 
 /***************************************************************************/
+enum class ArgumentConditionType {
+    String,
+    Path,
+    Namespace,
+};
+
+struct ArgumentCondition {
+    int index;
+    ArgumentConditionType type;
+    std::string value;
+};
+
 class DBus::MatchRuleData {
 public:
     MatchRuleData(){}
 
+    /**
+     * Validate the rule and build the sorted list of argument conditions.
+     */
+    void compile();
+
     std::string m_type;
     std::string m_path;
     std::string m_interface;
     std::string m_member;
     std::string m_sender;
     std::string m_destination;
+    std::string m_path_namespace;
+    std::map<int, std::string> m_args;
+    std::map<int, std::string> m_arg_paths;
+    std::string m_arg0_namespace;
+    /* Compiled form of m_args, m_arg_paths and m_arg0_namespace, sorted by index */
+    std::vector<ArgumentCondition> m_conditions;
 };
 
+void DBus::MatchRuleData::compile() {
+    if( !m_path.empty() && !m_path_namespace.empty() ) {
+        throw ErrorMatchRuleInvalid( "path and path_namespace may not both be set" );
+    }
+
+    m_conditions.clear();
+
+    for( const std::pair<const int, std::string>& arg : m_args ) {
+        m_conditions.push_back( ArgumentCondition{ arg.first, ArgumentConditionType::String, arg.second } );
+    }
+
+    for( const std::pair<const int, std::string>& arg : m_arg_paths ) {
+        m_conditions.push_back( ArgumentCondition{ arg.first, ArgumentConditionType::Path, arg.second } );
+    }
+
+    if( !m_arg0_namespace.empty() ) {
+        m_conditions.push_back( ArgumentCondition{ 0, ArgumentConditionType::Namespace, m_arg0_namespace } );
+    }
+
+    std::stable_sort( m_conditions.begin(), m_conditions.end(),
+        []( const ArgumentCondition& a, const ArgumentCondition& b ) {
+            return a.index < b.index;
+        } );
+}
+
+/***************************************************************************/
+/**
+ * Walks the top-level arguments of a message body.  Arguments that no
+ * condition refers to are skipped by looking only at their lengths; only
+ * the strings that we need to compare are looked at.
+ */
+class BodyScanner {
+public:
+    BodyScanner( const std::vector<uint8_t>& body, DBus::Endianess endian, const std::string& signature ) :
+        m_data( body.data() ),
+        m_len( body.size() ),
+        m_pos( 0 ),
+        m_endian( endian ),
+        m_signature( signature ),
+        m_sigPos( 0 ) {}
+
+    bool at_end() const {
+        return m_sigPos >= m_signature.size();
+    }
+
+    char current_type() const {
+        return m_signature[ m_sigPos ];
+    }
+
+    /**
+     * Skip the current top-level argument.
+     */
+    bool skip_argument() {
+        return skip_single( m_signature, &m_sigPos );
+    }
+
+    /**
+     * Read the current top-level argument, which must be a string or
+     * an object path.  The view points into the message body.
+     */
+    bool read_string( std::string_view* out ) {
+        if( !read_string_data( out ) ) { return false; }
+
+        m_sigPos++;
+        return true;
+    }
+
+private:
+    static uint32_t alignment_of( char type ) {
+        switch( type ) {
+        case 'y':
+        case 'g':
+        case 'v':
+            return 1;
+
+        case 'n':
+        case 'q':
+            return 2;
+
+        case 'x':
+        case 't':
+        case 'd':
+        case '(':
+        case '{':
+            return 8;
+
+        default:
+            return 4;
+        }
+    }
+
+    /**
+     * Return the index just past the single complete type starting at pos.
+     */
+    static size_t end_of_single_type( const std::string& sig, size_t pos ) {
+        if( pos >= sig.size() ) { return sig.size(); }
+
+        if( sig[ pos ] == 'a' ) {
+            return end_of_single_type( sig, pos + 1 );
+        }
+
+        if( sig[ pos ] == '(' || sig[ pos ] == '{' ) {
+            int depth = 0;
+
+            for( ; pos < sig.size(); pos++ ) {
+                if( sig[ pos ] == '(' || sig[ pos ] == '{' ) { depth++; }
+
+                if( sig[ pos ] == ')' || sig[ pos ] == '}' ) { depth--; }
+
+                if( depth == 0 ) { return pos + 1; }
+            }
+
+            return sig.size();
+        }
+
+        return pos + 1;
+    }
+
+    bool align( uint32_t alignment ) {
+        m_pos = ( m_pos + alignment - 1 ) & ~( static_cast<size_t>( alignment ) - 1 );
+        return m_pos <= m_len;
+    }
+
+    bool skip_bytes( size_t num ) {
+        if( m_len - m_pos < num ) { return false; }
+
+        m_pos += num;
+        return true;
+    }
+
+    bool read_uint32( uint32_t* out ) {
+        if( !align( 4 ) || m_len - m_pos < 4 ) { return false; }
+
+        const uint8_t* b = m_data + m_pos;
+
+        if( m_endian == DBus::Endianess::Little ) {
+            *out = b[ 0 ] | ( b[ 1 ] << 8 ) | ( b[ 2 ] << 16 ) | ( static_cast<uint32_t>( b[ 3 ] ) << 24 );
+        } else {
+            *out = ( static_cast<uint32_t>( b[ 0 ] ) << 24 ) | ( b[ 1 ] << 16 ) | ( b[ 2 ] << 8 ) | b[ 3 ];
+        }
+
+        m_pos += 4;
+        return true;
+    }
+
+    bool read_string_data( std::string_view* out ) {
+        uint32_t len;
+
+        if( !read_uint32( &len ) ) { return false; }
+
+        if( m_len - m_pos < static_cast<size_t>( len ) + 1 ) { return false; }
+
+        *out = std::string_view( reinterpret_cast<const char*>( m_data + m_pos ), len );
+        m_pos += len + 1;
+        return true;
+    }
+
+    bool read_signature( std::string* out ) {
+        if( m_pos >= m_len ) { return false; }
+
+        uint8_t len = m_data[ m_pos++ ];
+
+        if( m_len - m_pos < static_cast<size_t>( len ) + 1 ) { return false; }
+
+        out->assign( reinterpret_cast<const char*>( m_data + m_pos ), len );
+        m_pos += len + 1;
+        return true;
+    }
+
+    /**
+     * Skip over the value of the single complete type at sig[*sigPos],
+     * and advance *sigPos past that type.
+     */
+    bool skip_single( const std::string& sig, size_t* sigPos ) {
+        if( *sigPos >= sig.size() ) { return false; }
+
+        char type = sig[ *sigPos ];
+
+        switch( type ) {
+        case 'y':
+            ( *sigPos )++;
+            return skip_bytes( 1 );
+
+        case 'n':
+        case 'q':
+            ( *sigPos )++;
+            return align( 2 ) && skip_bytes( 2 );
+
+        case 'b':
+        case 'i':
+        case 'u':
+        case 'h':
+            ( *sigPos )++;
+            return align( 4 ) && skip_bytes( 4 );
+
+        case 'x':
+        case 't':
+        case 'd':
+            ( *sigPos )++;
+            return align( 8 ) && skip_bytes( 8 );
+
+        case 's':
+        case 'o': {
+            std::string_view discard;
+            ( *sigPos )++;
+            return read_string_data( &discard );
+        }
+
+        case 'g': {
+            std::string discard;
+            ( *sigPos )++;
+            return read_signature( &discard );
+        }
+
+        case 'v': {
+            std::string variantSig;
+            size_t variantPos = 0;
+            ( *sigPos )++;
+
+            if( !read_signature( &variantSig ) ) { return false; }
+
+            return skip_single( variantSig, &variantPos );
+        }
+
+        case 'a': {
+            uint32_t arrayLen;
+            size_t elementEnd = end_of_single_type( sig, *sigPos + 1 );
+
+            if( !read_uint32( &arrayLen ) ) { return false; }
+
+            if( !align( alignment_of( sig[ *sigPos + 1 ] ) ) ) { return false; }
+
+            *sigPos = elementEnd;
+            return skip_bytes( arrayLen );
+        }
+
+        case '(':
+        case '{': {
+            char close = ( type == '(' ) ? ')' : '}';
+
+            if( !align( 8 ) ) { return false; }
+
+            ( *sigPos )++;
+
+            while( *sigPos < sig.size() && sig[ *sigPos ] != close ) {
+                if( !skip_single( sig, sigPos ) ) { return false; }
+            }
+
+            ( *sigPos )++;
+            return true;
+        }
+
+        default:
+            return false;
+        }
+    }
+
+private:
+    const uint8_t* m_data;
+    size_t m_len;
+    size_t m_pos;
+    DBus::Endianess m_endian;
+    const std::string& m_signature;
+    size_t m_sigPos;
+};
+
+static bool path_matches( std::string_view arg, const std::string& value ) {
+    if( arg == value ) { return true; }
+
+    if( !value.empty() && value.back() == '/' &&
+        arg.size() > value.size() && arg.compare( 0, value.size(), value ) == 0 ) {
+        return true;
+    }
+
+    if( !arg.empty() && arg.back() == '/' &&
+        value.size() > arg.size() && value.compare( 0, arg.size(), arg ) == 0 ) {
+        return true;
+    }
+
+    return false;
+}
+
+static bool namespace_matches( std::string_view arg, const std::string& name_namespace ) {
+    if( arg.size() < name_namespace.size() ) { return false; }
+
+    if( arg.compare( 0, name_namespace.size(), name_namespace ) != 0 ) { return false; }
+
+    return arg.size() == name_namespace.size() || arg[ name_namespace.size() ] == '.';
+}
+
+static bool condition_matches( const ArgumentCondition& condition, char argType, std::string_view arg ) {
+    switch( condition.type ) {
+    case ArgumentConditionType::String:
+        return argType == 's' && arg == condition.value;
+
+    case ArgumentConditionType::Path:
+        return path_matches( arg, condition.value );
+
+    case ArgumentConditionType::Namespace:
+        return argType == 's' && namespace_matches( arg, condition.value );
+    }
+
+    return false;
+}
+
+static std::string header_string( std::shared_ptr<const DBus::Message> msg, DBus::MessageHeaderFields field ) {
+    DBus::Variant value = msg->header_field( field );
+
+    if( value.type() == DBus::DataType::STRING ) { return value.to_string(); }
+
+    if( value.type() == DBus::DataType::OBJECT_PATH ) { return value.to_path(); }
+
+    return std::string();
+}
+
+static std::string escape_value( const std::string& value ) {
+    std::string escaped;
+
+    for( char c : value ) {
+        if( c == '\'' ) {
+            escaped += "'\\''";
+        } else {
+            escaped += c;
+        }
+    }
+
+    return escaped;
+}
+
 
 /***************************************************************************/
 MatchRuleBuilder::MatchRuleBuilder() :
@@ -60,26 +421,58 @@ MatchRuleBuilder& MatchRuleBuilder::set_destination( const std::string& destinat
     return *this;
 }
 
+MatchRuleBuilder& MatchRuleBuilder::set_path_namespace( const std::string& path_namespace ) {
+    m_priv->m_path_namespace = path_namespace;
+    return *this;
+}
+
+MatchRuleBuilder& MatchRuleBuilder::set_arg( int argN, const std::string& value ) {
+    if( argN < 0 || argN > 63 ) {
+        throw ErrorMatchRuleInvalid( "argN must be between 0 and 63" );
+    }
+
+    m_priv->m_args[ argN ] = value;
+    return *this;
+}
+
+MatchRuleBuilder& MatchRuleBuilder::set_arg_path( int argN, const std::string& value ) {
+    if( argN < 0 || argN > 63 ) {
+        throw ErrorMatchRuleInvalid( "argNpath must be between 0 and 63" );
+    }
+
+    m_priv->m_arg_paths[ argN ] = value;
+    return *this;
+}
+
+MatchRuleBuilder& MatchRuleBuilder::set_arg0_namespace( const std::string& name_namespace ) {
+    m_priv->m_arg0_namespace = name_namespace;
+    return *this;
+}
+
+/*
+ * Each rule gets its own copy of the data, so that changing the builder
+ * afterwards does not change rules that have already been built.
+ */
 SignalMatchRule MatchRuleBuilder::as_signal_match(){
-    SignalMatchRule sig( m_priv );
+    SignalMatchRule sig( std::make_shared<MatchRuleData>( *m_priv ) );
 
     return sig;
 }
 
 MethodCallMatchRule MatchRuleBuilder::as_method_call_match(){
-    MethodCallMatchRule meth( m_priv );
+    MethodCallMatchRule meth( std::make_shared<MatchRuleData>( *m_priv ) );
 
     return meth;
 }
 
 MethodReturnMatchRule MatchRuleBuilder::as_method_return_match(){
-    MethodReturnMatchRule meth( m_priv );
+    MethodReturnMatchRule meth( std::make_shared<MatchRuleData>( *m_priv ) );
 
     return meth;
 }
 
 ErrorMatchRule MatchRuleBuilder::as_error_match(){
-    ErrorMatchRule err( m_priv );
+    ErrorMatchRule err( std::make_shared<MatchRuleData>( *m_priv ) );
 
     return err;
 }
@@ -89,10 +482,38 @@ MatchRuleBuilder MatchRuleBuilder::create(){
     return build;
 }
 
+MatchRuleBuilder MatchRuleBuilder::create( const MatchRule& rule ){
+    MatchRuleBuilder build;
+    *build.m_priv = *rule.m_priv;
+    return build;
+}
+
 /***************************************************************************/
 MatchRule::MatchRule( std::string type, std::shared_ptr<MatchRuleData> data ) :
     m_priv( data ){
     m_priv->m_type = type;
+    m_priv->compile();
+}
+
+/* The data is immutable once the rule is built, so copies can share it */
+static std::shared_ptr<DBus::MatchRuleData> shared_data( const DBUS_CXX_PROPAGATE_CONST( std::shared_ptr<DBus::MatchRuleData> )& data ) {
+#if DBUS_CXX_HAS_PROP_CONST
+    return std::experimental::get_underlying( data );
+#else
+    return data;
+#endif
+}
+
+MatchRule::MatchRule( const MatchRule& other ) :
+    m_priv( shared_data( other.m_priv ) ) {
+}
+
+MatchRule& MatchRule::operator=( const MatchRule& other ) {
+    if( this != &other ) {
+        m_priv = shared_data( other.m_priv );
+    }
+
+    return *this;
 }
 
 std::string MatchRule::path() const {
@@ -107,6 +528,108 @@ std::string MatchRule::member() const {
     return m_priv->m_member;
 }
 
+std::string MatchRule::sender() const {
+    return m_priv->m_sender;
+}
+
+std::string MatchRule::destination() const {
+    return m_priv->m_destination;
+}
+
+std::string MatchRule::path_namespace() const {
+    return m_priv->m_path_namespace;
+}
+
+bool MatchRule::matches( std::shared_ptr<const Message> msg ) const {
+    if( !msg || !msg->is_valid() ) { return false; }
+
+    if( ( m_priv->m_type == "signal" && msg->type() != MessageType::SIGNAL ) ||
+        ( m_priv->m_type == "method_call" && msg->type() != MessageType::CALL ) ||
+        ( m_priv->m_type == "method_return" && msg->type() != MessageType::RETURN ) ||
+        ( m_priv->m_type == "error" && msg->type() != MessageType::ERROR ) ) {
+        return false;
+    }
+
+    if( !m_priv->m_interface.empty() &&
+        m_priv->m_interface != header_string( msg, MessageHeaderFields::Interface ) ) {
+        return false;
+    }
+
+    if( !m_priv->m_member.empty() &&
+        m_priv->m_member != header_string( msg, MessageHeaderFields::Member ) ) {
+        return false;
+    }
+
+    if( !m_priv->m_sender.empty() && m_priv->m_sender[ 0 ] == ':' &&
+        m_priv->m_sender != msg->sender() ) {
+        return false;
+    }
+
+    if( !m_priv->m_destination.empty() && m_priv->m_destination != msg->destination() ) {
+        return false;
+    }
+
+    if( !m_priv->m_path.empty() || !m_priv->m_path_namespace.empty() ) {
+        std::string msgPath = header_string( msg, MessageHeaderFields::Path );
+
+        if( !m_priv->m_path.empty() && m_priv->m_path != msgPath ) { return false; }
+
+        if( !matches_path_namespace( msgPath ) ) { return false; }
+    }
+
+    return matches_arguments( msg );
+}
+
+bool MatchRule::matches_arguments( std::shared_ptr<const Message> msg ) const {
+    const std::vector<ArgumentCondition>& conditions = m_priv->m_conditions;
+
+    if( conditions.empty() ) { return true; }
+
+    if( !msg ) { return false; }
+
+    const std::string signature = msg->signature().str();
+    BodyScanner scanner( *msg->body(), msg->endianess(), signature );
+    std::vector<ArgumentCondition>::const_iterator condition = conditions.begin();
+
+    for( int argIndex = 0; condition != conditions.end(); argIndex++ ) {
+        if( scanner.at_end() ) {
+            // Fewer arguments than the rule asks about
+            return false;
+        }
+
+        if( condition->index != argIndex ) {
+            if( !scanner.skip_argument() ) { return false; }
+
+            continue;
+        }
+
+        char argType = scanner.current_type();
+        std::string_view arg;
+
+        if( argType != 's' && argType != 'o' ) {
+            return false;
+        }
+
+        if( !scanner.read_string( &arg ) ) { return false; }
+
+        for( ; condition != conditions.end() && condition->index == argIndex; condition++ ) {
+            if( !condition_matches( *condition, argType, arg ) ) { return false; }
+        }
+    }
+
+    return true;
+}
+
+bool MatchRule::matches_path_namespace( const std::string& path ) const {
+    const std::string& path_namespace = m_priv->m_path_namespace;
+
+    if( path_namespace.empty() || path_namespace == "/" ) { return true; }
+
+    if( path.compare( 0, path_namespace.size(), path_namespace ) != 0 ) { return false; }
+
+    return path.size() == path_namespace.size() || path[ path_namespace.size() ] == '/';
+}
+
 std::string MatchRule::match_rule() const {
     std::string match_rule = "type='" + m_priv->m_type + "'";
 
@@ -120,6 +643,18 @@ std::string MatchRule::match_rule() const {
 
     if( !m_priv->m_destination.empty() ) { match_rule += ",destination='" + m_priv->m_destination + "'"; }
 
+    if( !m_priv->m_path_namespace.empty() ) { match_rule += ",path_namespace='" + m_priv->m_path_namespace + "'"; }
+
+    for( const std::pair<const int, std::string>& arg : m_priv->m_args ) {
+        match_rule += ",arg" + std::to_string( arg.first ) + "='" + escape_value( arg.second ) + "'";
+    }
+
+    for( const std::pair<const int, std::string>& arg : m_priv->m_arg_paths ) {
+        match_rule += ",arg" + std::to_string( arg.first ) + "path='" + escape_value( arg.second ) + "'";
+    }
+
+    if( !m_priv->m_arg0_namespace.empty() ) { match_rule += ",arg0namespace='" + m_priv->m_arg0_namespace + "'"; }
+
     return match_rule;
 }
 
@@ -9,21 +9,37 @@
 #define DBUSCXX_MATCH_RULE_H
 
 #include <memory>
+#include <string>
 #include <dbus-cxx/dbus-cxx-config.h>
 
 namespace DBus {
 
+class Message;
 class MatchRuleBuilder;
 class MatchRuleData;
 
 /**
  * Immutable class that represents a match rule for DBus.
+ *
+ * When the rule is created, any argN, argNpath and arg0namespace
+ * conditions are compiled into a list sorted by argument index which is
+ * shared between all copies of the rule.  Evaluating these conditions
+ * only skips over the message body to reach the arguments that are
+ * needed; nothing else is demarshaled.
  */
 class MatchRule {
 protected:
     MatchRule( std::string type, const std::shared_ptr<MatchRuleData> );
 
 public:
+    MatchRule( const MatchRule& other );
+
+    MatchRule( MatchRule&& other ) = default;
+
+    MatchRule& operator=( const MatchRule& other );
+
+    MatchRule& operator=( MatchRule&& other ) = default;
+
     std::string match_rule() const;
 
     std::string path() const;
@@ -32,6 +48,41 @@ public:
 
     std::string member() const;
 
+    std::string sender() const;
+
+    std::string destination() const;
+
+    std::string path_namespace() const;
+
+    /**
+     * Check the given message against every part of this rule.
+     *
+     * A sender that is a well-known name can only be resolved by the bus,
+     * so the sender is only compared if it is a unique name.
+     *
+     * @param msg The message to check
+     * @return True if the message matches this rule
+     */
+    bool matches( std::shared_ptr<const Message> msg ) const;
+
+    /**
+     * Check only the argN, argNpath and arg0namespace parts of this rule.
+     *
+     * @param msg The message to check
+     * @return True if the message matches, or if this rule has no
+     * argument conditions.
+     */
+    bool matches_arguments( std::shared_ptr<const Message> msg ) const;
+
+    /**
+     * Check only the path_namespace part of this rule.
+     *
+     * @param path The path to check
+     * @return True if the path is inside of the namespace, or if this rule
+     * has no path_namespace.
+     */
+    bool matches_path_namespace( const std::string& path ) const;
+
 private:
     DBUS_CXX_PROPAGATE_CONST( std::shared_ptr<MatchRuleData> ) m_priv;
 
@@ -72,6 +123,9 @@ private:
 /**
  * A builder to create match rules.  When you are done building the match rule,
  * call the appropriate method(asSignalMatch, asMethodCallMatch, etc).
+ *
+ * The as_*_match methods throw ErrorMatchRuleInvalid if the rule is not
+ * valid, for example if both a path and a path_namespace have been set.
  */
 class MatchRuleBuilder {
 protected:
@@ -88,6 +142,36 @@ public:
 
     MatchRuleBuilder& set_destination( const std::string& destination );
 
+    /**
+     * Match messages whose path is the given path or is a child of it.
+     * This may not be combined with set_path.
+     */
+    MatchRuleBuilder& set_path_namespace( const std::string& path_namespace );
+
+    /**
+     * Match messages whose argument number argN is a string equal to value.
+     *
+     * @param argN The argument index, from 0 to 63
+     * @param value The value to match
+     */
+    MatchRuleBuilder& set_arg( int argN, const std::string& value );
+
+    /**
+     * Match messages whose argument number argN is a string or object path
+     * equal to value, or where one of them ends in '/' and is a prefix
+     * of the other.
+     *
+     * @param argN The argument index, from 0 to 63
+     * @param value The path to match
+     */
+    MatchRuleBuilder& set_arg_path( int argN, const std::string& value );
+
+    /**
+     * Match messages whose first argument is a string that is the given
+     * bus or interface name, or is a name inside of it.
+     */
+    MatchRuleBuilder& set_arg0_namespace( const std::string& name_namespace );
+
     SignalMatchRule as_signal_match();
 
     MethodCallMatchRule as_method_call_match();
@@ -98,6 +182,11 @@ public:
 
     static MatchRuleBuilder create();
 
+    /**
+     * Create a builder that starts out with all of the values of the given rule.
+     */
+    static MatchRuleBuilder create( const MatchRule& rule );
+
 private:
     std::shared_ptr<MatchRuleData> m_priv;
 };
@@ -42,6 +42,7 @@ public:
     uint8_t m_flags;
     std::vector<int> m_filedescriptors;
     uint32_t m_serial;
+    std::weak_ptr<Connection> m_receivedOn;
 };
 
 Message::Message() {
@@ -392,6 +393,26 @@ void Message::clear_sig_and_data() {
     m_priv->m_body.clear();
 }
 
+bool Message::set_body_from( const Message& other ) {
+    if( other.m_priv->m_endianess != m_priv->m_endianess ||
+        !other.m_priv->m_filedescriptors.empty() ) {
+        return false;
+    }
+
+    clear_sig_and_data();
+
+    std::map<MessageHeaderFields, Variant>::const_iterator location =
+        other.m_priv->m_headerMap.find( MessageHeaderFields::Signature );
+
+    if( location != other.m_priv->m_headerMap.end() ) {
+        m_priv->m_headerMap[ MessageHeaderFields::Signature ] = location->second;
+    }
+
+    m_priv->m_body = other.m_priv->m_body;
+
+    return true;
+}
+
 uint8_t Message::flags() const {
     return m_priv->m_flags;
 }
@@ -400,6 +421,14 @@ void Message::set_flags( uint8_t flags ) {
     m_priv->m_flags = flags;
 }
 
+std::weak_ptr<Connection> Message::received_on() const {
+    return m_priv->m_receivedOn;
+}
+
+void Message::set_received_on( std::weak_ptr<Connection> conn ) {
+    m_priv->m_receivedOn = conn;
+}
+
 Variant Message::set_header_field( MessageHeaderFields field, Variant value ) {
     DBus::Variant retval = header_field( field );
 
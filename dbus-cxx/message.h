@@ -22,6 +22,7 @@
 #define DBUSCXX_MESSAGE_NO_AUTO_START_FLAG  0x02
 
 namespace DBus {
+class Connection;
 class ReturnMessage;
 
 /**
@@ -146,6 +147,19 @@ public:
 
     const std::vector<int>& filedescriptors() const;
 
+    /**
+     * Replace the body of this message with a copy of the body of another
+     * message.  This lets data that is sent over and over again be marshaled
+     * only once.
+     *
+     * The body can only be copied if both messages have the same endianess
+     * and the other message carries no file descriptors.
+     *
+     * @param other The message to copy the body from
+     * @return True if the body was copied, false otherwise.
+     */
+    bool set_body_from( const Message& other );
+
     static std::shared_ptr<Message> create_from_data( uint8_t* data, uint32_t data_len, std::vector<int> fds = std::vector<int>() );
 
 protected:
@@ -159,7 +173,15 @@ protected:
 
     void set_flags( uint8_t flags );
 
+    /**
+     * @return The connection that this message was received on; empty if
+     * it was not received from a connection
+     */
+    std::weak_ptr<Connection> received_on() const;
+
 private:
+    void set_received_on( std::weak_ptr<Connection> conn );
+
     std::vector<uint8_t>* body();
     const std::vector<uint8_t>* body() const;
     void add_filedescriptor( int fd );
@@ -173,6 +195,8 @@ private:
 
     friend class MessageAppendIterator;
     friend class MessageIterator;
+    friend class MatchRule;
+    friend class Connection;
     friend std::ostream& operator<<( std::ostream& os, const DBus::Message* msg );
 
 };
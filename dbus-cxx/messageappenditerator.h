@@ -145,11 +145,22 @@ public:
         return *this;
     }
 
-private:
+    /**
+     * Start a container, for data that is not held in a standard container
+     * and so can't simply be appended with operator<<.  The contents are
+     * appended to sub_iterator(), and close_container() ends the container.
+     *
+     * @param t The type of the container
+     * @param contained_signature The signature of what the container holds;
+     * for an array of dictionary entries this includes the braces
+     */
     bool open_container( ContainerType t, const std::string& contained_signature );
 
     bool close_container( );
 
+    /**
+     * @return The iterator for the container that is open, or nullptr
+     */
     MessageAppendIterator* sub_iterator();
 
 private:
@@ -232,15 +232,16 @@ public:
 
     template <typename Key, typename Data>
     void get_dict( std::map<Key, Data>& dict ) {
-        Key val_key;
-        Data val_data;
-
         MessageIterator subiter = this->recurse();
 
         while( subiter.is_valid() ) {
             MessageIterator subSubiter = subiter.recurse();
 
             while( subSubiter.is_valid() ) {
+                /* A fresh value each time, so that a nested container does not
+                 * pick up the entries of the one before it */
+                Key val_key;
+                Data val_data;
                 subSubiter >> val_key;
                 subSubiter >> val_data;
                 dict[ val_key ] = val_data;
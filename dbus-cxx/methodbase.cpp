@@ -38,6 +38,7 @@ void MethodBase::set_arg_name( size_t i, const std::string& name ) {
     }
 
     m_priv->m_arg_names[i] = name;
+    priv::introspection_changed();
 }
 
 std::string MethodBase::arg_name( size_t i ) const {
@@ -21,9 +21,12 @@
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 #include "enums.h"
 #include "error.h"
+#include "result.h"
 #include <sigc++/sigc++.h>
 
 #ifndef DBUSCXX_METHODBASE_H
@@ -112,6 +115,16 @@ public:
 
         if( !connection || !message ) { return HandlerResult::Not_Handled; }
 
+        if( !priv::signature_is_compatible( message->signature(), method_sig_gen.dbus_sig() ) ) {
+            std::shared_ptr<ErrorMessage> errmsg = ErrorMessage::create( message, DBUSCXX_ERROR_INVALID_SIGNATURE,
+                    "Expected signature " + method_sig_gen.dbus_sig() + ", got " + message->signature().str() );
+
+            if( !errmsg ) { return HandlerResult::Not_Handled; }
+
+            sendMessage( connection, errmsg );
+            return HandlerResult::Handled;
+        }
+
         try {
             std::shared_ptr<ReturnMessage> retmsg = message->create_reply();
 
@@ -153,6 +166,93 @@ private:
     sigc::slot<T_type> m_slot;
 };
 
+/**
+ * Method specialization for methods that return a Result.  If the Result
+ * holds an Error, it is sent back to the caller as an error reply, without
+ * an exception being thrown.
+ */
+template <typename T_return, typename... T_arg>
+class Method<Result<T_return>( T_arg... )> : public MethodBase {
+private:
+    Method( const std::string& name ) : MethodBase( name ) {}
+
+public:
+    static std::shared_ptr<Method> create( const std::string& name ) {
+        return std::shared_ptr<Method>( new Method( name ) );
+    }
+
+    void set_method( sigc::slot<Result<T_return>( T_arg... )> slot ) { m_slot = slot; }
+
+    virtual std::string introspect( int space_depth = 0 ) const {
+        std::ostringstream sout;
+        std::string spaces;
+        DBus::priv::dbus_function_traits<std::function<T_return( T_arg... )>> method_sig_gen;
+
+        for( int i = 0; i < space_depth; i++ ) { spaces += " "; }
+
+        sout << spaces << "<method name=\"" << name() << "\">\n";
+        sout << method_sig_gen.introspect( arg_names(), 0, spaces + "  " );
+        sout << spaces << "</method>\n";
+        return sout.str();
+    }
+
+    virtual HandlerResult handle_call_message( std::shared_ptr<Connection> connection, std::shared_ptr<const CallMessage> message ) {
+        DBus::priv::dbus_function_traits<std::function<T_return( T_arg... )>> method_sig_gen;
+
+        if( !connection || !message ) { return HandlerResult::Not_Handled; }
+
+        std::shared_ptr<Message> reply;
+
+        if( !priv::signature_is_compatible( message->signature(), method_sig_gen.dbus_sig() ) ) {
+            reply = ErrorMessage::create( message, DBUSCXX_ERROR_INVALID_SIGNATURE,
+                    "Expected signature " + method_sig_gen.dbus_sig() + ", got " + message->signature().str() );
+        } else {
+            try {
+                MessageIterator i = message->begin();
+                std::tuple<T_arg...> tup_args;
+                std::apply( [i]( auto&& ...arg ) mutable {
+                    ( void )( i >> ... >> arg );
+                },
+                tup_args );
+
+                Result<T_return> result = std::apply( m_slot, tup_args );
+
+                if( result ) {
+                    std::shared_ptr<ReturnMessage> retmsg = message->create_reply();
+
+                    if constexpr( !std::is_void_v<T_return> ) {
+                        if( retmsg ) { retmsg << result.value(); }
+                    }
+
+                    reply = retmsg;
+                } else {
+                    reply = ErrorMessage::create( message, result.error().name(), result.error().message() );
+                }
+            } catch( ErrorInvalidTypecast& e ) {
+                reply = ErrorMessage::create( message, DBUSCXX_ERROR_INVALID_SIGNATURE, e.what() );
+            } catch( const std::exception& e ) {
+                reply = ErrorMessage::create( message, DBUSCXX_ERROR_FAILED, e.what() );
+            } catch( ... ) {
+                std::ostringstream stream;
+                stream << "DBus-cxx " << DBUS_CXX_PACKAGE_MAJOR_VERSION << "."
+                    << DBUS_CXX_PACKAGE_MINOR_VERSION << "."
+                    << DBUS_CXX_PACKAGE_MICRO_VERSION
+                    << ": unknown error(uncaught exception)";
+                reply = ErrorMessage::create( message, DBUSCXX_ERROR_FAILED, stream.str() );
+            }
+        }
+
+        if( !reply ) { return HandlerResult::Not_Handled; }
+
+        sendMessage( connection, reply );
+
+        return HandlerResult::Handled;
+    }
+
+private:
+    sigc::slot<Result<T_return>( T_arg... )> m_slot;
+};
+
 }
 
 #endif
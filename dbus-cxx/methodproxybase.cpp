@@ -8,20 +8,21 @@
 #include "methodproxybase.h"
 #include "callmessage.h"
 #include "interfaceproxy.h"
+#include "dbus-error.h"
+#include "errormessage.h"
 
 namespace DBus {
 
-class PendingCall;
-class ReturnMessage;
-
 class MethodProxyBase::priv_data {
 public:
     priv_data( const std::string& name ) :
         m_interface( nullptr ),
-        m_name( name ) {}
+        m_name( name ),
+        m_noReply( false ) {}
 
     InterfaceProxy* m_interface;
     const std::string m_name;
+    bool m_noReply;
 };
 
 
@@ -32,6 +33,7 @@ MethodProxyBase::MethodProxyBase( const std::string& name ):
 MethodProxyBase::MethodProxyBase( const MethodProxyBase& other ) :
     m_priv( std::make_unique<priv_data>( other.m_priv->m_name ) ) {
     m_priv->m_interface = other.m_priv->m_interface;
+    m_priv->m_noReply = other.m_priv->m_noReply;
 }
 
 std::shared_ptr<MethodProxyBase> MethodProxyBase::create( const std::string& name ) {
@@ -57,17 +59,33 @@ std::shared_ptr<CallMessage> DBus::MethodProxyBase::create_call_message() const
     return cm;
 }
 
+void MethodProxyBase::set_no_reply( bool no_reply ) {
+    m_priv->m_noReply = no_reply;
+}
+
+bool MethodProxyBase::no_reply() const {
+    return m_priv->m_noReply;
+}
+
 std::shared_ptr<const ReturnMessage> DBus::MethodProxyBase::call( std::shared_ptr<const CallMessage> call_message, int timeout_milliseconds ) const {
     if( !m_priv->m_interface ) { return std::shared_ptr<const ReturnMessage>(); }
 
     return m_priv->m_interface->call( call_message, timeout_milliseconds );
 }
 
-//  std::shared_ptr<PendingCall> DBus::MethodProxyBase::call_async(std::shared_ptr<const CallMessage> call_message, int timeout_milliseconds) const
-//  {
-//    if ( not m_priv->m_interface ) return std::shared_ptr<PendingCall>();
-//    return m_priv->m_interface->call_async(call_message, timeout_milliseconds);
-//  }
+std::shared_ptr<PendingCall> DBus::MethodProxyBase::call_async( std::shared_ptr<const CallMessage> call_message, int timeout_milliseconds ) const {
+    if( !m_priv->m_interface ) { return std::shared_ptr<PendingCall>(); }
+
+    return m_priv->m_interface->call_async( call_message, timeout_milliseconds );
+}
+
+std::shared_ptr<Message> DBus::MethodProxyBase::call_nothrow( std::shared_ptr<const CallMessage> call_message, int timeout_milliseconds ) const {
+    if( !m_priv->m_interface ) {
+        return ErrorMessage::create( call_message, DBUSCXX_ERROR_DISCONNECTED, "Method is not on an interface" );
+    }
+
+    return m_priv->m_interface->call_nothrow( call_message, timeout_milliseconds );
+}
 
 void MethodProxyBase::set_interface( InterfaceProxy* proxy ) {
     m_priv->m_interface = proxy;
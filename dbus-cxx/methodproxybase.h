@@ -8,7 +8,11 @@
  *   This file is part of the dbus-cxx library.                            *
  ***************************************************************************/
 #include <dbus-cxx/callmessage.h>
+#include <dbus-cxx/errormessage.h>
 #include <dbus-cxx/headerlog.h>
+#include <dbus-cxx/pendingcall.h>
+#include <dbus-cxx/result.h>
+#include <dbus-cxx/returnmessage.h>
 #include <dbus-cxx/utility.h>
 #include <memory>
 #include <mutex>
@@ -56,9 +60,33 @@ public:
 
     std::shared_ptr<CallMessage> create_call_message( ) const;
 
+    /**
+     * Set whether calls to this method should be sent with the NO_REPLY_EXPECTED
+     * flag.  When set, calling a method that returns void sends the call and
+     * returns straight away, without waiting to find out if it succeeded.
+     * Methods that return a value always wait for the reply.
+     */
+    void set_no_reply( bool no_reply = true );
+
+    bool no_reply() const;
+
     std::shared_ptr<const ReturnMessage> call( std::shared_ptr<const CallMessage>, int timeout_milliseconds = -1 ) const;
 
-    //      std::shared_ptr<PendingCall> call_async( std::shared_ptr<const CallMessage>, int timeout_milliseconds=-1 ) const;
+    /**
+     * Send the given CallMessage without waiting for the reply.
+     *
+     * @return The PendingCall that will receive the reply, or an invalid
+     * pointer if this method is not on an interface.
+     */
+    std::shared_ptr<PendingCall> call_async( std::shared_ptr<const CallMessage>, int timeout_milliseconds = -1 ) const;
+
+    /**
+     * Send the given CallMessage and wait for the reply, without throwing if
+     * the call fails.
+     *
+     * @return The ReturnMessage or ErrorMessage for the call
+     */
+    std::shared_ptr<Message> call_nothrow( std::shared_ptr<const CallMessage>, int timeout_milliseconds = -1 ) const;
 
 private:
     void set_interface( InterfaceProxy* proxy );
@@ -97,9 +125,43 @@ public:
 
         std::shared_ptr<CallMessage> _callmsg = this->create_call_message();
         ( *_callmsg << ... << args );
+
+        if( no_reply() ) {
+            _callmsg->set_no_reply( true );
+        }
+
         std::shared_ptr<const ReturnMessage> retmsg = this->call( _callmsg, -1 );
     }
 
+    /**
+     * Call the method without throwing if the call fails.
+     *
+     * @return An empty Result, or the Error that the call failed with
+     */
+    Result<void> try_call( T_arg... args ) {
+        std::shared_ptr<CallMessage> _callmsg = this->create_call_message();
+        ( *_callmsg << ... << args );
+
+        if( no_reply() ) {
+            _callmsg->set_no_reply( true );
+        }
+
+        std::shared_ptr<Message> reply = this->call_nothrow( _callmsg, -1 );
+
+        if( !reply ) {
+            if( no_reply() ) { return Result<void>(); }
+
+            return Result<void>( ErrorDisconnected() );
+        }
+
+        if( reply->type() == MessageType::ERROR ) {
+            std::shared_ptr<ErrorMessage> errmsg = std::static_pointer_cast<ErrorMessage>( reply );
+            return Result<void>( Error( errmsg->name(), errmsg->message() ) );
+        }
+
+        return Result<void>();
+    }
+
     std::future<void> call_async( T_arg... args ) {
         std::ostringstream debug_str;
         DBus::priv::dbus_function_traits<std::function<void( T_arg... )>> method_sig_gen;
@@ -110,7 +172,31 @@ public:
         debug_str << name();
         DBUSCXX_DEBUG_STDSTR( "DBus.MethodProxy", debug_str.str() );
 
-        return std::async( std::launch::async, *this, args... );
+        std::shared_ptr<CallMessage> _callmsg = this->create_call_message();
+        ( *_callmsg << ... << args );
+
+        std::shared_ptr<std::promise<void>> _promise = std::make_shared<std::promise<void>>();
+        std::future<void> _future = _promise->get_future();
+        std::shared_ptr<PendingCall> _pending = MethodProxyBase::call_async( _callmsg );
+
+        if( !_pending ) {
+            _promise->set_exception( std::make_exception_ptr( ErrorDisconnected() ) );
+            return _future;
+        }
+
+        _pending->set_notify( [_promise]( std::shared_ptr<Message> reply ) {
+            try {
+                if( reply->type() == MessageType::ERROR ) {
+                    std::static_pointer_cast<ErrorMessage>( reply )->throw_error();
+                }
+
+                _promise->set_value();
+            } catch( ... ) {
+                _promise->set_exception( std::current_exception() );
+            }
+        } );
+
+        return _future;
     }
 
     static std::shared_ptr<MethodProxy> create( const std::string& name ) {
@@ -150,6 +236,38 @@ public:
         return _retval;
     }
 
+    /**
+     * Call the method without throwing if the call fails.  The signature
+     * of the reply is checked before the return value is extracted.
+     *
+     * @return The return value, or the Error that the call failed with
+     */
+    Result<T_return> try_call( T_arg... args ) {
+        std::shared_ptr<CallMessage> _callmsg = this->create_call_message();
+        MessageAppendIterator iter = _callmsg->append();
+        ( void )( iter << ... << args );
+        std::shared_ptr<Message> reply = this->call_nothrow( _callmsg, -1 );
+
+        if( !reply ) {
+            return Result<T_return>( ErrorDisconnected() );
+        }
+
+        if( reply->type() == MessageType::ERROR ) {
+            std::shared_ptr<ErrorMessage> errmsg = std::static_pointer_cast<ErrorMessage>( reply );
+            return Result<T_return>( Error( errmsg->name(), errmsg->message() ) );
+        }
+
+        std::string expected = priv::return_signature<T_return>().dbus_sig();
+
+        if( !priv::signature_is_compatible( reply->signature(), expected ) ) {
+            return Result<T_return>( ErrorInvalidSignature( "Expected signature " + expected + ", got " + reply->signature().str() ) );
+        }
+
+        T_return _retval;
+        std::shared_ptr<const Message>( reply ) >> _retval;
+        return Result<T_return>( std::move( _retval ) );
+    }
+
     std::future<T_return> call_async( T_arg... args ) {
         std::ostringstream debug_str;
         DBus::priv::dbus_function_traits<std::function<void( T_arg... )>> method_sig_gen;
@@ -160,7 +278,34 @@ public:
         debug_str << name();
         DBUSCXX_DEBUG_STDSTR( "DBus.MethodProxy", debug_str.str() );
 
-        return std::async( std::launch::async, *this, args... );
+        std::shared_ptr<CallMessage> _callmsg = this->create_call_message();
+        MessageAppendIterator iter = _callmsg->append();
+        ( void )( iter << ... << args );
+
+        std::shared_ptr<std::promise<T_return>> _promise = std::make_shared<std::promise<T_return>>();
+        std::future<T_return> _future = _promise->get_future();
+        std::shared_ptr<PendingCall> _pending = MethodProxyBase::call_async( _callmsg );
+
+        if( !_pending ) {
+            _promise->set_exception( std::make_exception_ptr( ErrorDisconnected() ) );
+            return _future;
+        }
+
+        _pending->set_notify( [_promise]( std::shared_ptr<Message> reply ) {
+            try {
+                if( reply->type() == MessageType::ERROR ) {
+                    std::static_pointer_cast<ErrorMessage>( reply )->throw_error();
+                }
+
+                T_return _retval;
+                std::shared_ptr<const Message>( reply ) >> _retval;
+                _promise->set_value( _retval );
+            } catch( ... ) {
+                _promise->set_exception( std::current_exception() );
+            }
+        } );
+
+        return _future;
     }
 
     static std::shared_ptr<MethodProxy> create( const std::string& name ) {
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#ifndef DBUSCXX_MPSCQUEUE_H
+#define DBUSCXX_MPSCQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace DBus {
+
+namespace priv {
+
+/**
+ * Lock-free queue with any number of producers and a single consumer.
+ *
+ * Producers push onto the front of a singly linked list with a compare
+ * and swap.  The consumer takes the whole list in one exchange and puts it
+ * back into the order that it was pushed in, so items pushed by any one
+ * thread come out in the order that thread pushed them.
+ *
+ * Only one thread at a time may call take_all().
+ */
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : m_head( nullptr ) {}
+
+    ~MpscQueue() {
+        Node* node = m_head.load( std::memory_order_acquire );
+
+        while( node ) {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    MpscQueue( const MpscQueue& ) = delete;
+
+    MpscQueue& operator=( const MpscQueue& ) = delete;
+
+    void push( T value ) {
+        Node* node = new Node{ std::move( value ), nullptr };
+        Node* head = m_head.load( std::memory_order_relaxed );
+
+        do {
+            node->next = head;
+        } while( !m_head.compare_exchange_weak( head, node, std::memory_order_release, std::memory_order_relaxed ) );
+    }
+
+    /**
+     * Push several items at once.  The consumer sees either all of them,
+     * in order, or none of them.
+     */
+    void push_all( std::vector<T> values ) {
+        if( values.empty() ) { return; }
+
+        Node* last = nullptr;
+        Node* first = nullptr;
+
+        for( T& value : values ) {
+            last = new Node{ std::move( value ), last };
+
+            if( !first ) { first = last; }
+        }
+
+        Node* head = m_head.load( std::memory_order_relaxed );
+
+        do {
+            first->next = head;
+        } while( !m_head.compare_exchange_weak( head, last, std::memory_order_release, std::memory_order_relaxed ) );
+    }
+
+    /**
+     * Remove everything from the queue.
+     *
+     * @return The items, oldest first
+     */
+    std::vector<T> take_all() {
+        std::vector<T> items;
+        Node* node = m_head.exchange( nullptr, std::memory_order_acquire );
+
+        while( node ) {
+            Node* next = node->next;
+            items.push_back( std::move( node->value ) );
+            delete node;
+            node = next;
+        }
+
+        std::reverse( items.begin(), items.end() );
+        return items;
+    }
+
+    bool empty() const {
+        return m_head.load( std::memory_order_acquire ) == nullptr;
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> m_head;
+};
+
+} /* namespace priv */
+
+} /* namespace DBus */
+
+#endif /* DBUSCXX_MPSCQUEUE_H */
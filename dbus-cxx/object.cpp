@@ -6,6 +6,7 @@
  *   This file is part of the dbus-cxx library.                            *
  ***************************************************************************/
 #include "object.h"
+#include <atomic>
 #include <cstring>
 #include <sstream>
 #include <fstream>
@@ -15,7 +16,10 @@
 #include "dbus-cxx-private.h"
 #include "interface.h"
 #include "message.h"
+#include "messageappenditerator.h"
 #include "path.h"
+#include "returnmessage.h"
+#include "signalmessage.h"
 #include <sigc++/sigc++.h>
 #include "utility.h"
 
@@ -29,7 +33,9 @@ typedef std::map<std::shared_ptr<Interface>, sigc::connection> InterfaceSignalNa
 
 class Object::priv_data {
 public:
-    priv_data() {}
+    priv_data() :
+        m_introspection_generation( 0 ),
+        m_objectManager( false ) {}
 
     Children m_children;
     mutable std::shared_mutex m_interfaces_rwlock;
@@ -44,6 +50,11 @@ public:
     Path m_path;
     sigc::signal<void( std::shared_ptr<Connection> ) > m_signal_registered;
     sigc::signal<void( std::shared_ptr<Connection> ) > m_signal_unregistered;
+    /* The body of the reply to Introspect, and the introspection generation it was built at */
+    mutable std::mutex m_introspection_mutex;
+    mutable std::shared_ptr<ReturnMessage> m_introspection_reply;
+    mutable uint64_t m_introspection_generation;
+    std::atomic<bool> m_objectManager;
 };
 
 Object::Object( const std::string& path ):
@@ -84,6 +95,11 @@ sigc::signal< void( std::shared_ptr<Connection> )>& Object::signal_unregistered(
 
 void Object::set_connection( std::shared_ptr<Connection> conn ) {
     SIMPLELOGGER_DEBUG( LOGGER_NAME, "Object::set_connection" );
+
+    // Registering again on the same connection must not unregister the
+    // path that was just registered.
+    if( m_priv->m_connection.lock() == conn ) { return; }
+
     unregister();
     m_priv->m_connection = conn;
 
@@ -134,6 +150,7 @@ bool Object::add_interface( std::shared_ptr<Interface> interface_ptr ) {
 
             interface_ptr->set_path( path() );
             interface_ptr->set_connection( connection() );
+            priv::introspection_changed();
         } else {
             result = false;
         }
@@ -141,6 +158,8 @@ bool Object::add_interface( std::shared_ptr<Interface> interface_ptr ) {
 
     m_priv->m_signal_interface_added.emit( interface_ptr );
 
+    if( result ) { notify_object_manager( interface_ptr, true ); }
+
     SIMPLELOGGER_DEBUG( LOGGER_NAME, "Object::add_interface " << interface_ptr->name() << " successful: " << result );
 
     return result;
@@ -171,6 +190,7 @@ void Object::remove_interface( const std::string& name ) {
         if( iter != m_priv->m_interfaces.end() ) {
             interface_ptr = iter->second;
             m_priv->m_interfaces.erase( iter );
+            priv::introspection_changed();
         }
 
         if( interface_ptr ) {
@@ -183,7 +203,10 @@ void Object::remove_interface( const std::string& name ) {
         }
     }
 
-    if( interface_ptr ) { m_priv->m_signal_interface_removed.emit( interface_ptr ); }
+    if( interface_ptr ) {
+        m_priv->m_signal_interface_removed.emit( interface_ptr );
+        notify_object_manager( interface_ptr, false );
+    }
 }
 
 bool Object::has_interface( const std::string& name ) {
@@ -251,17 +274,45 @@ std::shared_ptr<Object> Object::child( const std::string& name ) const {
 bool Object::add_child( const std::string& name, std::shared_ptr<Object> child, bool force ) {
     if( !child ) { return false; }
 
-    if( !force && this->has_child( name ) ) { return false; }
+    Children::iterator existing = m_priv->m_children.find( name );
+
+    if( !force && existing != m_priv->m_children.end() ) { return false; }
 
     std::shared_ptr<Connection> conn = connection().lock();
 
-    if( conn ) {
-        m_priv->m_children[name] = child;
-        child->set_connection( conn );
-        return true;
+    if( !conn ) { return false; }
+
+    std::shared_ptr<Object> old;
+
+    if( existing != m_priv->m_children.end() ) { old = existing->second; }
+
+    if( old == child ) { return true; }
+
+    bool derived_path = child->path().empty();
+
+    if( derived_path ) {
+        child->m_priv->m_path = path() == "/" ? "/" + name : path() + "/" + name;
+    }
+
+    // The old child only has to be unregistered first if it is in the way;
+    // otherwise it is kept until the new child has been registered.
+    bool old_in_the_way = old && old->path() == child->path();
+
+    if( old_in_the_way ) { old->unregister(); }
+
+    if( conn->register_child_object( *this, child ) != RegistrationStatus::Success ) {
+        if( old_in_the_way ) { conn->register_child_object( *this, old ); }
+
+        if( derived_path ) { child->m_priv->m_path.clear(); }
+
+        return false;
     }
 
-    return false;
+    if( old && !old_in_the_way ) { old->unregister(); }
+
+    m_priv->m_children[name] = child;
+    priv::introspection_changed();
+    return true;
 }
 
 bool Object::remove_child( const std::string& name ) {
@@ -269,7 +320,9 @@ bool Object::remove_child( const std::string& name ) {
 
     if( i == m_priv->m_children.end() ) { return false; }
 
+    i->second->unregister();
     m_priv->m_children.erase( i );
+    priv::introspection_changed();
     return true;
 }
 
@@ -286,7 +339,40 @@ std::string Object::introspect( int space_depth ) const {
     for( int i = 0; i < space_depth; i++ ) { spaces += " "; }
 
     sout << spaces << "<node name=\"" << this->path() << "\">\n"
-        << spaces << "  <interface name=\"" << DBUS_CXX_INTROSPECTABLE_INTERFACE << "\">\n"
+        << introspect_standard_interfaces( spaces );
+
+    if( is_object_manager() ) {
+        sout << spaces << "  <interface name=\"" << DBUS_CXX_OBJECT_MANAGER_INTERFACE << "\">\n"
+            << spaces << "    <method name=\"GetManagedObjects\">\n"
+            << spaces << "      <arg type=\"a{oa{sa{sv}}}\" name=\"object_paths_interfaces_and_properties\" direction=\"out\"/>\n"
+            << spaces << "    </method>\n"
+            << spaces << "    <signal name=\"InterfacesAdded\">\n"
+            << spaces << "      <arg type=\"o\" name=\"object_path\"/>\n"
+            << spaces << "      <arg type=\"a{sa{sv}}\" name=\"interfaces_and_properties\"/>\n"
+            << spaces << "    </signal>\n"
+            << spaces << "    <signal name=\"InterfacesRemoved\">\n"
+            << spaces << "      <arg type=\"o\" name=\"object_path\"/>\n"
+            << spaces << "      <arg type=\"as\" name=\"interfaces\"/>\n"
+            << spaces << "    </signal>\n"
+            << spaces << "  </interface>\n";
+    }
+
+    for( i = m_priv->m_interfaces.begin(); i != m_priv->m_interfaces.end(); i++ ) {
+        sout << i->second->introspect( space_depth + 2 );
+    }
+
+    for( c = m_priv->m_children.begin(); c != m_priv->m_children.end(); c++ ) {
+        sout << spaces << "  <node name=\"" << c->first << "\"/>\n";
+    }
+
+    sout << spaces << "</node>\n";
+    return sout.str();
+}
+
+std::string Object::introspect_standard_interfaces( const std::string& spaces ) {
+    std::ostringstream sout;
+
+    sout << spaces << "  <interface name=\"" << DBUS_CXX_INTROSPECTABLE_INTERFACE << "\">\n"
         << spaces << "    <method name=\"Introspect\">\n"
         << spaces << "      <arg name=\"data\" type=\"s\" direction=\"out\"/>\n"
         << spaces << "    </method>\n"
@@ -319,16 +405,147 @@ std::string Object::introspect( int space_depth ) const {
         << spaces << "      </signal>\n"
         << spaces << "  </interface>\n";
 
-    for( i = m_priv->m_interfaces.begin(); i != m_priv->m_interfaces.end(); i++ ) {
-        sout << i->second->introspect( space_depth + 2 );
+    return sout.str();
+}
+
+std::shared_ptr<const ReturnMessage> Object::introspection_reply() const {
+    std::scoped_lock lock( m_priv->m_introspection_mutex );
+    uint64_t generation = priv::introspection_generation();
+
+    if( m_priv->m_introspection_reply && m_priv->m_introspection_generation == generation ) {
+        return m_priv->m_introspection_reply;
     }
 
-    for( c = m_priv->m_children.begin(); c != m_priv->m_children.end(); c++ ) {
-        sout << spaces << "  <node name=\"" << c->first << "\"/>\n";
+    SIMPLELOGGER_DEBUG( LOGGER_NAME, "Building introspection data for " << path() );
+
+    std::string introspection = DBUSCXX_INTROSPECT_1_0_XML_DOCTYPE_DECL_NODE;
+    introspection += this->introspect();
+
+    /* Replies are only ever copied from this, so it never needs a serial or destination */
+    m_priv->m_introspection_reply = ReturnMessage::create();
+    m_priv->m_introspection_reply << introspection;
+    m_priv->m_introspection_generation = generation;
+
+    return m_priv->m_introspection_reply;
+}
+
+void Object::set_object_manager( bool manager ) {
+    if( m_priv->m_objectManager.exchange( manager ) != manager ) {
+        priv::introspection_changed();
     }
+}
 
-    sout << spaces << "</node>\n";
-    return sout.str();
+bool Object::is_object_manager() const {
+    return m_priv->m_objectManager;
+}
+
+std::vector<std::shared_ptr<Interface>> Object::interface_list() const {
+    std::vector<std::shared_ptr<Interface>> interfaces;
+    std::shared_lock lock( m_priv->m_interfaces_rwlock );
+
+    interfaces.reserve( m_priv->m_interfaces.size() );
+
+    for( const Interfaces::value_type& entry : m_priv->m_interfaces ) {
+        interfaces.push_back( entry.second );
+    }
+
+    return interfaces;
+}
+
+void Object::append_interfaces( MessageAppendIterator& iter, const std::vector<std::shared_ptr<Interface>>& interfaces ) {
+    iter.open_container( ContainerType::ARRAY, "{sa{sv}}" );
+
+    for( const std::shared_ptr<Interface>& interface_ptr : interfaces ) {
+        iter.sub_iterator()->open_container( ContainerType::DICT_ENTRY, std::string() );
+        *( iter.sub_iterator()->sub_iterator() ) << interface_ptr->name();
+        interface_ptr->append_properties( *( iter.sub_iterator()->sub_iterator() ) );
+        iter.sub_iterator()->close_container();
+    }
+
+    iter.close_container();
+}
+
+void Object::send_interfaces_added( const Path& object_path, const std::vector<std::shared_ptr<Interface>>& interfaces ) {
+    std::shared_ptr<Connection> conn = connection().lock();
+
+    if( !conn || interfaces.empty() ) { return; }
+
+    std::shared_ptr<SignalMessage> signal = SignalMessage::create( path(),
+            DBUS_CXX_OBJECT_MANAGER_INTERFACE,
+            "InterfacesAdded" );
+    MessageAppendIterator iter = signal->append();
+
+    iter << object_path;
+    append_interfaces( iter, interfaces );
+
+    conn << signal;
+}
+
+void Object::send_interfaces_removed( const Path& object_path, const std::vector<std::shared_ptr<Interface>>& interfaces ) {
+    std::shared_ptr<Connection> conn = connection().lock();
+
+    if( !conn || interfaces.empty() ) { return; }
+
+    std::vector<std::string> names;
+
+    for( const std::shared_ptr<Interface>& interface_ptr : interfaces ) {
+        names.push_back( interface_ptr->name() );
+    }
+
+    std::shared_ptr<SignalMessage> signal = SignalMessage::create( path(),
+            DBUS_CXX_OBJECT_MANAGER_INTERFACE,
+            "InterfacesRemoved" );
+
+    signal << object_path << names;
+
+    conn << signal;
+}
+
+void Object::notify_object_manager( std::shared_ptr<Interface> interface_ptr, bool added ) {
+    std::shared_ptr<Connection> conn = connection().lock();
+
+    if( !conn ) { return; }
+
+    std::shared_ptr<Object> manager = conn->object_manager_for( path() );
+
+    if( !manager ) { return; }
+
+    /* Only objects that are registered themselves are managed; one that is
+     * just a child of another object is not */
+    if( !conn->is_registered_at_path( *this ) ) { return; }
+
+    if( added ) {
+        manager->send_interfaces_added( path(), { interface_ptr } );
+    } else {
+        manager->send_interfaces_removed( path(), { interface_ptr } );
+    }
+}
+
+HandlerResult Object::handle_object_manager_message( std::shared_ptr<Connection> conn, std::shared_ptr<const CallMessage> msg ) {
+    if( !is_object_manager() ) { return HandlerResult::Invalid_Interface; }
+
+    if( msg->member() != "GetManagedObjects" ) { return HandlerResult::Invalid_Method; }
+
+    std::shared_ptr<ReturnMessage> retmsg = msg->create_reply();
+
+    if( !retmsg ) { return HandlerResult::Handled; }
+
+    /* Everything is appended straight into the reply, one object at a time */
+    MessageAppendIterator iter = retmsg->append();
+
+    iter.open_container( ContainerType::ARRAY, "{oa{sa{sv}}}" );
+
+    for( const std::shared_ptr<Object>& object : conn->objects_below( path() ) ) {
+        iter.sub_iterator()->open_container( ContainerType::DICT_ENTRY, std::string() );
+        *( iter.sub_iterator()->sub_iterator() ) << object->path();
+        append_interfaces( *( iter.sub_iterator()->sub_iterator() ), object->interface_list() );
+        iter.sub_iterator()->close_container();
+    }
+
+    iter.close_container();
+
+    conn << retmsg;
+    return HandlerResult::Handled;
 }
 
 sigc::signal< void( std::shared_ptr<Interface> ) > Object::signal_interface_added() {
@@ -362,9 +579,14 @@ HandlerResult Object::handle_message( std::shared_ptr<const Message> message ) {
     if( msg->interface_name() == DBUS_CXX_INTROSPECTABLE_INTERFACE ) {
         SIMPLELOGGER_DEBUG( LOGGER_NAME, "Object::handle_call_message: introspection interface called" );
         std::shared_ptr<ReturnMessage> return_message = msg->create_reply();
-        std::string introspection = DBUSCXX_INTROSPECT_1_0_XML_DOCTYPE_DECL_NODE;
-        introspection += this->introspect();
-        *return_message << introspection;
+
+        if( return_message && !return_message->set_body_from( *introspection_reply() ) ) {
+            /* The cached body can't be copied into this reply, so build it again */
+            std::string introspection = DBUSCXX_INTROSPECT_1_0_XML_DOCTYPE_DECL_NODE;
+            introspection += this->introspect();
+            return_message << introspection;
+        }
+
         conn << return_message;
         return HandlerResult::Handled;
     } else if( msg->interface_name() == DBUS_CXX_PEER_INTERFACE ) {
@@ -413,6 +635,9 @@ HandlerResult Object::handle_message( std::shared_ptr<const Message> message ) {
             interface_ptr = iface_iter->second;
             return interface_ptr->handle_properties_message( conn, msg );
         }
+    } else if( msg->interface_name() == DBUS_CXX_OBJECT_MANAGER_INTERFACE ) {
+        SIMPLELOGGER_DEBUG( LOGGER_NAME, "Object::handle_call_message: object manager interface called" );
+        return handle_object_manager_message( conn, msg );
     }
 
     std::shared_lock lock( m_priv->m_interfaces_rwlock );
@@ -26,6 +26,8 @@ namespace DBus {
 class Connection;
 class Interface;
 class Message;
+class MessageAppendIterator;
+class ReturnMessage;
 template <typename T_type> class Method;
 
 /**
@@ -299,6 +301,11 @@ public:
      * Add an object as a child with a specified name
      * This method will fail if the object already has a child with the
      * specified name and \c force is not set.
+     *
+     * This object must be registered with a connection.  The child is
+     * registered with the same connection, and its methods are called from
+     * the same thread as this object's.  If the child has no path, its path
+     * becomes this object's path followed by the name.
      * @return \c True if the child was successfully added, \c false otherwise.
      * @param name The name to use for the child.
      * @param child A smart pointer to an object to add as a child.
@@ -307,7 +314,7 @@ public:
     bool add_child( const std::string& name, std::shared_ptr<Object> child, bool force = false );
 
     /**
-     * Remove the named child from this object
+     * Remove the named child from this object, and unregister it.
      * @return \c True if the child was found and removed, \c false if no child by the name was found to remove.
      * @param name The name of the child to remove.
      */
@@ -323,6 +330,20 @@ public:
     /** Returns a DBus XML description of this interface */
     std::string introspect( int space_depth = 0 ) const;
 
+    /**
+     * Make this object an org.freedesktop.DBus.ObjectManager for the
+     * objects registered below it on the same connection.
+     *
+     * GetManagedObjects then returns the interfaces and properties of all
+     * of those objects in one reply, and InterfacesAdded and
+     * InterfacesRemoved are sent from this object when objects below it
+     * are registered or unregistered, or interfaces are added to or
+     * removed from them.
+     */
+    void set_object_manager( bool manager );
+
+    bool is_object_manager() const;
+
     /**
      * Signal emitted when an interface is added to this object.
      *
@@ -367,12 +388,57 @@ public:
      * @param conn The Connection to send the reply message on
      * @param msg The message to handle; must be a CallMessage or it will not be handled
      */
-    HandlerResult handle_message( std::shared_ptr<const Message> msg );
+    virtual HandlerResult handle_message( std::shared_ptr<const Message> msg );
+
+protected:
+    /**
+     * The introspection XML of the standard interfaces that every object has.
+     *
+     * @param spaces The indent to put before each line
+     */
+    static std::string introspect_standard_interfaces( const std::string& spaces );
+
+    /**
+     * A reply to Introspect that holds the introspection data of this object.
+     * It is built the first time it is needed and kept until something that
+     * shows up in the introspection data changes, so that repeated calls to
+     * Introspect only copy the marshaled data.
+     */
+    std::shared_ptr<const ReturnMessage> introspection_reply() const;
+
+private:
+    /**
+     * A copy of the interfaces of this object, taken with the interfaces locked.
+     */
+    std::vector<std::shared_ptr<Interface>> interface_list() const;
+
+    HandlerResult handle_object_manager_message( std::shared_ptr<Connection> conn, std::shared_ptr<const CallMessage> msg );
+
+    /**
+     * Append the given interfaces and their properties as an a{sa{sv}}.
+     */
+    static void append_interfaces( MessageAppendIterator& iter, const std::vector<std::shared_ptr<Interface>>& interfaces );
+
+    /**
+     * Send InterfacesAdded or InterfacesRemoved from this object manager
+     * for the object at the given path.
+     */
+    void send_interfaces_added( const Path& object_path, const std::vector<std::shared_ptr<Interface>>& interfaces );
+
+    void send_interfaces_removed( const Path& object_path, const std::vector<std::shared_ptr<Interface>>& interfaces );
+
+    /**
+     * Tell the object manager above this object, if there is one, that the
+     * interface was added or removed.
+     */
+    void notify_object_manager( std::shared_ptr<Interface> interface_ptr, bool added );
 
 private:
     class priv_data;
 
     DBUS_CXX_PROPAGATE_CONST( std::unique_ptr<priv_data> ) m_priv;
+
+    friend class Connection;
 };
 
 }
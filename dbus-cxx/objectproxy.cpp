@@ -9,6 +9,8 @@
 #include <utility>
 #include "callmessage.h"
 #include "connection.h"
+#include "dbus-error.h"
+#include "errormessage.h"
 #include "interfaceproxy.h"
 #include <sigc++/sigc++.h>
 #include "standard-interfaces/peerinterfaceproxy.h"
@@ -39,6 +41,7 @@ public:
     Interfaces m_interfaces;
     sigc::signal<void( std::shared_ptr<InterfaceProxy> )> m_signal_interface_added;
     sigc::signal<void( std::shared_ptr<InterfaceProxy> )> m_signal_interface_removed;
+    sigc::signal<void( std::string, std::string )> m_signal_owner_changed;
     std::shared_ptr<PeerInterfaceProxy> m_peerInterface;
     std::shared_ptr<IntrospectableInterfaceProxy> m_introspectableInterface;
     std::shared_ptr<PropertiesInterfaceProxy> m_propertiesInterface;
@@ -263,6 +266,33 @@ std::shared_ptr<const ReturnMessage> ObjectProxy::call( std::shared_ptr<const Ca
     return conn->send_with_reply_blocking( call_message, timeout_milliseconds );
 }
 
+std::shared_ptr<PendingCall> ObjectProxy::call_async( std::shared_ptr<const CallMessage> call_message, int timeout_milliseconds ) const {
+    std::shared_ptr<Connection> conn = m_priv->m_connection.lock();
+
+    if( !conn ) { return std::shared_ptr<PendingCall>(); }
+
+    return conn->send_with_reply_async( call_message, timeout_milliseconds );
+}
+
+std::shared_ptr<Message> ObjectProxy::call_nothrow( std::shared_ptr<const CallMessage> call_message, int timeout_milliseconds ) const {
+    std::shared_ptr<Connection> conn = m_priv->m_connection.lock();
+
+    if( !conn ) {
+        return ErrorMessage::create( call_message, DBUSCXX_ERROR_DISCONNECTED, "No connection" );
+    }
+
+    return conn->send_with_reply_nothrow( call_message, timeout_milliseconds );
+}
+
+std::vector<std::shared_ptr<Message>> ObjectProxy::call_batch( const std::vector<std::shared_ptr<const CallMessage>>& call_messages,
+                                                               int timeout_milliseconds ) const {
+    std::shared_ptr<Connection> conn = m_priv->m_connection.lock();
+
+    if( !conn ) { return std::vector<std::shared_ptr<Message>>(); }
+
+    return conn->send_with_reply_batch( call_messages, timeout_milliseconds );
+}
+
 sigc::signal< void( std::shared_ptr<InterfaceProxy> )> ObjectProxy::signal_interface_added() {
     return m_priv->m_signal_interface_added;
 }
@@ -283,5 +313,21 @@ std::shared_ptr<PropertiesInterfaceProxy> ObjectProxy::getPropertiesInterface(){
     return m_priv->m_propertiesInterface;
 }
 
+sigc::signal<void( std::string, std::string )> ObjectProxy::signal_owner_changed(){
+    return m_priv->m_signal_owner_changed;
+}
+
+void ObjectProxy::destination_owner_changed( const std::string& old_owner, const std::string& new_owner ){
+    {
+        std::shared_lock lock( m_priv->m_interfaces_rwlock );
+
+        for( Interfaces::value_type& iface : m_priv->m_interfaces ){
+            iface.second->invalidate_properties();
+        }
+    }
+
+    m_priv->m_signal_owner_changed.emit( old_owner, new_owner );
+}
+
 }
 
@@ -14,6 +14,7 @@
 #include <mutex>
 #include <shared_mutex>
 #include <string>
+#include <vector>
 #include "path.h"
 #include <sigc++/sigc++.h>
 
@@ -125,6 +126,36 @@ public:
      */
     std::shared_ptr<const ReturnMessage> call( std::shared_ptr<const CallMessage>, int timeout_milliseconds = -1 ) const;
 
+    /**
+     * Forwards this CallMessage to the Connection that this ObjectProxy is on without
+     * waiting for the response.
+     *
+     * @return The PendingCall that will receive the reply, or an invalid pointer if
+     * there is no connection.
+     */
+    std::shared_ptr<PendingCall> call_async( std::shared_ptr<const CallMessage>, int timeout_milliseconds = -1 ) const;
+
+    /**
+     * Forwards this CallMessage to the Connection that this ObjectProxy is on and
+     * waits for the reply, without throwing if the call fails.
+     *
+     * @return The ReturnMessage or ErrorMessage for the call
+     * @see Connection::send_with_reply_nothrow
+     */
+    std::shared_ptr<Message> call_nothrow( std::shared_ptr<const CallMessage>, int timeout_milliseconds = -1 ) const;
+
+    /**
+     * Forwards these CallMessages to the Connection that this ObjectProxy is on,
+     * all at once, and waits for all of the replies.  The messages do not have to
+     * be for this object.
+     *
+     * @return One ReturnMessage or ErrorMessage for each message, in the same
+     * order, or an empty vector if there is no connection.
+     * @see Connection::send_with_reply_batch
+     */
+    std::vector<std::shared_ptr<Message>> call_batch( const std::vector<std::shared_ptr<const CallMessage>>& call_messages,
+                                                      int timeout_milliseconds = -1 ) const;
+
     /**
      * Creates a proxy method with a signature based on the template parameters and adds it to the named interface
      * @return A smart pointer to the newly created method proxy
@@ -192,10 +223,30 @@ public:
 
     std::shared_ptr<PropertiesInterfaceProxy> getPropertiesInterface();
 
+    /**
+     * Return a signal that is emitted when the owner of the destination of
+     * this object changes, with the old and the new unique name.  Either
+     * may be empty, if the destination had no owner before or has none now.
+     *
+     * When the owner changes, the cached values of all properties are
+     * dropped before this is emitted, as they belonged to the old owner.
+     * This is emitted from the thread that this object proxy is called
+     * from; a thread other than the dispatcher thread needs a
+     * ThreadDispatcher for it.
+     *
+     * @return
+     */
+    sigc::signal<void( std::string, std::string )> signal_owner_changed();
+
+private:
+    void destination_owner_changed( const std::string& old_owner, const std::string& new_owner );
+
 private:
     class priv_data;
 
     DBUS_CXX_PROPAGATE_CONST( std::unique_ptr<priv_data> ) m_priv;
+
+    friend class Connection;
 };
 
 }
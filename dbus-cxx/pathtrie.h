@@ -0,0 +1,513 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#ifndef DBUSCXX_PATHTRIE_H
+#define DBUSCXX_PATHTRIE_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace DBus {
+
+namespace priv {
+
+/**
+ * Maps object paths to handlers, one path element per level of the trie.
+ *
+ * Each path can have an exact handler, which handles only that path, and a
+ * fallback handler, which handles that path and every path below it that
+ * has no handler of its own.  A lookup walks down the trie once, so it takes
+ * time proportional to the depth of the path.
+ *
+ * The trie is changed in place, one pointer at a time, so lookups take no
+ * lock.  The children of a node are kept in a hash table whose chains are
+ * only ever added to at the front or unlinked, and the handlers of a node
+ * are replaced as a whole.  A lookup therefore sees each node either before
+ * or after a change, and adding a child never copies its siblings.
+ *
+ * Whatever a change takes out of the trie is freed once every lookup that
+ * could still be using it has finished.  Lookups count themselves in one of
+ * two counters, chosen by the current epoch.  Each change moves the epoch on
+ * when nobody is left counted from the epoch before, and frees what was
+ * taken out two epochs ago.  New lookups always go to the other counter, so
+ * the old one drains even while lookups never stop; if too much is waiting
+ * to be freed, a change waits for it to drain.
+ *
+ * find() may be called from any thread at any time.  Only one thread at a
+ * time may call the other methods.
+ */
+template <typename T>
+class PathTrie {
+private:
+    struct Node;
+
+    struct Handlers {
+        std::optional<T> exact;
+        std::optional<T> fallback;
+    };
+
+    struct Entry {
+        explicit Entry( Node* entry_node ) :
+            node( entry_node ),
+            next( nullptr ) {}
+
+        Node* const node;
+        std::atomic<Entry*> next;
+    };
+
+    /* A hash table of the children of one node; it owns its entries */
+    struct Table {
+        explicit Table( size_t bucket_count ) :
+            buckets( new std::atomic<Entry*>[ bucket_count ] ),
+            size( bucket_count ) {
+            for( size_t x = 0; x < size; x++ ) {
+                buckets[ x ].store( nullptr, std::memory_order_relaxed );
+            }
+        }
+
+        ~Table() {
+            for( size_t x = 0; x < size; x++ ) {
+                Entry* entry = buckets[ x ].load( std::memory_order_relaxed );
+
+                while( entry ) {
+                    Entry* next = entry->next.load( std::memory_order_relaxed );
+                    delete entry;
+                    entry = next;
+                }
+            }
+        }
+
+        std::atomic<Entry*>& bucket( std::string_view name ) const {
+            return buckets[ std::hash<std::string_view>()( name ) % size ];
+        }
+
+        std::unique_ptr<std::atomic<Entry*>[]> buckets;
+        const size_t size;
+    };
+
+    /* A node owns its handlers and its table, but not the nodes in the table */
+    struct Node {
+        explicit Node( const std::string& node_name ) :
+            name( node_name ),
+            handlers( nullptr ),
+            children( nullptr ),
+            child_count( 0 ) {}
+
+        ~Node() {
+            delete handlers.load( std::memory_order_relaxed );
+            delete children.load( std::memory_order_relaxed );
+        }
+
+        const std::string name;
+        std::atomic<const Handlers*> handlers;
+        std::atomic<Table*> children;
+        /* Only used by the thread changing the trie */
+        size_t child_count;
+    };
+
+    /* Counts a lookup for as long as it is alive */
+    class ReadGuard {
+    public:
+        explicit ReadGuard( const PathTrie& trie ) {
+            for( ;; ) {
+                uint64_t epoch = trie.m_epoch.load( std::memory_order_seq_cst );
+
+                m_readers = &trie.m_readers[ epoch & 1 ];
+                m_readers->fetch_add( 1, std::memory_order_seq_cst );
+
+                /* If the epoch moved on in between, the counter may already
+                 * have been checked, so count in the new one instead */
+                if( trie.m_epoch.load( std::memory_order_seq_cst ) == epoch ) { return; }
+
+                m_readers->fetch_sub( 1, std::memory_order_seq_cst );
+            }
+        }
+
+        ~ReadGuard() {
+            m_readers->fetch_sub( 1, std::memory_order_seq_cst );
+        }
+
+    private:
+        std::atomic<uint32_t>* m_readers;
+    };
+
+public:
+    PathTrie() :
+        m_root( std::string() ),
+        m_epoch( 0 ),
+        m_readers{ { 0 }, { 0 } } {}
+
+    PathTrie( const PathTrie& ) = delete;
+
+    PathTrie& operator=( const PathTrie& ) = delete;
+
+    ~PathTrie() {
+        destroy_children( m_root );
+    }
+
+    /**
+     * Find the handler for the given path: the exact handler for the path if
+     * there is one, otherwise the fallback handler that is closest to it.
+     */
+    std::optional<T> find( const std::string& path ) const {
+        ReadGuard guard( *this );
+        const Node* node = &m_root;
+        const Handlers* handlers = node->handlers.load( std::memory_order_acquire );
+        const std::optional<T>* found = handlers ? &handlers->fallback : nullptr;
+        std::string_view remaining( path );
+        size_t start = 1;
+
+        while( start < remaining.size() ) {
+            size_t end = remaining.find( '/', start );
+
+            if( end == std::string_view::npos ) { end = remaining.size(); }
+
+            node = child( *node, remaining.substr( start, end - start ) );
+            start = end + 1;
+
+            if( !node ) { break; }
+
+            handlers = node->handlers.load( std::memory_order_acquire );
+
+            if( handlers && handlers->fallback ) { found = &handlers->fallback; }
+        }
+
+        if( node && handlers && handlers->exact ) { found = &handlers->exact; }
+
+        if( !found ) { return std::optional<T>(); }
+
+        return *found;
+    }
+
+    /**
+     * @return The handler registered at exactly this path, if there is one
+     */
+    std::optional<T> get( const std::string& path, bool fallback ) const {
+        const Node* node = lookup( path );
+
+        if( !node ) { return std::optional<T>(); }
+
+        const Handlers* handlers = node->handlers.load( std::memory_order_relaxed );
+
+        if( !handlers ) { return std::optional<T>(); }
+
+        return fallback ? handlers->fallback : handlers->exact;
+    }
+
+    /**
+     * Call the function with every exact handler for a path below the given
+     * path, not including the path itself.  Like get(), this may only be
+     * called from the thread that changes the trie.
+     */
+    void for_each_below( const std::string& path, const std::function<void( const T& )>& func ) const {
+        const Node* node = lookup( path );
+
+        if( !node ) { return; }
+
+        for( Node* below : children_of( *node ) ) {
+            visit( *below, func );
+        }
+    }
+
+    /**
+     * Set the handler for the given path, replacing any handler that is
+     * already there.
+     */
+    void set( const std::string& path, const T& value, bool fallback ) {
+        Node* node = &m_root;
+
+        for( const std::string& element : split( path ) ) {
+            Node* next = child( *node, element );
+
+            if( !next ) { next = add_child( *node, element ); }
+
+            node = next;
+        }
+
+        const Handlers* old = node->handlers.load( std::memory_order_relaxed );
+        Handlers* handlers = old ? new Handlers( *old ) : new Handlers();
+
+        if( fallback ) {
+            handlers->fallback = value;
+        } else {
+            handlers->exact = value;
+        }
+
+        replace_handlers( *node, handlers );
+        reclaim();
+    }
+
+    /**
+     * Remove the handler for the given path.
+     *
+     * @return false if there was no handler to remove
+     */
+    bool remove( const std::string& path, bool fallback ) {
+        std::vector<Node*> nodes( 1, &m_root );
+
+        for( const std::string& element : split( path ) ) {
+            Node* next = child( *nodes.back(), element );
+
+            if( !next ) { return false; }
+
+            nodes.push_back( next );
+        }
+
+        Node* node = nodes.back();
+        const Handlers* old = node->handlers.load( std::memory_order_relaxed );
+
+        if( !old || !( fallback ? old->fallback : old->exact ) ) { return false; }
+
+        Handlers* handlers = new Handlers( *old );
+
+        if( fallback ) {
+            handlers->fallback.reset();
+        } else {
+            handlers->exact.reset();
+        }
+
+        replace_handlers( *node, handlers );
+
+        /* Drop the nodes that are now empty, from the bottom up */
+        for( size_t depth = nodes.size() - 1; depth > 0 && is_empty( *nodes[ depth ] ); depth-- ) {
+            remove_child( *nodes[ depth - 1 ], nodes[ depth ] );
+        }
+
+        reclaim();
+
+        return true;
+    }
+
+    /**
+     * Remove every handler that the predicate returns true for.
+     */
+    void remove_if( std::function<bool( const T& )> predicate ) {
+        filter( m_root, predicate );
+        reclaim();
+    }
+
+private:
+    static std::vector<std::string> split( const std::string& path ) {
+        std::vector<std::string> elements;
+        size_t start = 1;
+
+        while( start < path.size() ) {
+            size_t end = path.find( '/', start );
+
+            if( end == std::string::npos ) { end = path.size(); }
+
+            elements.push_back( path.substr( start, end - start ) );
+            start = end + 1;
+        }
+
+        return elements;
+    }
+
+    static Node* child( const Node& node, std::string_view name ) {
+        const Table* table = node.children.load( std::memory_order_acquire );
+
+        if( !table ) { return nullptr; }
+
+        for( const Entry* entry = table->bucket( name ).load( std::memory_order_acquire );
+            entry;
+            entry = entry->next.load( std::memory_order_acquire ) ) {
+            if( entry->node->name == name ) { return entry->node; }
+        }
+
+        return nullptr;
+    }
+
+    static std::vector<Node*> children_of( const Node& node ) {
+        std::vector<Node*> nodes;
+        const Table* table = node.children.load( std::memory_order_relaxed );
+
+        if( !table ) { return nodes; }
+
+        for( size_t x = 0; x < table->size; x++ ) {
+            for( const Entry* entry = table->buckets[ x ].load( std::memory_order_relaxed );
+                entry;
+                entry = entry->next.load( std::memory_order_relaxed ) ) {
+                nodes.push_back( entry->node );
+            }
+        }
+
+        return nodes;
+    }
+
+    static void visit( const Node& node, const std::function<void( const T& )>& func ) {
+        const Handlers* handlers = node.handlers.load( std::memory_order_relaxed );
+
+        if( handlers && handlers->exact ) { func( *handlers->exact ); }
+
+        for( Node* below : children_of( node ) ) {
+            visit( *below, func );
+        }
+    }
+
+    static bool is_empty( const Node& node ) {
+        return node.child_count == 0 && !node.handlers.load( std::memory_order_relaxed );
+    }
+
+    static void destroy_children( Node& node ) {
+        for( Node* below : children_of( node ) ) {
+            destroy_children( *below );
+            delete below;
+        }
+    }
+
+    const Node* lookup( const std::string& path ) const {
+        const Node* node = &m_root;
+
+        for( const std::string& element : split( path ) ) {
+            node = child( *node, element );
+
+            if( !node ) { return nullptr; }
+        }
+
+        return node;
+    }
+
+    Node* add_child( Node& node, const std::string& name ) {
+        Table* table = node.children.load( std::memory_order_relaxed );
+
+        if( !table ) {
+            table = new Table( 8 );
+            node.children.store( table, std::memory_order_release );
+        } else if( node.child_count >= table->size ) {
+            /* Copying the entries into a table twice the size keeps adding
+             * a child constant time on average */
+            Table* bigger = new Table( table->size * 2 );
+
+            for( Node* below : children_of( node ) ) {
+                link( *bigger, below );
+            }
+
+            node.children.store( bigger, std::memory_order_release );
+            retire( table );
+            table = bigger;
+        }
+
+        Node* added = new Node( name );
+        link( *table, added );
+        node.child_count++;
+
+        return added;
+    }
+
+    void remove_child( Node& node, Node* removed ) {
+        Table* table = node.children.load( std::memory_order_relaxed );
+        std::atomic<Entry*>* previous = &table->bucket( removed->name );
+        Entry* entry = previous->load( std::memory_order_relaxed );
+
+        while( entry->node != removed ) {
+            previous = &entry->next;
+            entry = entry->next.load( std::memory_order_relaxed );
+        }
+
+        /* A lookup that is on the entry still gets to the rest of the chain */
+        previous->store( entry->next.load( std::memory_order_relaxed ), std::memory_order_release );
+        node.child_count--;
+
+        retire( entry );
+        retire( removed );
+    }
+
+    static void link( Table& table, Node* node ) {
+        std::atomic<Entry*>& bucket = table.bucket( node->name );
+        Entry* entry = new Entry( node );
+
+        entry->next.store( bucket.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+        bucket.store( entry, std::memory_order_release );
+    }
+
+    void replace_handlers( Node& node, Handlers* handlers ) {
+        if( handlers && !handlers->exact && !handlers->fallback ) {
+            delete handlers;
+            handlers = nullptr;
+        }
+
+        const Handlers* old = node.handlers.exchange( handlers, std::memory_order_acq_rel );
+
+        if( old ) { retire( old ); }
+    }
+
+    /* Returns true if the node ended up empty */
+    bool filter( Node& node, const std::function<bool( const T& )>& predicate ) {
+        const Handlers* old = node.handlers.load( std::memory_order_relaxed );
+
+        if( old &&
+            ( ( old->exact && predicate( *old->exact ) ) ||
+              ( old->fallback && predicate( *old->fallback ) ) ) ) {
+            Handlers* handlers = new Handlers( *old );
+
+            if( handlers->exact && predicate( *handlers->exact ) ) { handlers->exact.reset(); }
+
+            if( handlers->fallback && predicate( *handlers->fallback ) ) { handlers->fallback.reset(); }
+
+            replace_handlers( node, handlers );
+        }
+
+        for( Node* below : children_of( node ) ) {
+            if( filter( *below, predicate ) ) {
+                remove_child( node, below );
+            }
+        }
+
+        return is_empty( node );
+    }
+
+    template <typename R>
+    void retire( R* retired ) {
+        m_retired[ m_epoch.load( std::memory_order_relaxed ) & 1 ].push_back( std::shared_ptr<const void>( retired ) );
+    }
+
+    void reclaim() {
+        /* Twice, so that what this change took out is freed right away when
+         * no lookup is running */
+        for( int x = 0; x < 2; x++ ) {
+            uint64_t epoch = m_epoch.load( std::memory_order_seq_cst );
+            size_t previous = ( epoch + 1 ) & 1;
+
+            if( m_readers[ previous ].load( std::memory_order_seq_cst ) != 0 ) {
+                if( m_retired[ 0 ].size() + m_retired[ 1 ].size() < MAX_RETIRED ) { return; }
+
+                /* Too much has piled up, so wait for the lookups from the
+                 * epoch before to finish; new ones can't join them */
+                while( m_readers[ previous ].load( std::memory_order_seq_cst ) != 0 ) {
+                    std::this_thread::yield();
+                }
+            }
+
+            m_retired[ previous ].clear();
+            m_epoch.store( epoch + 1, std::memory_order_seq_cst );
+        }
+    }
+
+private:
+    /* How much may be waiting to be freed before a change waits for lookups */
+    static constexpr size_t MAX_RETIRED = 1024;
+
+    Node m_root;
+    /* Only moved on by the thread changing the trie */
+    std::atomic<uint64_t> m_epoch;
+    /* Lookups running right now, by the epoch they started in */
+    mutable std::atomic<uint32_t> m_readers[ 2 ];
+    /* What was taken out of the trie, by the epoch it was taken out in */
+    std::vector<std::shared_ptr<const void>> m_retired[ 2 ];
+};
+
+} /* namespace priv */
+
+} /* namespace DBus */
+
+#endif /* DBUSCXX_PATHTRIE_H */
@@ -8,55 +8,120 @@
 #include "pendingcall.h"
 #include "error.h"
 #include "message.h"
+#include <condition_variable>
+#include <mutex>
 #include <sigc++/sigc++.h>
 
 namespace DBus {
 
+class PendingCall::priv_data {
+public:
+    priv_data( uint32_t serial ) :
+        m_serial( serial ),
+        m_canceled( false ),
+        m_has_notify( false ) {}
 
-//  PendingCall::PendingCall() :
-//      m_canceled( false )
-//  {
-//  }
-
-//  std::shared_ptr<PendingCall> PendingCall::create()
-//  {
-//    return std::shared_ptr<PendingCall>( new PendingCall() );
-//  }
-
-//  PendingCall::~PendingCall()
-//  {
-//  }
-
-//  void PendingCall::cancel()
-//  {
-//      m_canceled = true;
-//  }
-
-//  bool PendingCall::completed() const
-//  {
-//    return m_reply->is_valid();
-//  }
-
-//  std::shared_ptr<Message> PendingCall::reply() const
-//  {
-//    return m_reply;
-//  }
-
-//  void PendingCall::block() const
-//  {
-//      if( m_canceled ){
-//          return;
-//      }
-//  }
-
-//  sigc::signal<void()> PendingCall::signal_notify() const
-//  {
-//    return m_signal_notify;
-//  }
-
-//  void PendingCall::set_reply( std::shared_ptr<Message> msg ){
-//      m_reply = msg;
-//      m_signal_notify.emit();
-//  }
+    const uint32_t m_serial;
+    mutable std::mutex m_lock;
+    mutable std::condition_variable m_cv;
+    std::shared_ptr<Message> m_reply;
+    bool m_canceled;
+    bool m_has_notify;
+    sigc::slot<void( std::shared_ptr<Message> )> m_notify;
+};
+
+PendingCall::PendingCall( uint32_t serial ) :
+    m_priv( std::make_unique<priv_data>( serial ) ) {
+}
+
+std::shared_ptr<PendingCall> PendingCall::create( uint32_t serial ) {
+    return std::shared_ptr<PendingCall>( new PendingCall( serial ) );
+}
+
+PendingCall::~PendingCall() {
+}
+
+uint32_t PendingCall::serial() const {
+    return m_priv->m_serial;
+}
+
+void PendingCall::cancel() {
+    std::unique_lock<std::mutex> lock( m_priv->m_lock );
+    m_priv->m_canceled = true;
+    m_priv->m_has_notify = false;
+    m_priv->m_cv.notify_all();
+}
+
+bool PendingCall::is_canceled() const {
+    std::unique_lock<std::mutex> lock( m_priv->m_lock );
+    return m_priv->m_canceled;
+}
+
+bool PendingCall::completed() const {
+    std::unique_lock<std::mutex> lock( m_priv->m_lock );
+    return m_priv->m_reply != nullptr;
+}
+
+std::shared_ptr<Message> PendingCall::reply() const {
+    std::unique_lock<std::mutex> lock( m_priv->m_lock );
+
+    if( m_priv->m_canceled ) { return std::shared_ptr<Message>(); }
+
+    return m_priv->m_reply;
+}
+
+void PendingCall::block() const {
+    std::unique_lock<std::mutex> lock( m_priv->m_lock );
+    m_priv->m_cv.wait( lock, [this] {
+        return m_priv->m_canceled || m_priv->m_reply;
+    } );
+}
+
+bool PendingCall::block_until( std::chrono::steady_clock::time_point deadline ) const {
+    std::unique_lock<std::mutex> lock( m_priv->m_lock );
+    return m_priv->m_cv.wait_until( lock, deadline, [this] {
+        return m_priv->m_canceled || m_priv->m_reply;
+    } );
+}
+
+void PendingCall::set_notify( sigc::slot<void( std::shared_ptr<Message> )> slot ) {
+    std::shared_ptr<Message> reply;
+
+    {
+        std::unique_lock<std::mutex> lock( m_priv->m_lock );
+
+        if( m_priv->m_canceled ) { return; }
+
+        if( !m_priv->m_reply ) {
+            m_priv->m_notify = slot;
+            m_priv->m_has_notify = true;
+            return;
+        }
+
+        reply = m_priv->m_reply;
+    }
+
+    slot( reply );
+}
+
+void PendingCall::set_reply( std::shared_ptr<Message> msg ) {
+    sigc::slot<void( std::shared_ptr<Message> )> notify;
+    bool has_notify;
+
+    {
+        std::unique_lock<std::mutex> lock( m_priv->m_lock );
+
+        if( m_priv->m_canceled || m_priv->m_reply ) { return; }
+
+        m_priv->m_reply = msg;
+        has_notify = m_priv->m_has_notify;
+        notify = m_priv->m_notify;
+        m_priv->m_cv.notify_all();
+    }
+
+    if( has_notify ) {
+        notify( msg );
+    }
+}
 
 }
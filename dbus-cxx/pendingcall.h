@@ -5,74 +5,97 @@
  *                                                                         *
  *   This file is part of the dbus-cxx library.                            *
  ***************************************************************************/
+#include <dbus-cxx/dbus-cxx-config.h>
 #include <sigc++/sigc++.h>
+#include <chrono>
 #include <memory>
+#include <stdint.h>
 
 #ifndef DBUSCXX_PENDING_CALL_H
 #define DBUSCXX_PENDING_CALL_H
 
 namespace DBus {
+class Connection;
 class Message;
 
 /**
- * Monitors an asynchronous call, emitting a signal when a response is received
+ * Monitors an asynchronous call, calling a slot when a response is received.
+ *
+ * A PendingCall is returned from Connection::send_with_reply_async().  The
+ * reply is delivered on the dispatching thread of the connection, so no
+ * thread is used for the call while it is outstanding.
  *
  * @ingroup message
  *
  * @author Rick L Vinyard Jr <rvinyard@cs.nmsu.edu>
  */
-//  class PendingCall: public sigc::trackable
-//  {
-//    protected:
-
-//      PendingCall( );
-
-//    public:
-//      static std::shared_ptr<PendingCall> create( );
-
-//      virtual ~PendingCall();
-
-//      /**
-//       * Cancel the pending call; that is, signal_notify() will not
-//       * be emitted if and when the reply eventually comes back.
-//       */
-//      void cancel();
-
-//      /**
-//       * Check to see if the reply has actually come back.
-//       */
-//      bool completed() const;
-
-//      /**
-//       * Check to see if the
-//       * @return
-//       */
-////      bool is_timeout() const;
-
-//      /**
-//       * Get the reply that this pending call represents.  If
-//       * completed() is not true, or this call has been canceled,
-//       * returns an invalid pointer.
-//       *
-//       * @return
-//       */
-//      std::shared_ptr<Message> reply() const;
-
-//      void block() const;
-
-//      sigc::signal<void()> signal_notify() const;
-
-//      void set_reply( std::shared_ptr<Message> msg );
-
-//    private:
-
-//      sigc::signal<void()> m_signal_notify;
-
-//      std::shared_ptr<Message> m_reply;
-
-//      bool m_canceled;
-
-//  };
+class PendingCall {
+private:
+    PendingCall( uint32_t serial );
+
+public:
+    ~PendingCall();
+
+    /**
+     * The serial of the CallMessage that this is waiting for a reply to.
+     */
+    uint32_t serial() const;
+
+    /**
+     * Cancel the pending call; that is, the notify slot will not
+     * be called if and when the reply eventually comes back.
+     */
+    void cancel();
+
+    bool is_canceled() const;
+
+    /**
+     * Check to see if the reply has actually come back.
+     */
+    bool completed() const;
+
+    /**
+     * Get the reply that this pending call represents: either a ReturnMessage
+     * or an ErrorMessage.  If completed() is not true, or this call has been
+     * canceled, returns an invalid pointer.
+     */
+    std::shared_ptr<Message> reply() const;
+
+    /**
+     * Wait until the reply has come back or the call has been canceled.
+     *
+     * This must not be called from the dispatching thread, as that is the
+     * thread that will receive the reply.
+     */
+    void block() const;
+
+    /**
+     * Wait until the reply has come back, the call has been canceled, or
+     * the deadline has passed.  Like block(), this must not be called from
+     * the dispatching thread.
+     *
+     * @return false if the deadline passed first
+     */
+    bool block_until( std::chrono::steady_clock::time_point deadline ) const;
+
+    /**
+     * Set the slot that is called with the reply once it comes back.  The
+     * slot is called from the dispatching thread; if the reply has already
+     * come back, the slot is called immediately from this thread.
+     */
+    void set_notify( sigc::slot<void( std::shared_ptr<Message> )> slot );
+
+private:
+    static std::shared_ptr<PendingCall> create( uint32_t serial );
+
+    void set_reply( std::shared_ptr<Message> msg );
+
+    class priv_data;
+
+    DBUS_CXX_PROPAGATE_CONST( std::unique_ptr<priv_data> ) m_priv;
+
+    friend class Connection;
+};
 
 }
 
@@ -6,6 +6,7 @@
  *   This file is part of the dbus-cxx library.                            *
  ***************************************************************************/
 #include <dbus-cxx/property.h>
+#include <atomic>
 #include <dbus-cxx/variant.h>
 #include <dbus-cxx/interface.h>
 #include <dbus-cxx/signalmessage.h>
@@ -19,15 +20,25 @@ public:
         m_name( name ),
         m_propertyUpdate( update ),
         m_interface( nullptr ),
-        m_access( access )
+        m_value( std::make_shared<const Variant>() ),
+        m_valueHash( m_value->hash() ),
+        m_access( access ),
+        m_onlyOnChange( false ),
+        m_suppressedUpdates( 0 )
     {}
 
     std::string m_name;
     PropertyUpdateType m_propertyUpdate;
     sigc::signal<void(DBus::Variant)> m_propertyChangedSignal;
     Interface* m_interface;
-    Variant m_value;
+    /* Replaced as a whole on every set, so readers can hold on to it */
+    std::shared_ptr<const Variant> m_value;
+    /* Hash of m_value, kept only while m_onlyOnChange is set; it may lag
+     * behind the value, so it is only a hint */
+    std::atomic<std::size_t> m_valueHash;
     PropertyAccess m_access;
+    std::atomic<bool> m_onlyOnChange;
+    std::atomic<uint64_t> m_suppressedUpdates;
 };
 
 PropertyBase::PropertyBase( std::string name, PropertyAccess access, PropertyUpdateType update ) :
@@ -39,12 +50,16 @@ PropertyBase::~PropertyBase(){
 
 }
 
-std::string PropertyBase::name() const {
+const std::string& PropertyBase::name() const {
     return m_priv->m_name;
 }
 
 DBus::Variant PropertyBase::variant_value() const {
-    return m_priv->m_value;
+    return *shared_value();
+}
+
+std::shared_ptr<const DBus::Variant> PropertyBase::shared_value() const {
+    return std::atomic_load( &m_priv->m_value );
 }
 
 DBus::PropertyUpdateType PropertyBase::update_type() const {
@@ -52,7 +67,24 @@ DBus::PropertyUpdateType PropertyBase::update_type() const {
 }
 
 void PropertyBase::set_value( DBus::Variant value ) {
-    m_priv->m_value = value;
+    bool only_on_change = m_priv->m_onlyOnChange.load( std::memory_order_relaxed );
+    std::size_t hash = 0;
+
+    if( only_on_change ){
+        hash = value.hash();
+
+        if( hash == m_priv->m_valueHash.load( std::memory_order_relaxed ) &&
+            *shared_value() == value ) {
+            m_priv->m_suppressedUpdates.fetch_add( 1, std::memory_order_relaxed );
+            return;
+        }
+    }
+
+    std::atomic_store( &m_priv->m_value, std::make_shared<const Variant>( std::move( value ) ) );
+
+    if( only_on_change ){
+        m_priv->m_valueHash.store( hash, std::memory_order_relaxed );
+    }
 
     if( !m_priv->m_interface ){
         return;
@@ -68,3 +100,20 @@ DBus::PropertyAccess PropertyBase::access_type() const {
 void PropertyBase::setInterface( Interface* iface ){
     m_priv->m_interface = iface;
 }
+
+void PropertyBase::set_emit_only_on_change( bool only_on_change ){
+    if( only_on_change ){
+        /* The hash is not kept up to date while this is off */
+        m_priv->m_valueHash.store( shared_value()->hash(), std::memory_order_relaxed );
+    }
+
+    m_priv->m_onlyOnChange.store( only_on_change, std::memory_order_relaxed );
+}
+
+bool PropertyBase::emit_only_on_change() const {
+    return m_priv->m_onlyOnChange.load( std::memory_order_relaxed );
+}
+
+uint64_t PropertyBase::suppressed_updates() const {
+    return m_priv->m_suppressedUpdates.load( std::memory_order_relaxed );
+}
@@ -36,7 +36,7 @@ public:
      * Get the name of this propery.
      * @return
      */
-    std::string name() const;
+    const std::string& name() const;
 
     /**
      * Get the value of this property as a Variant.
@@ -45,6 +45,13 @@ public:
      */
     Variant variant_value() const;
 
+    /**
+     * Get the value of this property without copying it.  The value that is
+     * returned is never changed; setting the property replaces it, so this
+     * may be used while another thread sets the property.
+     */
+    std::shared_ptr<const Variant> shared_value() const;
+
     PropertyUpdateType update_type() const;
 
     PropertyAccess access_type() const;
@@ -65,6 +72,25 @@ public:
      */
     void set_value( Variant value );
 
+    /**
+     * If set, setting this property to the value that it already has does
+     * nothing: the value is not stored again and no PropertiesChanged signal
+     * is sent.  Off by default.
+     *
+     * Values are compared by their hash first, so a value that has changed
+     * is found without comparing all of its data.  The hash is only worked
+     * out while this is set, so other properties don't pay for it.
+     */
+    void set_emit_only_on_change( bool only_on_change );
+
+    bool emit_only_on_change() const;
+
+    /**
+     * @return The number of times that this property was set to the value
+     * that it already had, and so did not send a signal
+     */
+    uint64_t suppressed_updates() const;
+
     virtual std::string introspect( int spaces ){ return std::string(); }
 
 private:
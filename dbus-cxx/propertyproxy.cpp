@@ -9,6 +9,7 @@
 #include <dbus-cxx/variant.h>
 #include <dbus-cxx/interfaceproxy.h>
 #include <dbus-cxx/objectproxy.h>
+#include <mutex>
 #include "property.h"
 
 using DBus::PropertyProxyBase;
@@ -19,15 +20,19 @@ public:
         m_name( name ),
         m_propertyUpdate( update ),
         m_interface( nullptr ),
-        m_valueSet( false )
+        m_valueSet( false ),
+        m_generation( 0 )
     {}
 
     std::string m_name;
     PropertyUpdateType m_propertyUpdate;
     sigc::signal<void(DBus::Variant)> m_propertyChangedSignal;
     InterfaceProxy* m_interface;
+    /* The value is written from the dispatcher and read from anywhere */
+    mutable std::mutex m_value_mutex;
     Variant m_value;
     bool m_valueSet;
+    uint64_t m_generation;
 };
 
 PropertyProxyBase::PropertyProxyBase( std::string name, PropertyUpdateType update ) :
@@ -42,7 +47,11 @@ std::string PropertyProxyBase::name() const {
 }
 
 DBus::Variant PropertyProxyBase::variant_value() {
-    if( !m_priv->m_valueSet && m_priv->m_interface ){
+    if( is_stale() && m_priv->m_interface && m_priv->m_interface->property_caching() ){
+        m_priv->m_interface->cache_properties();
+    }
+
+    if( is_stale() && m_priv->m_interface ){
         std::shared_ptr<CallMessage> msg =
                 CallMessage::create( m_priv->m_interface->object()->destination(),
                                      m_priv->m_interface->path(),
@@ -60,9 +69,20 @@ DBus::Variant PropertyProxyBase::variant_value() {
         updated_value( var );
     }
 
+    std::scoped_lock lock( m_priv->m_value_mutex );
     return m_priv->m_value;
 }
 
+bool PropertyProxyBase::is_stale() const {
+    std::scoped_lock lock( m_priv->m_value_mutex );
+    return !m_priv->m_valueSet;
+}
+
+uint64_t PropertyProxyBase::generation() const {
+    std::scoped_lock lock( m_priv->m_value_mutex );
+    return m_priv->m_generation;
+}
+
 DBus::PropertyUpdateType PropertyProxyBase::update_type() const {
     return m_priv->m_propertyUpdate;
 }
@@ -90,6 +110,7 @@ void PropertyProxyBase::set_value( DBus::Variant value ) {
 
     // This is probably not needed, as the remote object will likely emit a signal with the new value,
     // but this shouldn't cause an issue.
+    std::scoped_lock lock( m_priv->m_value_mutex );
     m_priv->m_value = value;
 }
 
@@ -102,12 +123,17 @@ DBus::InterfaceProxy* PropertyProxyBase::interface_name() const {
 }
 
 void PropertyProxyBase::updated_value(Variant value){
-    m_priv->m_value = value;
-    m_priv->m_valueSet = true;
+    {
+        std::scoped_lock lock( m_priv->m_value_mutex );
+        m_priv->m_value = value;
+        m_priv->m_valueSet = true;
+        m_priv->m_generation++;
+    }
 
-    m_priv->m_propertyChangedSignal.emit( m_priv->m_value );
+    m_priv->m_propertyChangedSignal.emit( value );
 }
 
 void PropertyProxyBase::invalidate(){
+    std::scoped_lock lock( m_priv->m_value_mutex );
     m_priv->m_valueSet = false;
 }
@@ -38,12 +38,25 @@ public:
      * Get the value of this property as a Variant.
      *
      * If the value is stale, this will go and query the latest value from the
-     * remote object.
+     * remote object.  When the interface caches its properties, one GetAll
+     * call brings all of the stale properties of the interface up to date.
      *
      * @return
      */
     Variant variant_value();
 
+    /**
+     * @return true if no value is cached, because it has never been fetched
+     * or the remote object has invalidated it
+     */
+    bool is_stale() const;
+
+    /**
+     * @return The number of times a new value has been received from the
+     * remote object
+     */
+    uint64_t generation() const;
+
     PropertyUpdateType update_type() const;
 
     /**
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#include <dbus-cxx/dbus-cxx-config.h>
+#include <atomic>
+#include <climits>
+#include <thread>
+
+#ifdef DBUS_CXX_HAS_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#include "message.h"
+#include "replyslottable.h"
+
+using DBus::priv::ReplySlotTable;
+
+/*
+ * The state of a slot is kept in one word along with the serial that it is
+ * for, so that a reply for an old serial can never land in a slot that has
+ * since been reserved again.  A free slot is zero; serials are never zero.
+ */
+static const uint64_t SLOT_WAITING = 1;
+static const uint64_t SLOT_COMPLETING = 2;
+static const uint64_t SLOT_COMPLETE = 3;
+
+static uint64_t slot_word( uint32_t serial, uint64_t state ) {
+    return ( static_cast<uint64_t>( serial ) << 32 ) | state;
+}
+
+struct ReplySlotTable::Slot {
+    Slot() : word( 0 ), sequence( 0 ) {}
+
+    std::atomic<uint64_t> word;
+    /* Bumped every time a reply is delivered; this is what the waiter sleeps on */
+    std::atomic<uint32_t> sequence;
+    /* Only written by the thread that moved the slot to SLOT_COMPLETING */
+    std::shared_ptr<Message> reply;
+#ifndef DBUS_CXX_HAS_FUTEX
+    std::mutex lock;
+    std::condition_variable cv;
+#endif
+};
+
+ReplySlotTable::ReplySlotTable() :
+    m_slots( new Slot[ CAPACITY ] ) {
+}
+
+ReplySlotTable::~ReplySlotTable() {
+}
+
+bool ReplySlotTable::reserve( uint32_t serial ) {
+    if( serial == 0 ) { return false; }
+
+    Slot& slot = m_slots[ serial % CAPACITY ];
+    uint64_t expected = 0;
+
+    return slot.word.compare_exchange_strong( expected, slot_word( serial, SLOT_WAITING ), std::memory_order_acq_rel );
+}
+
+bool ReplySlotTable::complete( uint32_t serial, std::shared_ptr<Message> reply ) {
+    if( serial == 0 ) { return false; }
+
+    Slot& slot = m_slots[ serial % CAPACITY ];
+    uint64_t expected = slot_word( serial, SLOT_WAITING );
+
+    if( !slot.word.compare_exchange_strong( expected, slot_word( serial, SLOT_COMPLETING ), std::memory_order_acq_rel ) ) {
+        return false;
+    }
+
+    slot.reply = reply;
+    slot.word.store( slot_word( serial, SLOT_COMPLETE ), std::memory_order_release );
+    slot.sequence.fetch_add( 1, std::memory_order_release );
+    wake( slot );
+
+    return true;
+}
+
+std::shared_ptr<DBus::Message> ReplySlotTable::wait( uint32_t serial, std::chrono::steady_clock::time_point deadline ) {
+    Slot& slot = m_slots[ serial % CAPACITY ];
+
+    for( ;; ) {
+        /* Read the sequence first, so that a reply delivered after we look
+         * at the state wakes us straight back up */
+        uint32_t sequence = slot.sequence.load( std::memory_order_acquire );
+        uint64_t word = slot.word.load( std::memory_order_acquire );
+
+        if( word == slot_word( serial, SLOT_COMPLETE ) ) {
+            std::shared_ptr<Message> reply = std::move( slot.reply );
+            slot.reply.reset();
+            slot.word.store( 0, std::memory_order_release );
+            return reply;
+        }
+
+        if( word == slot_word( serial, SLOT_COMPLETING ) ) {
+            /* The reply is being handed over right now */
+            std::this_thread::yield();
+            continue;
+        }
+
+        if( word != slot_word( serial, SLOT_WAITING ) ) {
+            /* Not reserved for us; nothing will ever arrive */
+            return std::shared_ptr<Message>();
+        }
+
+        if( std::chrono::steady_clock::now() >= deadline ) {
+            /* Give up, unless the reply beats us to the slot */
+            if( slot.word.compare_exchange_strong( word, 0, std::memory_order_acq_rel ) ) {
+                return std::shared_ptr<Message>();
+            }
+
+            continue;
+        }
+
+        sleep( slot, sequence, deadline );
+    }
+}
+
+#ifdef DBUS_CXX_HAS_FUTEX
+
+void ReplySlotTable::sleep( Slot& slot, uint32_t sequence, std::chrono::steady_clock::time_point deadline ) {
+    std::chrono::nanoseconds remaining = deadline - std::chrono::steady_clock::now();
+
+    if( remaining.count() <= 0 ) { return; }
+
+    static_assert( sizeof( std::atomic<uint32_t> ) == sizeof( uint32_t ), "futex needs a plain 32-bit word" );
+
+    struct timespec timeout;
+    timeout.tv_sec = std::chrono::duration_cast<std::chrono::seconds>( remaining ).count();
+    timeout.tv_nsec = ( remaining - std::chrono::seconds( timeout.tv_sec ) ).count();
+
+    /* Returns straight away if the sequence has already moved on */
+    syscall( SYS_futex, reinterpret_cast<uint32_t*>( &slot.sequence ), FUTEX_WAIT_PRIVATE, sequence, &timeout, nullptr, 0 );
+}
+
+void ReplySlotTable::wake( Slot& slot ) {
+    syscall( SYS_futex, reinterpret_cast<uint32_t*>( &slot.sequence ), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0 );
+}
+
+#else
+
+void ReplySlotTable::sleep( Slot& slot, uint32_t sequence, std::chrono::steady_clock::time_point deadline ) {
+    std::unique_lock<std::mutex> lock( slot.lock );
+
+    slot.cv.wait_until( lock, deadline, [&slot, sequence]() {
+        return slot.sequence.load( std::memory_order_acquire ) != sequence;
+    } );
+}
+
+void ReplySlotTable::wake( Slot& slot ) {
+    {
+        /* Make sure that the waiter is either asleep or has not yet checked the sequence */
+        std::unique_lock<std::mutex> lock( slot.lock );
+    }
+
+    slot.cv.notify_all();
+}
+
+#endif
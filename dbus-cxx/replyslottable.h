@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#ifndef DBUSCXX_REPLYSLOTTABLE_H
+#define DBUSCXX_REPLYSLOTTABLE_H
+
+#include <chrono>
+#include <memory>
+#include <stdint.h>
+
+namespace DBus {
+
+class Message;
+
+namespace priv {
+
+/**
+ * Fixed-size table of the replies that threads are blocked waiting for,
+ * indexed by the serial of the call.
+ *
+ * A thread reserves the slot for its serial before the call is sent, and
+ * then waits on that slot alone.  Delivering a reply is a compare and swap
+ * on the slot followed by a wakeup of the waiting thread, so it takes no
+ * lock and allocates nothing.  Two calls whose serials map to the same slot
+ * can't be outstanding at the same time; reserve() fails for the second one,
+ * and the caller has to wait for its reply some other way.
+ *
+ * All methods are thread safe.
+ */
+class ReplySlotTable {
+public:
+    ReplySlotTable();
+
+    ~ReplySlotTable();
+
+    /**
+     * Reserve the slot for the given serial.
+     *
+     * @return false if the slot is in use by another call
+     */
+    bool reserve( uint32_t serial );
+
+    /**
+     * Give the reply to the thread waiting on the given serial.
+     *
+     * @return false if nobody is waiting for this serial in the table, or
+     * they have already given up waiting.
+     */
+    bool complete( uint32_t serial, std::shared_ptr<Message> reply );
+
+    /**
+     * Wait for the reply to a reserved serial, and free the slot.
+     *
+     * @return The reply, or an invalid pointer if the deadline passed first.
+     */
+    std::shared_ptr<Message> wait( uint32_t serial, std::chrono::steady_clock::time_point deadline );
+
+private:
+    struct Slot;
+
+    void sleep( Slot& slot, uint32_t sequence, std::chrono::steady_clock::time_point deadline );
+
+    void wake( Slot& slot );
+
+private:
+    static const uint32_t CAPACITY = 1024;
+
+    std::unique_ptr<Slot[]> m_slots;
+};
+
+} /* namespace priv */
+
+} /* namespace DBus */
+
+#endif /* DBUSCXX_REPLYSLOTTABLE_H */
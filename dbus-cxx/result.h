@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#ifndef DBUSCXX_RESULT_H
+#define DBUSCXX_RESULT_H
+
+#include <dbus-cxx/error.h>
+#include <utility>
+#include <variant>
+
+namespace DBus {
+
+/**
+ * Holds either the value returned from a method call, or the Error that
+ * the call failed with.
+ *
+ * A Result lets a method call fail without an exception being thrown.
+ * On the proxy side it is returned from MethodProxy::try_call(); on the
+ * adapter side a method may return a Result to send an error reply back
+ * to the caller.
+ *
+ * @param T The type of the value
+ */
+template <typename T>
+class Result {
+public:
+    Result() :
+        m_data( T() ) {}
+
+    Result( const T& value ) :
+        m_data( std::in_place_index<0>, value ) {}
+
+    Result( T&& value ) :
+        m_data( std::in_place_index<0>, std::move( value ) ) {}
+
+    Result( const Error& error ) :
+        m_data( std::in_place_index<1>, error ) {}
+
+    /**
+     * @return true if this holds a value, false if it holds an Error
+     */
+    bool has_value() const {
+        return m_data.index() == 0;
+    }
+
+    explicit operator bool() const {
+        return has_value();
+    }
+
+    /**
+     * Get the value.
+     *
+     * @throws Error The stored error, if there is no value; it is thrown as
+     * the subclass of Error that goes with its name, the same as a call that
+     * throws
+     */
+    const T& value() const {
+        if( !has_value() ) {
+            throw_named_error( std::get<1>( m_data ).name(), std::get<1>( m_data ).message() );
+        }
+
+        return std::get<0>( m_data );
+    }
+
+    T& value() {
+        if( !has_value() ) {
+            throw_named_error( std::get<1>( m_data ).name(), std::get<1>( m_data ).message() );
+        }
+
+        return std::get<0>( m_data );
+    }
+
+    /**
+     * Get the error.  Only valid if has_value() returns false.
+     */
+    const Error& error() const {
+        return std::get<1>( m_data );
+    }
+
+    /**
+     * @return The value, or the given default if this holds an error
+     */
+    T value_or( T default_value ) const {
+        if( has_value() ) {
+            return std::get<0>( m_data );
+        }
+
+        return default_value;
+    }
+
+private:
+    std::variant<T, Error> m_data;
+};
+
+/**
+ * Result specialization for methods that return nothing.
+ */
+template <>
+class Result<void> {
+public:
+    Result() :
+        m_ok( true ) {}
+
+    Result( const Error& error ) :
+        m_ok( false ),
+        m_error( error ) {}
+
+    bool has_value() const {
+        return m_ok;
+    }
+
+    explicit operator bool() const {
+        return has_value();
+    }
+
+    /**
+     * @throws Error The stored error, if the call failed, thrown the same
+     * way as from Result::value()
+     */
+    void value() const {
+        if( !m_ok ) {
+            throw_named_error( m_error.name(), m_error.message() );
+        }
+    }
+
+    const Error& error() const {
+        return m_error;
+    }
+
+private:
+    bool m_ok;
+    Error m_error;
+};
+
+} /* namespace DBus */
+
+#endif /* DBUSCXX_RESULT_H */
@@ -79,6 +79,7 @@ public:
     virtual void set_arg_name( size_t i, const std::string& name ) {
         if( i < m_arg_names.size() ) {
             m_arg_names[i] = name;
+            priv::introspection_changed();
         }
     }
 
@@ -56,7 +56,7 @@ SignalBase::SignalBase( std::weak_ptr<Connection> connection, const std::string&
 SignalBase::~SignalBase() {
 }
 
-std::shared_ptr< Connection > SignalBase::connection() {
+std::shared_ptr< Connection > SignalBase::connection() const {
     return m_priv->m_connection.lock();
 }
 
@@ -46,7 +46,7 @@ protected:
 public:
     virtual ~SignalBase();
 
-    std::shared_ptr<Connection> connection();
+    std::shared_ptr<Connection> connection() const;
 
     void set_connection( std::weak_ptr<Connection> connection );
 
@@ -7,6 +7,7 @@
  ***************************************************************************/
 #include "signalproxy.h"
 #include <dbus-cxx/signalmessage.h>
+#include "connection.h"
 #include "path.h"
 #include "signalbase.h"
 
@@ -14,15 +15,18 @@ namespace DBus {
 
 class SignalProxyBase::priv_data {
 public:
-    priv_data() {}
+    priv_data( const SignalMatchRule& matchRule ) :
+        m_rule( matchRule ),
+        m_match_rule( matchRule.match_rule() ) {}
 
+    SignalMatchRule m_rule;
     std::string m_match_rule;
 };
 
 SignalProxyBase::SignalProxyBase( const SignalMatchRule& matchRule ):
     SignalBase( matchRule.path(), matchRule.dbus_interface(), matchRule.member() ),
-    m_priv( std::make_unique<priv_data>() ) {
-    m_priv->m_match_rule = matchRule.match_rule();
+    m_priv( std::make_unique<priv_data>( matchRule ) ) {
+    set_sender( matchRule.sender() );
 }
 
 SignalProxyBase::~SignalProxyBase() {
@@ -38,29 +42,36 @@ const std::string& SignalProxyBase::match_rule() const {
     return m_priv->m_match_rule;
 }
 
-bool SignalProxyBase::matches( std::shared_ptr<const SignalMessage> msg ) {
+bool SignalProxyBase::matches( std::shared_ptr<const SignalMessage> msg ) const {
     if( !msg || !msg->is_valid() ) { return false; }
 
     if( !interface_name().empty() && interface_name() != msg->interface_name() ) { return false; }
 
     if( !name().empty() && name() != msg->member() ) { return false; }
 
-    if( !sender().empty() && sender() != msg->sender() ) { return false; }
+    if( !sender().empty() && sender() != msg->sender() ) {
+        // Signals always come from a unique name, so a well-known name has to be resolved
+        std::shared_ptr<Connection> conn = connection();
+
+        if( !conn || !conn->sender_is( sender(), msg->sender() ) ) { return false; }
+    }
 
     if( !destination().empty() && destination() != msg->destination() ) { return false; }
 
     if( !path().empty() && path() != msg->path() ) { return false; }
 
-    return true;
+    if( !m_priv->m_rule.matches_path_namespace( msg->path() ) ) { return false; }
+
+    return m_priv->m_rule.matches_arguments( msg );
 }
 
 void SignalProxyBase::update_match_rule(){
-    m_priv->m_match_rule = MatchRuleBuilder::create()
+    m_priv->m_rule = MatchRuleBuilder::create( m_priv->m_rule )
             .set_path( path() )
             .set_interface( interface_name() )
             .set_member( name() )
-            .as_signal_match()
-            .match_rule();
+            .as_signal_match();
+    m_priv->m_match_rule = m_priv->m_rule.match_rule();
 }
 
 }
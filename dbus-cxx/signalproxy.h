@@ -42,13 +42,20 @@ public:
 
     void update_match_rule();
 
+    /**
+     * Check to see if the given message would be handled by this proxy.
+     *
+     * @param msg The message to check
+     * @return True if the interface, member, sender, destination and path
+     * of the message all match this proxy.
+     */
+    bool matches( std::shared_ptr<const SignalMessage> msg ) const;
+
 protected:
     SignalProxyBase( const SignalMatchRule& matchRule );
 
     virtual ~SignalProxyBase();
 
-    bool matches( std::shared_ptr<const SignalMessage> msg );
-
     /**
      * This method is needed to be able to create a duplicate of a child
      * capable of parsing their specific template type message.
@@ -139,19 +139,28 @@ void StandaloneDispatcher::dispatch_thread_main() {
         fds.clear();
         fds.push_back( m_priv->process_fd[ 1 ] );
 
+        int timeout = -1;
+
         for( std::shared_ptr<Connection> conn : m_priv->m_connections ) {
             if( !conn->is_registered() ) {
                 conn->bus_register();
             }
 
             fds.push_back( conn->unix_fd() );
+
+            /* Wake up in time to expire any calls that are waiting for a reply */
+            int connTimeout = conn->next_timeout_milliseconds();
+
+            if( connTimeout >= 0 && ( timeout < 0 || connTimeout < timeout ) ) {
+                timeout = connTimeout;
+            }
         }
 
         std::tuple<bool, int, std::vector<int>, std::chrono::milliseconds> fdResponse =
-            DBus::priv::wait_for_fd_activity( fds, -1 );
+            DBus::priv::wait_for_fd_activity( fds, timeout );
         std::vector<int> fdsToRead = std::get<2>( fdResponse );
 
-        if( fdsToRead[ 0 ] == m_priv->process_fd[ 1 ] ) {
+        if( !fdsToRead.empty() && fdsToRead[ 0 ] == m_priv->process_fd[ 1 ] ) {
             char discard;
             if( read( m_priv->process_fd[ 1 ], &discard, sizeof( char ) ) < 0 ){
                 SIMPLELOGGER_DEBUG( LOGGER_NAME, "Failure reading from dispatch thread process_fd: "
@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#include <dbus-cxx/dbus-cxx-private.h>
+#include <dbus-cxx/error.h>
+#include <dbus-cxx/object.h>
+#include <dbus-cxx/signalproxy.h>
+#include <dbus-cxx/utility.h>
+#include "mpscqueue.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef DBUS_CXX_HAS_EVENTFD
+#include <sys/eventfd.h>
+#else
+#include <sys/socket.h>
+#endif
+
+#include "standalonethreaddispatcher.h"
+
+using DBus::StandaloneThreadDispatcher;
+
+static const char* LOGGER_NAME = "DBus.StandaloneThreadDispatcher";
+
+typedef std::vector<std::shared_ptr<DBus::SignalProxyBase>> SignalHandlers;
+
+/**
+ * One entry in the queue.  At most one of call, signal or work is set.
+ */
+struct QueueItem {
+    std::shared_ptr<DBus::Object> object;
+    std::shared_ptr<const DBus::CallMessage> call;
+    std::shared_ptr<const DBus::SignalMessage> signal;
+    bool has_work = false;
+    sigc::slot<void()> work;
+};
+
+class StandaloneThreadDispatcher::priv_data {
+public:
+    priv_data() :
+        m_running( false ),
+        m_wakeupPending( false ),
+        m_signalHandlers( std::make_shared<SignalHandlers>() ) {
+        wakeup_fd[ 0 ] = -1;
+        wakeup_fd[ 1 ] = -1;
+    }
+
+    DBus::priv::MpscQueue<QueueItem> m_queue;
+    std::atomic<bool> m_running;
+    /* Set when a wakeup has been written but not yet consumed */
+    std::atomic<bool> m_wakeupPending;
+    /*
+     * Signal handlers are copy-on-write: the owning thread takes a snapshot
+     * without locking, and add/remove replace the whole vector.
+     */
+    std::mutex m_signalHandlersWriteLock;
+    std::shared_ptr<const SignalHandlers> m_signalHandlers;
+    /* [0] is read by the owning thread, [1] is written to wake it up.
+     * With eventfd, both are the same descriptor. */
+    int wakeup_fd[ 2 ];
+};
+
+StandaloneThreadDispatcher::StandaloneThreadDispatcher() :
+    m_priv( std::make_unique<priv_data>() ) {
+#ifdef DBUS_CXX_HAS_EVENTFD
+    m_priv->wakeup_fd[ 0 ] = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+    m_priv->wakeup_fd[ 1 ] = m_priv->wakeup_fd[ 0 ];
+
+    if( m_priv->wakeup_fd[ 0 ] < 0 ) {
+        SIMPLELOGGER_ERROR( LOGGER_NAME, "error creating eventfd: " << strerror( errno ) );
+        throw ErrorDispatcherInitFailed();
+    }
+#else
+    if( socketpair( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, m_priv->wakeup_fd ) < 0 ) {
+        SIMPLELOGGER_ERROR( LOGGER_NAME, "error creating socket pair" );
+        throw ErrorDispatcherInitFailed();
+    }
+#endif
+}
+
+std::shared_ptr<StandaloneThreadDispatcher> StandaloneThreadDispatcher::create() {
+    return std::shared_ptr<StandaloneThreadDispatcher>( new StandaloneThreadDispatcher() );
+}
+
+StandaloneThreadDispatcher::~StandaloneThreadDispatcher() {
+    close( m_priv->wakeup_fd[ 0 ] );
+
+    if( m_priv->wakeup_fd[ 1 ] != m_priv->wakeup_fd[ 0 ] ) {
+        close( m_priv->wakeup_fd[ 1 ] );
+    }
+}
+
+void StandaloneThreadDispatcher::add_message( std::shared_ptr<Object> object, std::shared_ptr<const CallMessage> message ) {
+    QueueItem item;
+    item.object = object;
+    item.call = message;
+
+    m_priv->m_queue.push( std::move( item ) );
+    wakeup();
+}
+
+void StandaloneThreadDispatcher::add_signal_proxy( std::shared_ptr<SignalProxyBase> handler ) {
+    std::unique_lock<std::mutex> lock( m_priv->m_signalHandlersWriteLock );
+    std::shared_ptr<SignalHandlers> newHandlers =
+        std::make_shared<SignalHandlers>( *m_priv->m_signalHandlers );
+
+    newHandlers->push_back( handler );
+    std::atomic_store( &m_priv->m_signalHandlers, std::shared_ptr<const SignalHandlers>( newHandlers ) );
+}
+
+bool StandaloneThreadDispatcher::remove_signal_proxy( std::shared_ptr<SignalProxyBase> handler ) {
+    std::unique_lock<std::mutex> lock( m_priv->m_signalHandlersWriteLock );
+    const SignalHandlers& current = *m_priv->m_signalHandlers;
+    SignalHandlers::const_iterator it = std::find( current.begin(), current.end(), handler );
+
+    if( it == current.end() ) {
+        return false;
+    }
+
+    std::shared_ptr<SignalHandlers> newHandlers = std::make_shared<SignalHandlers>( current );
+    newHandlers->erase( newHandlers->begin() + ( it - current.begin() ) );
+    std::atomic_store( &m_priv->m_signalHandlers, std::shared_ptr<const SignalHandlers>( newHandlers ) );
+
+    return true;
+}
+
+void StandaloneThreadDispatcher::add_signal( std::shared_ptr<const SignalMessage> message ) {
+    QueueItem item;
+    item.signal = message;
+
+    m_priv->m_queue.push( std::move( item ) );
+    wakeup();
+}
+
+void StandaloneThreadDispatcher::post( sigc::slot<void()> work ) {
+    QueueItem item;
+    item.has_work = true;
+    item.work = work;
+
+    m_priv->m_queue.push( std::move( item ) );
+    wakeup();
+}
+
+void StandaloneThreadDispatcher::run() {
+    m_priv->m_running = true;
+
+    while( m_priv->m_running ) {
+        poll_once( -1 );
+    }
+}
+
+int StandaloneThreadDispatcher::poll_once( int timeout_ms ) {
+    std::vector<int> fds;
+    fds.push_back( m_priv->wakeup_fd[ 0 ] );
+
+    std::tuple<bool, int, std::vector<int>, std::chrono::milliseconds> fdResponse =
+        DBus::priv::wait_for_fd_activity( fds, timeout_ms );
+
+    if( std::get<0>( fdResponse ) ) {
+        return 0;
+    }
+
+    return process_pending();
+}
+
+int StandaloneThreadDispatcher::process_pending() {
+    int processed = 0;
+    std::vector<QueueItem> items;
+    std::shared_ptr<const SignalHandlers> handlers;
+
+    /* Clear the wakeup before draining, so that a message pushed while
+     * we are draining will always cause another wakeup */
+    clear_wakeup();
+
+    while( !( items = m_priv->m_queue.take_all() ).empty() ) {
+        for( QueueItem& item : items ) {
+            if( item.call ) {
+                item.object->handle_message( item.call );
+            } else if( item.signal ) {
+                if( !handlers ) {
+                    handlers = std::atomic_load( &m_priv->m_signalHandlers );
+                }
+
+                for( const std::shared_ptr<SignalProxyBase>& proxy : *handlers ) {
+                    proxy->handle_signal( item.signal );
+                }
+            } else if( item.has_work ) {
+                item.work();
+            }
+
+            processed++;
+        }
+    }
+
+    SIMPLELOGGER_TRACE( LOGGER_NAME, "Processed " << processed << " messages" );
+
+    return processed;
+}
+
+void StandaloneThreadDispatcher::stop() {
+    m_priv->m_running = false;
+
+    /* Force the wakeup, even if one is already pending */
+    m_priv->m_wakeupPending = false;
+    wakeup();
+}
+
+int StandaloneThreadDispatcher::fd() const {
+    return m_priv->wakeup_fd[ 0 ];
+}
+
+void StandaloneThreadDispatcher::wakeup() {
+    if( m_priv->m_wakeupPending.exchange( true, std::memory_order_acq_rel ) ) {
+        /* The owning thread has not yet woken up from the last notification */
+        return;
+    }
+
+#ifdef DBUS_CXX_HAS_EVENTFD
+    uint64_t value = 1;
+
+    if( write( m_priv->wakeup_fd[ 1 ], &value, sizeof( value ) ) < 0 ) {
+        SIMPLELOGGER_ERROR( LOGGER_NAME, "Can't write to eventfd: " << strerror( errno ) );
+    }
+#else
+    char to_write = '0';
+
+    if( write( m_priv->wakeup_fd[ 1 ], &to_write, sizeof( char ) ) < 0 ) {
+        SIMPLELOGGER_ERROR( LOGGER_NAME, "Can't write to socketpair?!" );
+    }
+#endif
+}
+
+void StandaloneThreadDispatcher::clear_wakeup() {
+#ifdef DBUS_CXX_HAS_EVENTFD
+    uint64_t value;
+
+    if( read( m_priv->wakeup_fd[ 0 ], &value, sizeof( value ) ) < 0 && errno != EAGAIN ) {
+        SIMPLELOGGER_DEBUG( LOGGER_NAME, "Failure reading from eventfd: " << strerror( errno ) );
+    }
+#else
+    char discard[ 16 ];
+
+    while( read( m_priv->wakeup_fd[ 0 ], discard, sizeof( discard ) ) > 0 ) {}
+#endif
+
+    m_priv->m_wakeupPending.store( false, std::memory_order_release );
+}
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#ifndef DBUSCXX_STANDALONE_THREAD_DISPATCHER_H
+#define DBUSCXX_STANDALONE_THREAD_DISPATCHER_H
+
+#include <dbus-cxx/dbus-cxx-config.h>
+#include <dbus-cxx/threaddispatcher.h>
+#include <memory>
+#include <sigc++/sigc++.h>
+
+namespace DBus {
+
+/**
+ * A ThreadDispatcher for applications that use plain std::thread instead
+ * of a Qt or GLib main loop.
+ *
+ * Method calls and signals are handed from the dispatcher thread to the
+ * owning thread through a lock-free multi-producer/single-consumer queue,
+ * so the dispatcher thread never blocks on a mutex that the owning thread
+ * may be holding.  The owning thread is woken through a file descriptor
+ * (an eventfd where available), and only once per batch of messages.
+ *
+ * The owning thread must either call run(), which processes messages until
+ * stop() is called, or call poll_once() from its own loop.  If the thread
+ * already has a poll() based loop, fd() may be added to it and
+ * process_pending() called whenever the descriptor is readable.
+ *
+ * Handlers are called on the thread that calls run(), poll_once() or
+ * process_pending(); this must be the same thread that registered this
+ * dispatcher with Connection::add_thread_dispatcher().  All of the
+ * ThreadDispatcher methods may be called from any thread.
+ */
+class StandaloneThreadDispatcher : public ThreadDispatcher {
+private:
+    StandaloneThreadDispatcher();
+
+public:
+    static std::shared_ptr<StandaloneThreadDispatcher> create();
+
+    ~StandaloneThreadDispatcher();
+
+    void add_message( std::shared_ptr<Object> object, std::shared_ptr<const CallMessage> message );
+
+    void add_signal_proxy( std::shared_ptr<SignalProxyBase> handler );
+
+    bool remove_signal_proxy( std::shared_ptr<SignalProxyBase> handler );
+
+    void add_signal( std::shared_ptr<const SignalMessage> message );
+
+    /**
+     * Queue a slot to be called on the owning thread.  May be called from
+     * any thread; this is how a coroutine is resumed on the owning thread.
+     */
+    void post( sigc::slot<void()> work );
+
+    /**
+     * Process messages on the calling thread until stop() is called.
+     */
+    void run();
+
+    /**
+     * Wait for at most timeout_ms for messages to arrive, and process all
+     * of the messages that are available.
+     *
+     * @param timeout_ms How long to wait in milliseconds, -1 to wait forever,
+     * or 0 to not wait at all.
+     * @return The number of messages that were processed.
+     */
+    int poll_once( int timeout_ms = -1 );
+
+    /**
+     * Process all of the messages that are currently queued without waiting.
+     *
+     * @return The number of messages that were processed.
+     */
+    int process_pending();
+
+    /**
+     * Cause run() to return.  May be called from any thread.
+     */
+    void stop();
+
+    /**
+     * The file descriptor that becomes readable whenever there are messages
+     * that need to be processed.  Do not read from this descriptor; call
+     * process_pending() instead.
+     */
+    int fd() const;
+
+private:
+    void wakeup();
+
+    void clear_wakeup();
+
+private:
+    class priv_data;
+
+    DBUS_CXX_PROPAGATE_CONST( std::unique_ptr<priv_data> ) m_priv;
+};
+
+} /* namespace DBus */
+
+#endif /* DBUSCXX_STANDALONE_THREAD_DISPATCHER_H */
@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#include "objectmanagerproxy.h"
+#include <functional>
+#include <mutex>
+#include "../callmessage.h"
+#include "../connection.h"
+#include "../dbus-cxx-private.h"
+#include "../matchrule.h"
+#include "../returnmessage.h"
+#include "../signalmessage.h"
+#include "../signalproxy.h"
+#include "../utility.h"
+
+using DBus::ObjectManagerProxy;
+
+static const char* LOGGER_NAME = "DBus.ObjectManagerProxy";
+
+namespace {
+
+/*
+ * A signal proxy that hands over the whole message, since the path that a
+ * signal came from is needed along with its arguments.
+ */
+class MessageSignalProxy : public DBus::SignalProxyBase {
+private:
+    MessageSignalProxy( const DBus::SignalMatchRule& matchRule,
+                        std::function<void(std::shared_ptr<const DBus::SignalMessage>)> handler ) :
+        DBus::SignalProxyBase( matchRule ),
+        m_handler( handler ){}
+
+public:
+    static std::shared_ptr<MessageSignalProxy> create( const DBus::SignalMatchRule& matchRule,
+                                                       std::function<void(std::shared_ptr<const DBus::SignalMessage>)> handler ){
+        return std::shared_ptr<MessageSignalProxy>( new MessageSignalProxy( matchRule, handler ) );
+    }
+
+protected:
+    DBus::HandlerResult on_dbus_incoming( std::shared_ptr<const DBus::SignalMessage> msg ){
+        try{
+            m_handler( msg );
+        }catch( const std::exception& e ){
+            SIMPLELOGGER_DEBUG( LOGGER_NAME, "Unable to handle " << msg->member() << " from " << msg->path() << ": " << e.what() );
+            return DBus::HandlerResult::Not_Handled;
+        }
+
+        return DBus::HandlerResult::Handled;
+    }
+
+private:
+    std::function<void(std::shared_ptr<const DBus::SignalMessage>)> m_handler;
+};
+
+}
+
+class ObjectManagerProxy::priv_data {
+public:
+    priv_data(){}
+
+    mutable std::mutex m_objects_mutex;
+    ManagedObjects m_objects;
+    std::vector<std::shared_ptr<DBus::SignalProxyBase>> m_signal_proxies;
+    sigc::signal<void(Path,InterfacesAndProperties)> m_signal_interfaces_added;
+    sigc::signal<void(Path,std::vector<std::string>)> m_signal_interfaces_removed;
+};
+
+ObjectManagerProxy::ObjectManagerProxy( std::shared_ptr<Connection> conn, const std::string& destination, const std::string& path ) :
+    ObjectProxy( conn, destination, path ),
+    m_priv( std::make_unique<priv_data>() ){
+}
+
+std::shared_ptr<ObjectManagerProxy> ObjectManagerProxy::create( std::shared_ptr<Connection> conn,
+                                                                const std::string& destination,
+                                                                const std::string& path ){
+    std::shared_ptr<ObjectManagerProxy> proxy( new ObjectManagerProxy( conn, destination, path ) );
+
+    if( !conn ){
+        return proxy;
+    }
+
+    /* A signal may already be on its way to a handler when the destructor
+     * removes the signal proxies, so the handlers only hold a weak pointer */
+    std::weak_ptr<ObjectManagerProxy> weak_self = proxy;
+
+    /* Listen for changes before asking for the objects, so that nothing
+     * that changes in between is missed */
+    proxy->m_priv->m_signal_proxies.push_back( MessageSignalProxy::create(
+        MatchRuleBuilder::create()
+        .set_sender( destination )
+        .set_path( path )
+        .set_interface( DBUS_CXX_OBJECT_MANAGER_INTERFACE )
+        .set_member( "InterfacesAdded" )
+        .as_signal_match(),
+        [weak_self]( std::shared_ptr<const SignalMessage> msg ){
+            std::shared_ptr<ObjectManagerProxy> self = weak_self.lock();
+
+            if( self ){ self->interfaces_added( msg ); }
+        } ) );
+    proxy->m_priv->m_signal_proxies.push_back( MessageSignalProxy::create(
+        MatchRuleBuilder::create()
+        .set_sender( destination )
+        .set_path( path )
+        .set_interface( DBUS_CXX_OBJECT_MANAGER_INTERFACE )
+        .set_member( "InterfacesRemoved" )
+        .as_signal_match(),
+        [weak_self]( std::shared_ptr<const SignalMessage> msg ){
+            std::shared_ptr<ObjectManagerProxy> self = weak_self.lock();
+
+            if( self ){ self->interfaces_removed( msg ); }
+        } ) );
+    proxy->m_priv->m_signal_proxies.push_back( MessageSignalProxy::create(
+        MatchRuleBuilder::create()
+        .set_sender( destination )
+        .set_path_namespace( path )
+        .set_interface( DBUS_CXX_PROPERTIES_INTERFACE )
+        .set_member( "PropertiesChanged" )
+        .as_signal_match(),
+        [weak_self]( std::shared_ptr<const SignalMessage> msg ){
+            std::shared_ptr<ObjectManagerProxy> self = weak_self.lock();
+
+            if( self ){ self->properties_changed( msg ); }
+        } ) );
+
+    for( std::shared_ptr<SignalProxyBase> signal : proxy->m_priv->m_signal_proxies ){
+        conn->add_free_signal_proxy( signal );
+    }
+
+    proxy->refresh();
+
+    return proxy;
+}
+
+ObjectManagerProxy::~ObjectManagerProxy(){
+    std::shared_ptr<Connection> conn = connection().lock();
+
+    if( !conn ){
+        return;
+    }
+
+    for( std::shared_ptr<SignalProxyBase> signal : m_priv->m_signal_proxies ){
+        conn->remove_free_signal_proxy( signal );
+    }
+}
+
+void ObjectManagerProxy::refresh(){
+    std::shared_ptr<CallMessage> call = create_call_message( DBUS_CXX_OBJECT_MANAGER_INTERFACE, "GetManagedObjects" );
+    std::shared_ptr<const ReturnMessage> reply = this->call( call );
+    ManagedObjects objects;
+
+    reply >> objects;
+
+    std::scoped_lock lock( m_priv->m_objects_mutex );
+
+    m_priv->m_objects.swap( objects );
+}
+
+ObjectManagerProxy::ManagedObjects ObjectManagerProxy::managed_objects() const {
+    std::scoped_lock lock( m_priv->m_objects_mutex );
+
+    return m_priv->m_objects;
+}
+
+bool ObjectManagerProxy::has_object( const Path& object_path ) const {
+    std::scoped_lock lock( m_priv->m_objects_mutex );
+
+    return m_priv->m_objects.find( object_path ) != m_priv->m_objects.end();
+}
+
+ObjectManagerProxy::InterfacesAndProperties ObjectManagerProxy::object( const Path& object_path ) const {
+    std::scoped_lock lock( m_priv->m_objects_mutex );
+    ManagedObjects::const_iterator it = m_priv->m_objects.find( object_path );
+
+    if( it == m_priv->m_objects.end() ){
+        return InterfacesAndProperties();
+    }
+
+    return it->second;
+}
+
+sigc::signal<void(DBus::Path,ObjectManagerProxy::InterfacesAndProperties)>& ObjectManagerProxy::signal_interfaces_added(){
+    return m_priv->m_signal_interfaces_added;
+}
+
+sigc::signal<void(DBus::Path,std::vector<std::string>)>& ObjectManagerProxy::signal_interfaces_removed(){
+    return m_priv->m_signal_interfaces_removed;
+}
+
+void ObjectManagerProxy::interfaces_added( std::shared_ptr<const SignalMessage> msg ){
+    Path object_path;
+    InterfacesAndProperties interfaces;
+
+    msg >> object_path >> interfaces;
+
+    {
+        std::scoped_lock lock( m_priv->m_objects_mutex );
+        InterfacesAndProperties& known = m_priv->m_objects[ object_path ];
+
+        for( const InterfacesAndProperties::value_type& iface : interfaces ){
+            known[ iface.first ] = iface.second;
+        }
+    }
+
+    m_priv->m_signal_interfaces_added.emit( object_path, interfaces );
+}
+
+void ObjectManagerProxy::interfaces_removed( std::shared_ptr<const SignalMessage> msg ){
+    Path object_path;
+    std::vector<std::string> interfaces;
+
+    msg >> object_path >> interfaces;
+
+    {
+        std::scoped_lock lock( m_priv->m_objects_mutex );
+        ManagedObjects::iterator it = m_priv->m_objects.find( object_path );
+
+        if( it != m_priv->m_objects.end() ){
+            for( const std::string& name : interfaces ){
+                it->second.erase( name );
+            }
+
+            /* An object with no interfaces left is gone */
+            if( it->second.empty() ){
+                m_priv->m_objects.erase( it );
+            }
+        }
+    }
+
+    m_priv->m_signal_interfaces_removed.emit( object_path, interfaces );
+}
+
+void ObjectManagerProxy::properties_changed( std::shared_ptr<const SignalMessage> msg ){
+    std::string interface_name;
+    Properties changed;
+    std::vector<std::string> invalidated;
+
+    msg >> interface_name >> changed >> invalidated;
+
+    std::scoped_lock lock( m_priv->m_objects_mutex );
+    ManagedObjects::iterator it = m_priv->m_objects.find( msg->path() );
+
+    if( it == m_priv->m_objects.end() ){
+        return;
+    }
+
+    InterfacesAndProperties::iterator iface = it->second.find( interface_name );
+
+    if( iface == it->second.end() ){
+        return;
+    }
+
+    for( const Properties::value_type& prop : changed ){
+        iface->second[ prop.first ] = prop.second;
+    }
+
+    for( const std::string& name : invalidated ){
+        iface->second.erase( name );
+    }
+}
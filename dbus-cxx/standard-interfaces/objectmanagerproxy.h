@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#ifndef DBUSCXX_OBJECT_MANAGER_PROXY_H
+#define DBUSCXX_OBJECT_MANAGER_PROXY_H
+
+#include "../objectproxy.h"
+#include "../path.h"
+#include "../variant.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sigc++/sigc++.h>
+
+namespace DBus{
+
+class Connection;
+class SignalMessage;
+
+/**
+ * A proxy for a remote org.freedesktop.DBus.ObjectManager, which keeps a
+ * copy of all of the objects that it manages, with their interfaces and
+ * properties.
+ *
+ * The copy is filled in by one call to GetManagedObjects, and then kept up
+ * to date from the InterfacesAdded, InterfacesRemoved and PropertiesChanged
+ * signals, so that the state of a whole tree of objects can be known without
+ * calling each of them.
+ *
+ * @ingroup proxy
+ * @ingroup objects
+ */
+class ObjectManagerProxy : public ObjectProxy {
+public:
+    typedef std::map<std::string,Variant> Properties;
+    typedef std::map<std::string,Properties> InterfacesAndProperties;
+    typedef std::map<Path,InterfacesAndProperties> ManagedObjects;
+
+private:
+    ObjectManagerProxy( std::shared_ptr<Connection> conn, const std::string& destination, const std::string& path );
+
+public:
+    /**
+     * Create a proxy for the object manager at the given path, and fill in
+     * the objects that it manages.
+     */
+    static std::shared_ptr<ObjectManagerProxy> create( std::shared_ptr<Connection> conn,
+                                                       const std::string& destination,
+                                                       const std::string& path );
+
+    ~ObjectManagerProxy();
+
+    /**
+     * Call GetManagedObjects, and replace all of the objects that are known
+     * with what it returns.
+     */
+    void refresh();
+
+    /**
+     * @return A copy of all of the objects that are known
+     */
+    ManagedObjects managed_objects() const;
+
+    bool has_object( const Path& object_path ) const;
+
+    /**
+     * @return The interfaces and properties of the given object, or nothing
+     * if the object is not known
+     */
+    InterfacesAndProperties object( const Path& object_path ) const;
+
+    /**
+     * Emitted after an object or interfaces of it have been added to the
+     * copy, with the interfaces that were added.
+     */
+    sigc::signal<void(Path,InterfacesAndProperties)>& signal_interfaces_added();
+
+    /**
+     * Emitted after interfaces of an object have been removed from the copy,
+     * with the names of the interfaces that were removed.
+     */
+    sigc::signal<void(Path,std::vector<std::string>)>& signal_interfaces_removed();
+
+private:
+    void interfaces_added( std::shared_ptr<const SignalMessage> msg );
+
+    void interfaces_removed( std::shared_ptr<const SignalMessage> msg );
+
+    void properties_changed( std::shared_ptr<const SignalMessage> msg );
+
+private:
+    class priv_data;
+
+    DBUS_CXX_PROPAGATE_CONST( std::unique_ptr<priv_data> ) m_priv;
+};
+
+}
+
+#endif /* DBUSCXX_OBJECT_MANAGER_PROXY_H */
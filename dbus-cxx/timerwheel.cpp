@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#include "timerwheel.h"
+
+using DBus::priv::TimerWheel;
+
+TimerWheel::TimerWheel( Clock::time_point now ) :
+    m_start( now ),
+    m_current( 0 ) {
+}
+
+void TimerWheel::add( uint32_t id, Clock::time_point deadline ) {
+    Entry entry;
+    entry.id = id;
+    entry.expiry = to_tick( deadline );
+
+    /* The slot for the current tick has already been processed */
+    if( entry.expiry <= m_current ) {
+        entry.expiry = m_current + 1;
+    }
+
+    m_active[ id ] = entry.expiry;
+    insert( entry );
+}
+
+bool TimerWheel::remove( uint32_t id ) {
+    return m_active.erase( id ) > 0;
+}
+
+std::vector<uint32_t> TimerWheel::advance( Clock::time_point now ) {
+    std::vector<uint32_t> expired;
+    uint64_t target = to_tick( now );
+
+    if( m_active.empty() ) {
+        /* Nothing can expire, so skip straight there.  Any stale entries
+         * that are left in the slots are ignored when they come around. */
+        if( target > m_current ) { m_current = target; }
+
+        return expired;
+    }
+
+    while( m_current < target ) {
+        m_current++;
+
+        /* When a level wraps around, pull the next slot of the level above down */
+        for( int level = 1; level < LEVELS; level++ ) {
+            if( ( m_current & ( ( uint64_t( 1 ) << ( SLOT_BITS * level ) ) - 1 ) ) != 0 ) {
+                break;
+            }
+
+            cascade( level );
+        }
+
+        std::vector<Entry> slot;
+        slot.swap( m_slots[ 0 ][ m_current & ( SLOTS - 1 ) ] );
+
+        for( const Entry& entry : slot ) {
+            std::unordered_map<uint32_t, uint64_t>::iterator it = m_active.find( entry.id );
+
+            /* Removed, or removed and added again with a different deadline */
+            if( it == m_active.end() || it->second != entry.expiry ) { continue; }
+
+            if( entry.expiry > m_current ) {
+                insert( entry );
+                continue;
+            }
+
+            m_active.erase( it );
+            expired.push_back( entry.id );
+        }
+
+        if( m_active.empty() ) {
+            m_current = target;
+        }
+    }
+
+    return expired;
+}
+
+TimerWheel::Clock::time_point TimerWheel::next_deadline() const {
+    if( m_active.empty() ) {
+        return Clock::time_point::max();
+    }
+
+    uint64_t next = UINT64_MAX;
+
+    for( int level = 0; level < LEVELS; level++ ) {
+        int shift = SLOT_BITS * level;
+        uint64_t base = m_current >> shift;
+
+        for( uint64_t x = 1; x <= SLOTS; x++ ) {
+            if( m_slots[ level ][ ( base + x ) & ( SLOTS - 1 ) ].empty() ) { continue; }
+
+            /* For the upper levels this is when the slot is cascaded,
+             * which is no later than anything in it expires */
+            uint64_t tick = ( base + x ) << shift;
+
+            if( tick < next ) { next = tick; }
+
+            break;
+        }
+    }
+
+    if( next == UINT64_MAX ) {
+        return Clock::time_point::max();
+    }
+
+    return from_tick( next );
+}
+
+bool TimerWheel::empty() const {
+    return m_active.empty();
+}
+
+uint64_t TimerWheel::to_tick( Clock::time_point time ) const {
+    if( time <= m_start ) { return 0; }
+
+    /* Round up, so that a timer never fires early */
+    std::chrono::nanoseconds since = time - m_start;
+    return ( since + std::chrono::milliseconds( 1 ) - std::chrono::nanoseconds( 1 ) ) / std::chrono::milliseconds( 1 );
+}
+
+TimerWheel::Clock::time_point TimerWheel::from_tick( uint64_t tick ) const {
+    return m_start + std::chrono::milliseconds( tick );
+}
+
+void TimerWheel::insert( const Entry& entry ) {
+    uint64_t delta = entry.expiry - m_current;
+    uint64_t placement = entry.expiry;
+    int level = 0;
+
+    while( level < LEVELS - 1 && delta >= ( uint64_t( 1 ) << ( SLOT_BITS * ( level + 1 ) ) ) ) {
+        level++;
+    }
+
+    if( level == LEVELS - 1 && delta >= ( uint64_t( 1 ) << ( SLOT_BITS * LEVELS ) ) ) {
+        /* Too far out to represent; park it in the furthest slot and it
+         * will be placed again when that slot is cascaded */
+        placement = m_current + ( uint64_t( 1 ) << ( SLOT_BITS * LEVELS ) ) - 1;
+    }
+
+    int slot = ( placement >> ( SLOT_BITS * level ) ) & ( SLOTS - 1 );
+    m_slots[ level ][ slot ].push_back( entry );
+}
+
+void TimerWheel::cascade( int level ) {
+    std::vector<Entry> slot;
+    slot.swap( m_slots[ level ][ ( m_current >> ( SLOT_BITS * level ) ) & ( SLOTS - 1 ) ] );
+
+    for( const Entry& entry : slot ) {
+        std::unordered_map<uint32_t, uint64_t>::const_iterator it = m_active.find( entry.id );
+
+        if( it == m_active.end() || it->second != entry.expiry ) { continue; }
+
+        insert( entry );
+    }
+}
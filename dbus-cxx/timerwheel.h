@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#ifndef DBUSCXX_TIMERWHEEL_H
+#define DBUSCXX_TIMERWHEEL_H
+
+#include <chrono>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace DBus {
+
+namespace priv {
+
+/**
+ * Hierarchical timer wheel, used to time out replies to method calls.
+ *
+ * Timers are identified by the serial of the call that they are for, and
+ * have a resolution of one millisecond.  Adding and removing a timer is
+ * O(1); removed timers are left in their slot and skipped when the slot
+ * expires.  Each level has 64 slots, so the four levels cover about
+ * 4.6 hours; anything further out than that is re-checked once the last
+ * level wraps around.
+ *
+ * This class is not thread safe.
+ */
+class TimerWheel {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    TimerWheel( Clock::time_point now = Clock::now() );
+
+    /**
+     * Add a timer, replacing any existing timer with the same id.
+     */
+    void add( uint32_t id, Clock::time_point deadline );
+
+    /**
+     * Remove a timer.
+     *
+     * @return true if the timer existed
+     */
+    bool remove( uint32_t id );
+
+    /**
+     * Advance the wheel to the given time.
+     *
+     * @return The ids of all of the timers that have expired.
+     */
+    std::vector<uint32_t> advance( Clock::time_point now );
+
+    /**
+     * The time at which advance() next needs to be called.  This may be
+     * earlier than the next deadline, but is never later.
+     *
+     * @return The next time, or Clock::time_point::max() if there are
+     * no timers.
+     */
+    Clock::time_point next_deadline() const;
+
+    bool empty() const;
+
+private:
+    struct Entry {
+        uint32_t id;
+        uint64_t expiry;
+    };
+
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+
+    uint64_t to_tick( Clock::time_point time ) const;
+
+    Clock::time_point from_tick( uint64_t tick ) const;
+
+    void insert( const Entry& entry );
+
+    void cascade( int level );
+
+private:
+    Clock::time_point m_start;
+    uint64_t m_current;
+    std::vector<Entry> m_slots[ LEVELS ][ SLOTS ];
+    /* id -> expiry tick of every timer that is still active */
+    std::unordered_map<uint32_t, uint64_t> m_active;
+};
+
+} /* namespace priv */
+
+} /* namespace DBus */
+
+#endif /* DBUSCXX_TIMERWHEEL_H */
@@ -7,6 +7,7 @@
  ***************************************************************************/
 #include "utility.h"
 #include <stdio.h>
+#include <atomic>
 #include <iostream>
 #include <mutex>
 #include <new>
@@ -27,6 +28,7 @@ simplelogger_log_function dbuscxx_log_function = nullptr;
 namespace DBus {
 
 static enum SL_LogLevel log_level = SL_INFO;
+static std::atomic<uint64_t> introspection_generation_counter( 0 );
 
 void set_logging_function( simplelogger_log_function function ) {
     dbuscxx_log_function = function;
@@ -136,6 +138,91 @@ std::tuple<bool, int, std::vector<int>, std::chrono::milliseconds> priv::wait_fo
 
     return std::make_tuple( timeout, poll_ret, fdsToRead, ms_waited );
 }
+
+static bool is_numeric_type( char type ) {
+    switch( type ) {
+    case 'y':
+    case 'b':
+    case 'n':
+    case 'q':
+    case 'i':
+    case 'u':
+    case 'x':
+    case 't':
+    case 'd':
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+static bool is_string_type( char type ) {
+    return type == 's' || type == 'o' || type == 'g';
+}
+
+/*
+ * Compare the single complete types starting at actual[a] and expected[e],
+ * and move both past them.
+ */
+static bool complete_type_is_compatible( const std::string& actual, size_t& a, const std::string& expected, size_t& e ) {
+    if( a >= actual.size() || e >= expected.size() ) { return false; }
+
+    char actual_type = actual[ a++ ];
+    char expected_type = expected[ e++ ];
+
+    if( is_numeric_type( actual_type ) && is_numeric_type( expected_type ) ) { return true; }
+
+    if( is_string_type( actual_type ) && is_string_type( expected_type ) ) { return true; }
+
+    if( actual_type != expected_type ) { return false; }
+
+    if( actual_type == 'a' ) {
+        return complete_type_is_compatible( actual, a, expected, e );
+    }
+
+    if( actual_type == '(' || actual_type == '{' ) {
+        char close = actual_type == '(' ? ')' : '}';
+
+        for( ;; ) {
+            bool actual_done = a < actual.size() && actual[ a ] == close;
+            bool expected_done = e < expected.size() && expected[ e ] == close;
+
+            if( actual_done && expected_done ) {
+                a++;
+                e++;
+                return true;
+            }
+
+            if( actual_done || expected_done ) { return false; }
+
+            if( !complete_type_is_compatible( actual, a, expected, e ) ) { return false; }
+        }
+    }
+
+    return true;
+}
+
+bool priv::signature_is_compatible( const std::string& actual, const std::string& expected ) {
+    size_t a = 0;
+    size_t e = 0;
+
+    while( e < expected.size() ) {
+        if( !complete_type_is_compatible( actual, a, expected, e ) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void priv::introspection_changed() {
+    introspection_generation_counter.fetch_add( 1, std::memory_order_release );
+}
+
+uint64_t priv::introspection_generation() {
+    return introspection_generation_counter.load( std::memory_order_acquire );
+}
 }
 
 
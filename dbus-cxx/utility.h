@@ -26,9 +26,12 @@
 #ifndef DBUSCXX_UTILITY_H
 #define DBUSCXX_UTILITY_H
 
+#define DBUS_CXX_BUS_NAME           "org.freedesktop.DBus"
+#define DBUS_CXX_BUS_PATH           "/org/freedesktop/DBus"
 #define DBUS_CXX_INTROSPECTABLE_INTERFACE "org.freedesktop.DBus.Introspectable"
 #define DBUS_CXX_PEER_INTERFACE     "org.freedesktop.DBus.Peer"
 #define DBUS_CXX_PROPERTIES_INTERFACE   "org.freedesktop.DBus.Properties"
+#define DBUS_CXX_OBJECT_MANAGER_INTERFACE   "org.freedesktop.DBus.ObjectManager"
 #define DBUS_CXX_PROPERTY_EMITS_CHANGE_SIGNAL_ANNOTATION "org.freedesktop.DBus.Property.EmitsChangedSignal"
 
 /**
@@ -358,6 +361,48 @@ struct dbus_function_traits<std::function<DBus::MultipleReturn<T_ret...>( Args..
  */
 std::tuple<bool, int, std::vector<int>, std::chrono::milliseconds> wait_for_fd_activity( std::vector<int> fds, int timeout_ms );
 
+/**
+ * Check if arguments with the actual signature can be extracted as the
+ * expected signature.  This follows the conversions that MessageIterator
+ * does: any numeric type can be read as any other numeric type, and strings,
+ * object paths and signatures can all be read as each other.  Extra arguments
+ * after the expected ones are ignored, as they are when extracting.
+ *
+ * @param actual The signature of the message
+ * @param expected The signature that the arguments will be extracted as
+ * @return true if the arguments can be extracted
+ */
+bool signature_is_compatible( const std::string& actual, const std::string& expected );
+
+/**
+ * Note that something which shows up in introspection data has changed, so
+ * that any cached introspection data gets built again.
+ */
+void introspection_changed();
+
+/**
+ * @return A number that changes every time introspection_changed() is called
+ */
+uint64_t introspection_generation();
+
+/*
+ * return_signature - the signature of the reply to a method returning T
+ */
+template<typename T>
+struct return_signature {
+    std::string dbus_sig() const {
+        T t{};
+        return signature( t );
+    }
+};
+
+template<typename... T>
+struct return_signature<DBus::MultipleReturn<T...>> {
+    std::string dbus_sig() const {
+        return dbus_signature<T...>().dbus_sig();
+    }
+};
+
 } /* namespace priv */
 
 } /* namespace DBus */
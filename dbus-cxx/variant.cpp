@@ -134,9 +134,12 @@ Variant::Variant( const Variant& other ) :
 
 Variant::Variant( Variant&& other ) :
     m_currentType( std::exchange( other.m_currentType, DataType::INVALID ) ),
-    m_signature( std::exchange( other.m_signature, "" ) ),
+    m_signature( other.m_signature ),
     m_marshaled( std::move( other.m_marshaled ) ),
     m_dataAlignment( std::exchange( other.m_dataAlignment, 0 ) ){
+    // Copies of a Signature share their data, so give the other one a new
+    // Signature instead of emptying the one that we now share
+    other.m_signature = Signature();
 }
 
 Variant::~Variant() {}
@@ -462,7 +465,8 @@ int Variant::data_alignment() const {
 }
 
 bool Variant::operator==( const Variant& other ) const {
-    bool sameType = other.type() == type();
+    bool sameType = other.type() == type() &&
+        other.m_signature.str() == m_signature.str();
     bool vectorsEqual = false;
 
     if( sameType ) {
@@ -472,6 +476,25 @@ bool Variant::operator==( const Variant& other ) const {
     return sameType && vectorsEqual;
 }
 
+std::size_t Variant::hash() const {
+    // 64-bit FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    const uint64_t prime = 1099511628211ULL;
+
+    for( char c : m_signature.str() ) {
+        hash = ( hash ^ static_cast<uint8_t>( c ) ) * prime;
+    }
+
+    // Hash a NUL between the signature and the data, which a signature can't contain
+    hash *= prime;
+
+    for( uint8_t byte : m_marshaled ) {
+        hash = ( hash ^ byte ) * prime;
+    }
+
+    return static_cast<std::size_t>( hash );
+}
+
 Variant& Variant::operator=( const Variant& other ) {
     m_currentType = other.m_currentType;
     m_signature = other.m_signature;
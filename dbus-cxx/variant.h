@@ -19,6 +19,7 @@
 #include <dbus-cxx/error.h>
 #include <string>
 #include <any>
+#include <functional>
 #include <stdint.h>
 #include <ostream>
 #include <vector>
@@ -99,6 +100,13 @@ public:
 
     bool operator==( const Variant& other ) const;
 
+    /**
+     * A hash of the signature and the marshaled data of this Variant.
+     * Variants that are equal have the same hash, so comparing hashes is a
+     * quick way to tell that two values are different.
+     */
+    std::size_t hash() const;
+
     Variant& operator=( const Variant& other );
 
     template <typename T>
@@ -190,4 +198,15 @@ private:
 
 } /* namespace DBus */
 
+namespace std {
+
+template <>
+struct hash<DBus::Variant> {
+    std::size_t operator()( const DBus::Variant& variant ) const {
+        return variant.hash();
+    }
+};
+
+} /* namespace std */
+
 #endif /* DBUSCXX_VARIANT_H */
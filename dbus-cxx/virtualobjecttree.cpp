@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#include "virtualobjecttree.h"
+#include <algorithm>
+#include <sstream>
+#include "callmessage.h"
+#include "connection.h"
+#include "dbus-cxx-private.h"
+#include "errormessage.h"
+#include "returnmessage.h"
+#include "utility.h"
+
+static const char* LOGGER_NAME = "DBus.VirtualObjectTree";
+
+namespace DBus {
+
+class VirtualObjectTree::priv_data {
+public:
+    priv_data( Enumerator enumerator, Handler handler ) :
+        m_enumerator( enumerator ),
+        m_handler( handler ) {}
+
+    Enumerator m_enumerator;
+    Handler m_handler;
+    ExistenceCheck m_existenceCheck;
+    Describer m_describer;
+    PropertyGetter m_propertyGetter;
+    PropertySetter m_propertySetter;
+};
+
+VirtualObjectTree::VirtualObjectTree( const std::string& path, Enumerator enumerator, Handler handler ) :
+    Object( path ),
+    m_priv( std::make_unique<priv_data>( enumerator, handler ) ) {
+}
+
+std::shared_ptr<VirtualObjectTree> VirtualObjectTree::create( const std::string& path, Enumerator enumerator, Handler handler ) {
+    return std::shared_ptr<VirtualObjectTree>( new VirtualObjectTree( path, enumerator, handler ) );
+}
+
+VirtualObjectTree::~VirtualObjectTree() {
+}
+
+void VirtualObjectTree::set_existence_check( ExistenceCheck check ) {
+    m_priv->m_existenceCheck = check;
+}
+
+void VirtualObjectTree::set_describer( Describer describer ) {
+    m_priv->m_describer = describer;
+}
+
+void VirtualObjectTree::set_property_getter( PropertyGetter getter ) {
+    m_priv->m_propertyGetter = getter;
+}
+
+void VirtualObjectTree::set_property_setter( PropertySetter setter ) {
+    m_priv->m_propertySetter = setter;
+}
+
+bool VirtualObjectTree::exists( const Path& object_path ) const {
+    const std::string& root = path();
+
+    if( object_path == root ) { return true; }
+
+    /* Must be below the root of the tree */
+    if( root != "/" &&
+        ( object_path.compare( 0, root.size(), root ) != 0 || object_path[ root.size() ] != '/' ) ) {
+        return false;
+    }
+
+    if( m_priv->m_existenceCheck ) {
+        return m_priv->m_existenceCheck( object_path );
+    }
+
+    if( !m_priv->m_enumerator ) { return false; }
+
+    size_t last_slash = object_path.rfind( '/' );
+    Path parent = last_slash == 0 ? Path( "/" ) : Path( object_path.substr( 0, last_slash ) );
+    std::string name = object_path.substr( last_slash + 1 );
+
+    if( !exists( parent ) ) { return false; }
+
+    std::vector<std::string> siblings = m_priv->m_enumerator( parent );
+
+    return std::find( siblings.begin(), siblings.end(), name ) != siblings.end();
+}
+
+std::string VirtualObjectTree::introspect_path( const Path& object_path ) const {
+    std::ostringstream sout;
+
+    sout << "<node name=\"" << object_path << "\">\n"
+        << introspect_standard_interfaces( "" );
+
+    if( m_priv->m_describer ) {
+        sout << m_priv->m_describer( object_path );
+    }
+
+    if( m_priv->m_enumerator ) {
+        for( const std::string& child : m_priv->m_enumerator( object_path ) ) {
+            sout << "  <node name=\"" << child << "\"/>\n";
+        }
+    }
+
+    sout << "</node>\n";
+    return sout.str();
+}
+
+HandlerResult VirtualObjectTree::handle_message( std::shared_ptr<const Message> message ) {
+    std::shared_ptr<Connection> conn = connection().lock();
+
+    if( !conn ) {
+        SIMPLELOGGER_ERROR( LOGGER_NAME, "Unable to handle call message: invalid connection" );
+        return HandlerResult::Not_Handled;
+    }
+
+    if( message->type() != MessageType::CALL ) {
+        return HandlerResult::Not_Handled;
+    }
+
+    std::shared_ptr<const CallMessage> msg = std::static_pointer_cast<const CallMessage>( message );
+    Path object_path = msg->path();
+
+    if( !exists( object_path ) ) {
+        std::shared_ptr<ErrorMessage> errmsg = ErrorMessage::create( msg, DBUSCXX_ERROR_UNKNOWN_OBJECT,
+                "No object at path " + object_path );
+        conn << errmsg;
+        return HandlerResult::Handled;
+    }
+
+    if( msg->interface_name() == DBUS_CXX_INTROSPECTABLE_INTERFACE ) {
+        std::shared_ptr<ReturnMessage> return_message = msg->create_reply();
+        std::string introspection = DBUSCXX_INTROSPECT_1_0_XML_DOCTYPE_DECL_NODE;
+        introspection += introspect_path( object_path );
+        *return_message << introspection;
+        conn << return_message;
+        return HandlerResult::Handled;
+    } else if( msg->interface_name() == DBUS_CXX_PEER_INTERFACE ) {
+        /* Nothing in the Peer interface depends on the path */
+        return Object::handle_message( message );
+    } else if( msg->interface_name() == DBUS_CXX_PROPERTIES_INTERFACE ) {
+        return handle_properties_message( conn, msg );
+    }
+
+    if( !m_priv->m_handler ) {
+        return HandlerResult::Invalid_Method;
+    }
+
+    return m_priv->m_handler( conn, msg );
+}
+
+HandlerResult VirtualObjectTree::handle_properties_message( std::shared_ptr<Connection> conn, std::shared_ptr<const CallMessage> msg ) {
+    Path object_path = msg->path();
+    std::string interfaceName;
+    std::shared_ptr<Message> reply;
+
+    if( msg->member() == "GetAll" ) {
+        std::map<std::string, Variant> properties;
+
+        msg >> interfaceName;
+
+        if( m_priv->m_propertyGetter ) {
+            properties = m_priv->m_propertyGetter( object_path, interfaceName );
+        }
+
+        std::shared_ptr<ReturnMessage> retmsg = msg->create_reply();
+        retmsg << properties;
+        reply = retmsg;
+    } else if( msg->member() == "Get" ) {
+        std::string propertyName;
+        std::map<std::string, Variant> properties;
+
+        msg >> interfaceName >> propertyName;
+
+        if( m_priv->m_propertyGetter ) {
+            properties = m_priv->m_propertyGetter( object_path, interfaceName );
+        }
+
+        std::map<std::string, Variant>::iterator it = properties.find( propertyName );
+
+        if( it == properties.end() ) {
+            reply = ErrorMessage::create( msg, DBUSCXX_ERROR_UNKNOWN_PROPERTY,
+                    "Unable to find property " + propertyName + " on interface " + interfaceName );
+        } else {
+            std::shared_ptr<ReturnMessage> retmsg = msg->create_reply();
+            retmsg << it->second;
+            reply = retmsg;
+        }
+    } else if( msg->member() == "Set" ) {
+        std::string propertyName;
+        Variant value;
+
+        msg >> interfaceName >> propertyName >> value;
+
+        if( !m_priv->m_propertySetter ) {
+            reply = ErrorMessage::create( msg, DBUSCXX_ERROR_PROPERTY_READ_ONLY,
+                    "Property " + propertyName + " on interface " + interfaceName + " is read-only" );
+        } else {
+            Result<void> result = m_priv->m_propertySetter( object_path, interfaceName, propertyName, value );
+
+            if( result ) {
+                reply = msg->create_reply();
+            } else {
+                reply = ErrorMessage::create( msg, result.error().name(), result.error().message() );
+            }
+        }
+    } else {
+        return HandlerResult::Invalid_Method;
+    }
+
+    conn << reply;
+    return HandlerResult::Handled;
+}
+
+} /* namespace DBus */
@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#ifndef DBUSCXX_VIRTUALOBJECTTREE_H
+#define DBUSCXX_VIRTUALOBJECTTREE_H
+
+#include <dbus-cxx/dbus-cxx-config.h>
+#include <dbus-cxx/object.h>
+#include <dbus-cxx/path.h>
+#include <dbus-cxx/result.h>
+#include <dbus-cxx/variant.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace DBus {
+
+class CallMessage;
+class Connection;
+
+/**
+ * A single object that stands in for a whole tree of objects which only
+ * exist in the application's own data.
+ *
+ * Nothing is kept for each path in the tree.  The application provides an
+ * enumerator, which lists the children of a path, and a handler, which
+ * handles method calls to any path in the tree.  Introspection and the
+ * Properties interface are answered on demand from further callbacks, so
+ * the memory used is the same no matter how many objects there are.
+ *
+ * Register the tree with Connection::register_fallback(), so that it gets
+ * the calls for every path below its own.
+ *
+ * @ingroup local
+ * @ingroup objects
+ */
+class VirtualObjectTree : public Object {
+public:
+    /**
+     * Returns the names of the children of the given path.
+     */
+    typedef std::function<std::vector<std::string>( const Path& )> Enumerator;
+
+    /**
+     * Returns true if there is an object at the given path.
+     */
+    typedef std::function<bool( const Path& )> ExistenceCheck;
+
+    /**
+     * Handles a method call to an object in the tree.  The path that was
+     * called is CallMessage::path().
+     */
+    typedef std::function<HandlerResult( std::shared_ptr<Connection>, std::shared_ptr<const CallMessage> )> Handler;
+
+    /**
+     * Returns the introspection XML of the interfaces of the object at the
+     * given path; the \<interface\> elements only.
+     */
+    typedef std::function<std::string( const Path& )> Describer;
+
+    /**
+     * Returns the properties of the given interface of the object at the
+     * given path.
+     */
+    typedef std::function<std::map<std::string, Variant>( const Path&, const std::string& )> PropertyGetter;
+
+    /**
+     * Sets a property of the object at the given path.  The arguments are
+     * the path, the interface name, the property name and the new value.
+     */
+    typedef std::function<Result<void>( const Path&, const std::string&, const std::string&, const Variant& )> PropertySetter;
+
+private:
+    VirtualObjectTree( const std::string& path, Enumerator enumerator, Handler handler );
+
+public:
+    static std::shared_ptr<VirtualObjectTree> create( const std::string& path, Enumerator enumerator, Handler handler );
+
+    ~VirtualObjectTree();
+
+    /**
+     * Set how to check if there is an object at a path.  By default, a path
+     * exists if it is the root of the tree, or if the enumerator lists it as
+     * a child of its parent.  Setting a direct check is much faster when
+     * an object has many children.
+     */
+    void set_existence_check( ExistenceCheck check );
+
+    void set_describer( Describer describer );
+
+    void set_property_getter( PropertyGetter getter );
+
+    /**
+     * Set how properties are set.  If there is no setter, all properties
+     * are read-only.
+     */
+    void set_property_setter( PropertySetter setter );
+
+    /**
+     * Check if there is an object at the given path in this tree.
+     */
+    bool exists( const Path& path ) const;
+
+    /**
+     * The introspection XML for the object at the given path.
+     */
+    std::string introspect_path( const Path& path ) const;
+
+    virtual HandlerResult handle_message( std::shared_ptr<const Message> msg );
+
+private:
+    HandlerResult handle_properties_message( std::shared_ptr<Connection> conn, std::shared_ptr<const CallMessage> msg );
+
+private:
+    class priv_data;
+
+    DBUS_CXX_PROPAGATE_CONST( std::unique_ptr<priv_data> ) m_priv;
+};
+
+} /* namespace DBus */
+
+#endif /* DBUSCXX_VIRTUALOBJECTTREE_H */
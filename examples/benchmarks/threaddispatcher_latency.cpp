@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#include <dbus-cxx.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * This benchmark measures how long it takes for a signal to be handed from
+ * the dispatcher thread to a thread that owns a ThreadDispatcher.
+ *
+ * No bus is needed: a producer thread plays the part of the dispatcher
+ * thread and calls add_signal() directly.  Each signal carries the time
+ * that it was queued, and the handler on the owning thread records how
+ * long the handoff took.
+ *
+ * The StandaloneThreadDispatcher is compared against a dispatcher that
+ * locks a mutex and notifies the owning thread for every message, which is
+ * how the Qt dispatcher works.
+ *
+ * Usage: threaddispatcher-latency [number of signals]
+ */
+
+typedef std::chrono::steady_clock Clock;
+
+static std::vector<int64_t> latencies_ns;
+
+static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now().time_since_epoch() ).count();
+}
+
+static void signal_received( int64_t sent_ns ) {
+    latencies_ns.push_back( now_ns() - sent_ns );
+}
+
+/**
+ * Baseline: one mutex-protected queue, one notification per message.
+ */
+class LockingThreadDispatcher : public DBus::ThreadDispatcher {
+public:
+    void add_message( std::shared_ptr<DBus::Object>, std::shared_ptr<const DBus::CallMessage> ) {}
+
+    void add_signal_proxy( std::shared_ptr<DBus::SignalProxyBase> handler ) {
+        std::unique_lock<std::mutex> lock( m_lock );
+        m_handlers.push_back( handler );
+    }
+
+    bool remove_signal_proxy( std::shared_ptr<DBus::SignalProxyBase> ) {
+        return false;
+    }
+
+    void add_signal( std::shared_ptr<const DBus::SignalMessage> message ) {
+        std::unique_lock<std::mutex> lock( m_lock );
+        m_signals.push_back( message );
+        m_cv.notify_one();
+    }
+
+    int process( size_t wanted ) {
+        size_t processed = 0;
+
+        while( processed < wanted ) {
+            std::unique_lock<std::mutex> lock( m_lock );
+            m_cv.wait( lock, [this] { return !m_signals.empty(); } );
+
+            while( !m_signals.empty() ) {
+                std::shared_ptr<const DBus::SignalMessage> msg = m_signals.front();
+                m_signals.pop_front();
+
+                for( std::shared_ptr<DBus::SignalProxyBase> proxy : m_handlers ) {
+                    proxy->handle_signal( msg );
+                }
+
+                processed++;
+            }
+        }
+
+        return processed;
+    }
+
+private:
+    std::mutex m_lock;
+    std::condition_variable m_cv;
+    std::deque<std::shared_ptr<const DBus::SignalMessage>> m_signals;
+    std::vector<std::shared_ptr<DBus::SignalProxyBase>> m_handlers;
+};
+
+static std::shared_ptr<DBus::SignalProxy<void(int64_t)>> create_proxy() {
+    std::shared_ptr<DBus::SignalProxy<void(int64_t)>> proxy =
+        DBus::SignalProxy<void(int64_t)>::create(
+            DBus::MatchRuleBuilder::create()
+            .set_path( "/dbuscxx/benchmark" )
+            .set_interface( "dbuscxx.benchmark" )
+            .set_member( "Latency" )
+            .as_signal_match() );
+    proxy->connect( sigc::ptr_fun( signal_received ) );
+    return proxy;
+}
+
+static void produce( DBus::ThreadDispatcher* disp, int count ) {
+    for( int x = 0; x < count; x++ ) {
+        std::shared_ptr<DBus::SignalMessage> msg =
+            DBus::SignalMessage::create( "/dbuscxx/benchmark", "dbuscxx.benchmark", "Latency" );
+        msg << now_ns();
+        disp->add_signal( msg );
+
+        /* Pace the signals so that we measure latency, not queue depth */
+        std::this_thread::sleep_for( std::chrono::microseconds( 20 ) );
+    }
+}
+
+static void report( const char* name, std::chrono::nanoseconds total ) {
+    std::sort( latencies_ns.begin(), latencies_ns.end() );
+
+    size_t count = latencies_ns.size();
+
+    if( count == 0 ) {
+        std::cout << name << ": no signals received" << std::endl;
+        return;
+    }
+
+    std::cout << name << ": " << count << " signals in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>( total ).count() << " ms" << std::endl
+              << "    p50 " << latencies_ns[ count / 2 ] / 1000.0 << " us"
+              << "  p99 " << latencies_ns[ ( count * 99 ) / 100 ] / 1000.0 << " us"
+              << "  max " << latencies_ns[ count - 1 ] / 1000.0 << " us" << std::endl;
+}
+
+int main( int argc, char** argv ) {
+    int count = 100000;
+
+    if( argc > 1 ) {
+        count = std::atoi( argv[ 1 ] );
+    }
+
+    latencies_ns.reserve( count );
+
+    {
+        std::shared_ptr<LockingThreadDispatcher> disp = std::make_shared<LockingThreadDispatcher>();
+        disp->add_signal_proxy( create_proxy() );
+
+        Clock::time_point start = Clock::now();
+        std::thread producer( produce, disp.get(), count );
+        disp->process( count );
+        producer.join();
+
+        report( "mutex + notify per message", Clock::now() - start );
+    }
+
+    latencies_ns.clear();
+
+    {
+        std::shared_ptr<DBus::StandaloneThreadDispatcher> disp = DBus::StandaloneThreadDispatcher::create();
+        disp->add_signal_proxy( create_proxy() );
+
+        Clock::time_point start = Clock::now();
+        std::thread producer( produce, disp.get(), count );
+        int processed = 0;
+
+        while( processed < count ) {
+            processed += disp->poll_once( -1 );
+        }
+
+        producer.join();
+
+        report( "StandaloneThreadDispatcher", Clock::now() - start );
+    }
+
+    return 0;
+}
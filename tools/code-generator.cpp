@@ -75,6 +75,8 @@ void CodeGenerator::start_element( std::string tagName, std::map<std::string,std
         handle_arg_tag( parentElement, tagAttrs );
     }else if( tagName.compare( "property" ) == 0 ){
         handle_property_tag( tagAttrs );
+    }else if( tagName.compare( "annotation" ) == 0 ){
+        handle_annotation_tag( parentElement, tagAttrs );
     }
 }
 
@@ -310,6 +312,16 @@ void CodeGenerator::generateProxyMethods( cppgenerate::Class *cls, cppgenerate::
             .addLine( "m_method_" + i.name() +
                       " = this->create_method" + methodProxyType +
                       "(\"" + newMethod.name() + "\");" ) );
+
+        if( i.noReply() ){
+            if( i.returnType() == "void" ){
+                constructor->addCode( cppgenerate::CodeBlock::create()
+                    .addLine( "m_method_" + i.name() + "->set_no_reply( true );" ) );
+            }else{
+                std::cerr << "WARNING: Method " << i.name()
+                          << " is annotated as NoReply but returns a value; ignoring annotation\n";
+            }
+        }
     }
 }
 
@@ -845,6 +857,13 @@ void CodeGenerator::handle_arg_tag( std::string parentElement, std::map<std::str
     m_argNum++;
 }
 
+void CodeGenerator::handle_annotation_tag( std::string parentElement, std::map<std::string,std::string>& tagAttrs ){
+    if( parentElement == "method" &&
+        tagAttrs[ "name" ] == "org.freedesktop.DBus.Method.NoReply" ){
+        m_currentMethodInfo.setNoReply( tagAttrs[ "value" ] == "true" );
+    }
+}
+
 void CodeGenerator::handle_property_tag( std::map<std::string, std::string> &tagAttrs ){
     std::string propertyName;
     std::string propertyType;
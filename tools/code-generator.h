@@ -44,6 +44,7 @@ private:
     void handle_signal_tag( std::map<std::string,std::string>& tagAttrs );
     void handle_arg_tag( std::string parentElement, std::map<std::string,std::string>& tagAttrs );
     void handle_property_tag( std::map<std::string,std::string>& tagAttrs );
+    void handle_annotation_tag( std::string parentElement, std::map<std::string,std::string>& tagAttrs );
 
     static void start_element_handler(void* user_data, const XML_Char* name, const XML_Char** attrs );
     static void end_element_handler( void* userData, const XML_Char* name );
@@ -8,10 +8,13 @@
 #include <sstream>
 #include <iterator>
 
-MethodInfo::MethodInfo(){}
+MethodInfo::MethodInfo() :
+    m_noReply( false )
+{}
 
 MethodInfo::MethodInfo( std::string name ) :
-    m_name( name )
+    m_name( name ),
+    m_noReply( false )
 {}
 
 void MethodInfo::addArgument( cppgenerate::Argument arg ){
@@ -64,3 +67,11 @@ void MethodInfo::addIncludes( std::vector<std::string> includes ){
 std::vector<std::string> MethodInfo::includes() const{
     return m_includes;
 }
+
+bool MethodInfo::noReply() const{
+    return m_noReply;
+}
+
+void MethodInfo::setNoReply( bool noReply ){
+    m_noReply = noReply;
+}
@@ -39,12 +39,21 @@ public:
 
         std::vector<std::string> includes() const;
 
+        /**
+         * True if the method has the org.freedesktop.DBus.Method.NoReply
+         * annotation, so callers should not wait for a reply.
+         */
+        bool noReply() const;
+
+        void setNoReply( bool noReply );
+
 private:
         std::string m_name;
         std::vector<cppgenerate::Argument> m_arguments;
         std::vector<std::string> m_returnType;
         std::string m_returnArgName;
         std::vector<std::string> m_includes;
+        bool m_noReply;
 };
 
 #endif
@@ -232,6 +232,126 @@ bool affinity_message_change_thread() {
     return dispatcherThreadOk && mainThreadOk;
 }
 
+bool affinity_signal_only_matching_thread() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    std::shared_ptr<AffinityThreadDispatcher> afDisp = std::shared_ptr<AffinityThreadDispatcher>( new AffinityThreadDispatcher );
+    conn->add_thread_dispatcher( afDisp );
+
+    std::shared_ptr<DBus::SignalProxy<void()>> proxy = conn->create_free_signal_proxy<void()>(
+                DBus::MatchRuleBuilder::create()
+                .set_interface( "interface.name" )
+                .set_member( "myname" )
+                .as_signal_match(),
+                DBus::ThreadForCalling::CurrentThread );
+
+    proxy->connect( sigc::ptr_fun( receiveSignal ) );
+
+    std::shared_ptr<DBus::Signal<void()>> otherSignal = conn->create_free_signal<void()>( "/", "interface.name", "othername" );
+    std::shared_ptr<DBus::Signal<void()>> signal = conn->create_free_signal<void()>( "/", "interface.name", "myname" );
+
+    otherSignal->emit();
+    signal->emit();
+
+    std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+
+    // Only the signal that matches our proxy should have been queued on this thread
+    if( afDisp->m_signalMessages.size() != 1 ) {
+        return false;
+    }
+
+    afDisp->processMessages();
+
+    if( rxSignal && ( mainThreadId == rxThread ) ) {
+        return true;
+    }
+
+    return false;
+}
+
+bool affinity_signal_standalone_thread_dispatcher() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    std::shared_ptr<DBus::StandaloneThreadDispatcher> threadDisp = DBus::StandaloneThreadDispatcher::create();
+    conn->add_thread_dispatcher( threadDisp );
+
+    std::shared_ptr<DBus::SignalProxy<void()>> proxy = conn->create_free_signal_proxy<void()>(
+                DBus::MatchRuleBuilder::create()
+                .set_interface( "interface.name" )
+                .set_member( "myname" )
+                .as_signal_match(),
+                DBus::ThreadForCalling::CurrentThread );
+
+    proxy->connect( sigc::ptr_fun( receiveSignal ) );
+
+    std::shared_ptr<DBus::Signal<void()>> signal = conn->create_free_signal<void()>( "/", "interface.name", "myname" );
+
+    signal->emit();
+
+    for( int x = 0; x < 10 && !rxSignal; x++ ) {
+        threadDisp->poll_once( 100 );
+    }
+
+    if( rxSignal && ( mainThreadId == rxThread ) ) {
+        return true;
+    }
+
+    return false;
+}
+
+bool affinity_message_standalone_thread_dispatcher() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    std::shared_ptr<DBus::StandaloneThreadDispatcher> threadDisp = DBus::StandaloneThreadDispatcher::create();
+    conn->add_thread_dispatcher( threadDisp );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test", DBus::ThreadForCalling::CurrentThread );
+
+    object->create_method<void()>( "test.for.dbuscxx", "rxMethod", sigc::ptr_fun( receiveMethodCall ) );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/test" );
+    std::shared_ptr<DBus::MethodProxy<void()>> remoteMethod =
+            remote->create_method<void()>( "test.for.dbuscxx", "rxMethod" );
+
+    std::future<void> result = remoteMethod->call_async();
+
+    for( int x = 0; x < 10 && !rxMessage; x++ ) {
+        threadDisp->poll_once( 100 );
+    }
+
+    result.wait();
+
+    if( rxMessage && ( mainThreadId == rxThread ) ) {
+        return true;
+    }
+
+    return false;
+}
+
+bool affinity_owner_changed_standalone_thread_dispatcher() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    std::shared_ptr<DBus::Connection> owner = dispatch->create_connection( DBus::BusType::SESSION );
+    std::shared_ptr<DBus::StandaloneThreadDispatcher> threadDisp = DBus::StandaloneThreadDispatcher::create();
+    conn->add_thread_dispatcher( threadDisp );
+
+    std::shared_ptr<DBus::ObjectProxy> remote =
+        conn->create_object_proxy( "dbuscxx.affinity", "/test", DBus::ThreadForCalling::CurrentThread );
+
+    remote->signal_owner_changed().connect( []( std::string, std::string ) {
+        receiveSignal();
+    } );
+
+    owner->request_name( "dbuscxx.affinity" );
+
+    for( int x = 0; x < 10 && !rxSignal; x++ ) {
+        threadDisp->poll_once( 100 );
+    }
+
+    if( rxSignal && ( mainThreadId == rxThread ) ) {
+        return true;
+    }
+
+    return false;
+}
+
 #define ADD_TEST(name) do{ if( test_name == STRINGIFY(name) ){ \
             ret = affinity_##name();\
         } \
@@ -256,6 +376,10 @@ int main( int argc, char** argv ) {
     ADD_TEST( message_dispatch_thread );
     ADD_TEST( message_main_thread );
     ADD_TEST( message_change_thread );
+    ADD_TEST( signal_only_matching_thread );
+    ADD_TEST( signal_standalone_thread_dispatcher );
+    ADD_TEST( message_standalone_thread_dispatcher );
+    ADD_TEST( owner_changed_standalone_thread_dispatcher );
 
     return !ret;
 }
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later OR BSD-3-Clause
+/***************************************************************************
+ *   Copyright (C) 2020 by Robert Middleton                                *
+ *   robert.middleton@rm5248.com                                           *
+ *                                                                         *
+ *   This file is part of the dbus-cxx library.                            *
+ ***************************************************************************/
+#include <dbus-cxx.h>
+#include <future>
+#include <thread>
+
+#include "test_macros.h"
+
+static std::shared_ptr<DBus::Dispatcher> dispatch;
+
+static double add_method( double a, double b ) {
+    return a + b;
+}
+
+/**
+ * Wait for a task to finish from a thread that is not running the task.
+ */
+template <typename T>
+static T wait_for( DBus::Task<T> task ) {
+    std::shared_ptr<std::promise<void>> finished = std::make_shared<std::promise<void>>();
+    std::future<void> result = finished->get_future();
+
+    task.then( [finished]() { finished->set_value(); } );
+    result.wait();
+
+    return task.result();
+}
+
+static std::shared_ptr<DBus::Connection> create_server() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test", DBus::ThreadForCalling::DispatcherThread );
+    object->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+
+    return conn;
+}
+
+static DBus::Task<double> add_three( std::shared_ptr<DBus::MethodProxy<double( double, double )>> proxy,
+                                     double a, double b, double c ) {
+    double first = co_await DBus::co_call( proxy, a, b );
+    double second = co_await DBus::co_call( proxy, first, c );
+    co_return second;
+}
+
+bool coroutine_call() {
+    std::shared_ptr<DBus::Connection> conn = create_server();
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/test" );
+    std::shared_ptr<DBus::MethodProxy<double( double, double )>> remoteMethod =
+            remote->create_method<double( double, double )>( "test.for.dbuscxx", "add" );
+
+    TEST_ASSERT_RET_FAIL( wait_for( add_three( remoteMethod, 1, 2, 3 ) ) == 6 );
+    return true;
+}
+
+static DBus::Task<bool> call_missing( std::shared_ptr<DBus::MethodProxy<double( double, double )>> proxy ) {
+    try {
+        co_await DBus::co_call( proxy, 1, 2 );
+    } catch( DBus::Error& err ) {
+        co_return true;
+    }
+
+    co_return false;
+}
+
+bool coroutine_call_error() {
+    std::shared_ptr<DBus::Connection> conn = create_server();
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/test" );
+    std::shared_ptr<DBus::MethodProxy<double( double, double )>> remoteMethod =
+            remote->create_method<double( double, double )>( "test.for.dbuscxx", "doesNotExist" );
+
+    TEST_ASSERT_RET_FAIL( wait_for( call_missing( remoteMethod ) ) );
+    return true;
+}
+
+static std::shared_ptr<DBus::MethodProxy<double( double, double )>> backend;
+
+/* A server method that calls out to another method before replying */
+static DBus::Task<double> add_four( double a, double b ) {
+    double first = co_await DBus::co_call( backend, a, b );
+    double second = co_await DBus::co_call( backend, a, b );
+    co_return first + second;
+}
+
+bool coroutine_method() {
+    std::shared_ptr<DBus::Connection> conn = create_server();
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test/coroutine", DBus::ThreadForCalling::DispatcherThread );
+    object->create_method<DBus::Task<double>( double, double )>( "test.for.dbuscxx", "addTwice", sigc::ptr_fun( add_four ) );
+
+    std::shared_ptr<DBus::ObjectProxy> backendProxy = conn->create_object_proxy( "dbuscxx.test", "/test" );
+    backend = backendProxy->create_method<double( double, double )>( "test.for.dbuscxx", "add" );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/test/coroutine" );
+    std::shared_ptr<DBus::MethodProxy<double( double, double )>> remoteMethod =
+            remote->create_method<double( double, double )>( "test.for.dbuscxx", "addTwice" );
+
+    TEST_ASSERT_RET_FAIL( ( *remoteMethod )( 1, 2 ) == 6 );
+    return true;
+}
+
+static DBus::Task<std::thread::id> resume_elsewhere( std::shared_ptr<DBus::MethodProxy<double( double, double )>> proxy,
+                                                     std::shared_ptr<DBus::StandaloneThreadDispatcher> disp ) {
+    co_await DBus::co_call( proxy, 1, 2 ).resume_on( DBus::executor_for( disp ) );
+    co_return std::this_thread::get_id();
+}
+
+bool coroutine_resume_on() {
+    std::shared_ptr<DBus::Connection> conn = create_server();
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/test" );
+    std::shared_ptr<DBus::MethodProxy<double( double, double )>> remoteMethod =
+            remote->create_method<double( double, double )>( "test.for.dbuscxx", "add" );
+
+    std::shared_ptr<DBus::StandaloneThreadDispatcher> disp = DBus::StandaloneThreadDispatcher::create();
+    std::thread::id workerId;
+    std::thread worker( [disp, &workerId]() {
+        workerId = std::this_thread::get_id();
+        disp->run();
+    } );
+
+    std::thread::id resumedOn = wait_for( resume_elsewhere( remoteMethod, disp ) );
+
+    disp->stop();
+    worker.join();
+
+    TEST_ASSERT_RET_FAIL( resumedOn == workerId );
+    return true;
+}
+
+#define ADD_TEST(name) do{ if( test_name == STRINGIFY(name) ){ \
+            ret = coroutine_##name();\
+        } \
+    } while( 0 )
+
+int main( int argc, char** argv ) {
+    if( argc < 1 ) {
+        return 1;
+    }
+
+    std::string test_name = argv[1];
+    bool ret = false;
+
+    dispatch = DBus::StandaloneDispatcher::create();
+
+    ADD_TEST( call );
+    ADD_TEST( call_error );
+    ADD_TEST( method );
+    ADD_TEST( resume_on );
+
+    return !ret;
+}
@@ -19,6 +19,11 @@
  *   along with this software. If not see <http://www.gnu.org/licenses/>.  *
  ***************************************************************************/
 #include <dbus-cxx.h>
+#include <dbus-cxx/standard-interfaces/objectmanagerproxy.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
 
 #include "test_macros.h"
 
@@ -28,6 +33,10 @@ double example_method( double, double ) {
     return 0.0;
 }
 
+double add_method( double a, double b ) {
+    return a + b;
+}
+
 bool object_proxy_create() {
     std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
 
@@ -55,6 +64,943 @@ bool object_export_method() {
     return true;
 }
 
+bool object_call_async() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test", DBus::ThreadForCalling::DispatcherThread );
+    object->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/test" );
+    std::shared_ptr<DBus::MethodProxy<double( double, double )>> remoteMethod =
+            remote->create_method<double( double, double )>( "test.for.dbuscxx", "add" );
+
+    // All of the calls are outstanding at once, without a thread for each one
+    std::vector<std::future<double>> results;
+
+    for( int x = 0; x < 500; x++ ) {
+        results.push_back( remoteMethod->call_async( x, 1 ) );
+    }
+
+    for( int x = 0; x < 500; x++ ) {
+        TEST_ASSERT_RET_FAIL( results[ x ].get() == x + 1 );
+    }
+
+    return true;
+}
+
+bool object_call_async_error() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test", DBus::ThreadForCalling::DispatcherThread );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/test" );
+    std::shared_ptr<DBus::MethodProxy<double( double, double )>> remoteMethod =
+            remote->create_method<double( double, double )>( "test.for.dbuscxx", "doesNotExist" );
+
+    std::future<double> result = remoteMethod->call_async( 1, 2 );
+
+    try {
+        result.get();
+    } catch( DBus::Error& err ) {
+        return true;
+    }
+
+    return false;
+}
+
+bool object_pending_call() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test", DBus::ThreadForCalling::DispatcherThread );
+    object->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+
+    std::shared_ptr<DBus::CallMessage> msg = DBus::CallMessage::create( "dbuscxx.test", "/test", "test.for.dbuscxx", "add" );
+    msg << 2.0 << 3.0;
+
+    std::shared_ptr<DBus::PendingCall> pending = conn->send_with_reply_async( msg );
+    TEST_ASSERT_RET_FAIL( pending );
+
+    pending->block();
+    TEST_ASSERT_RET_FAIL( pending->completed() );
+    TEST_ASSERT_RET_FAIL( pending->reply()->type() == DBus::MessageType::RETURN );
+
+    double value = 0;
+    std::shared_ptr<const DBus::Message>( pending->reply() ) >> value;
+    TEST_ASSERT_RET_FAIL( value == 5.0 );
+
+    return true;
+}
+
+bool object_call_async_timeout() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    // Nothing ever processes this dispatcher, so the method never replies
+    std::shared_ptr<DBus::StandaloneThreadDispatcher> stalled = DBus::StandaloneThreadDispatcher::create();
+    conn->add_thread_dispatcher( stalled );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test", DBus::ThreadForCalling::CurrentThread );
+    object->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+
+    std::shared_ptr<DBus::CallMessage> shortCall = DBus::CallMessage::create( "dbuscxx.test", "/test", "test.for.dbuscxx", "add" );
+    shortCall << 2.0 << 3.0;
+    std::shared_ptr<DBus::CallMessage> longCall = DBus::CallMessage::create( "dbuscxx.test", "/test", "test.for.dbuscxx", "add" );
+    longCall << 2.0 << 3.0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::shared_ptr<DBus::PendingCall> longPending = conn->send_with_reply_async( longCall, 10000 );
+    std::shared_ptr<DBus::PendingCall> shortPending = conn->send_with_reply_async( shortCall, 200 );
+
+    shortPending->block();
+    std::chrono::steady_clock::duration waited = std::chrono::steady_clock::now() - start;
+
+    TEST_ASSERT_RET_FAIL( waited >= std::chrono::milliseconds( 200 ) );
+    TEST_ASSERT_RET_FAIL( waited < std::chrono::seconds( 5 ) );
+    TEST_ASSERT_RET_FAIL( std::static_pointer_cast<DBus::ErrorMessage>( shortPending->reply() )->name() == DBUSCXX_ERROR_NO_REPLY );
+    TEST_ASSERT_RET_FAIL( !longPending->completed() );
+
+    return true;
+}
+
+bool object_concurrent_calls() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test", DBus::ThreadForCalling::DispatcherThread );
+    object->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/test" );
+    std::shared_ptr<DBus::MethodProxy<double( double, double )>> remoteMethod =
+            remote->create_method<double( double, double )>( "test.for.dbuscxx", "add" );
+
+    std::atomic<int> wrong( 0 );
+    std::vector<std::thread> threads;
+
+    for( int t = 0; t < 8; t++ ) {
+        threads.push_back( std::thread( [remoteMethod, t, &wrong]() {
+            for( int x = 0; x < 200; x++ ) {
+                if( ( *remoteMethod )( t, x ) != t + x ) {
+                    wrong++;
+                }
+            }
+        } ) );
+    }
+
+    for( std::thread& thr : threads ) {
+        thr.join();
+    }
+
+    TEST_ASSERT_RET_FAIL( wrong == 0 );
+
+    return true;
+}
+
+bool object_call_timeout() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    // Nothing ever processes this dispatcher, so the method never replies
+    std::shared_ptr<DBus::StandaloneThreadDispatcher> stalled = DBus::StandaloneThreadDispatcher::create();
+    conn->add_thread_dispatcher( stalled );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test", DBus::ThreadForCalling::CurrentThread );
+    object->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+
+    std::shared_ptr<DBus::CallMessage> msg = DBus::CallMessage::create( "dbuscxx.test", "/test", "test.for.dbuscxx", "add" );
+    msg << 2.0 << 3.0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool timedOut = false;
+
+    try {
+        conn->send_with_reply_blocking( msg, 200 );
+    } catch( DBus::ErrorNoReply& err ) {
+        timedOut = true;
+    }
+
+    std::chrono::steady_clock::duration waited = std::chrono::steady_clock::now() - start;
+
+    TEST_ASSERT_RET_FAIL( timedOut );
+    TEST_ASSERT_RET_FAIL( waited >= std::chrono::milliseconds( 200 ) );
+    TEST_ASSERT_RET_FAIL( waited < std::chrono::seconds( 5 ) );
+
+    return true;
+}
+
+bool object_call_batch() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test", DBus::ThreadForCalling::DispatcherThread );
+    object->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/test" );
+    std::vector<std::shared_ptr<const DBus::CallMessage>> calls;
+
+    for( int x = 0; x < 50; x++ ) {
+        std::shared_ptr<DBus::CallMessage> msg = remote->create_call_message( "test.for.dbuscxx", x == 25 ? "doesNotExist" : "add" );
+        msg << static_cast<double>( x ) << 1.0;
+        calls.push_back( msg );
+    }
+
+    std::vector<std::shared_ptr<DBus::Message>> replies = remote->call_batch( calls );
+    TEST_ASSERT_RET_FAIL( replies.size() == 50 );
+
+    for( int x = 0; x < 50; x++ ) {
+        if( x == 25 ) {
+            TEST_ASSERT_RET_FAIL( replies[ x ]->type() == DBus::MessageType::ERROR );
+            continue;
+        }
+
+        TEST_ASSERT_RET_FAIL( replies[ x ]->type() == DBus::MessageType::RETURN );
+
+        double value = 0;
+        std::shared_ptr<const DBus::Message>( replies[ x ] ) >> value;
+        TEST_ASSERT_RET_FAIL( value == x + 1 );
+    }
+
+    return true;
+}
+
+bool object_call_batch_timeout() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    // Nothing ever processes this dispatcher, so the slow method never replies
+    std::shared_ptr<DBus::StandaloneThreadDispatcher> stalled = DBus::StandaloneThreadDispatcher::create();
+    conn->add_thread_dispatcher( stalled );
+
+    std::shared_ptr<DBus::Object> slow = conn->create_object( "/test/slow", DBus::ThreadForCalling::CurrentThread );
+    slow->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+    std::shared_ptr<DBus::Object> fast = conn->create_object( "/test/fast", DBus::ThreadForCalling::DispatcherThread );
+    fast->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+
+    std::vector<std::shared_ptr<const DBus::CallMessage>> calls;
+    std::shared_ptr<DBus::CallMessage> slowCall = DBus::CallMessage::create( "dbuscxx.test", "/test/slow", "test.for.dbuscxx", "add" );
+    slowCall << 2.0 << 3.0;
+    calls.push_back( slowCall );
+    std::shared_ptr<DBus::CallMessage> fastCall = DBus::CallMessage::create( "dbuscxx.test", "/test/fast", "test.for.dbuscxx", "add" );
+    fastCall << 2.0 << 3.0;
+    calls.push_back( fastCall );
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<DBus::Message>> replies = conn->send_with_reply_batch( calls, 300 );
+    std::chrono::steady_clock::duration waited = std::chrono::steady_clock::now() - start;
+
+    TEST_ASSERT_RET_FAIL( waited < std::chrono::seconds( 5 ) );
+    TEST_ASSERT_RET_FAIL( replies[ 0 ]->type() == DBus::MessageType::ERROR );
+    TEST_ASSERT_RET_FAIL( std::static_pointer_cast<DBus::ErrorMessage>( replies[ 0 ] )->name() == DBUSCXX_ERROR_NO_REPLY );
+    TEST_ASSERT_RET_FAIL( replies[ 1 ]->type() == DBus::MessageType::RETURN );
+
+    return true;
+}
+
+static std::atomic<int> recorded( 0 );
+
+static void record_method( int value ) {
+    recorded = value;
+}
+
+bool object_no_reply() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test", DBus::ThreadForCalling::DispatcherThread );
+    object->create_method<void( int )>( "test.for.dbuscxx", "record", sigc::ptr_fun( record_method ) );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/test" );
+    std::shared_ptr<DBus::MethodProxy<void( int )>> remoteMethod =
+            remote->create_method<void( int )>( "test.for.dbuscxx", "record" );
+    remoteMethod->set_no_reply();
+
+    ( *remoteMethod )( 42 );
+
+    for( int x = 0; x < 100 && recorded != 42; x++ ) {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+    }
+
+    TEST_ASSERT_RET_FAIL( recorded == 42 );
+
+    std::shared_ptr<DBus::CallMessage> msg = DBus::CallMessage::create( "dbuscxx.test", "/test", "test.for.dbuscxx", "record" );
+    msg << 7;
+    TEST_ASSERT_RET_FAIL( msg->expects_reply() );
+    msg->set_no_reply();
+    TEST_ASSERT_RET_FAIL( !msg->expects_reply() );
+    TEST_ASSERT_RET_FAIL( !conn->send_with_reply_blocking( msg ) );
+
+    return true;
+}
+
+bool object_try_call() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test", DBus::ThreadForCalling::DispatcherThread );
+    object->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/test" );
+    std::shared_ptr<DBus::MethodProxy<double( double, double )>> remoteMethod =
+            remote->create_method<double( double, double )>( "test.for.dbuscxx", "add" );
+    std::shared_ptr<DBus::MethodProxy<double( double, double )>> missingMethod =
+            remote->create_method<double( double, double )>( "test.for.dbuscxx", "doesNotExist" );
+
+    DBus::Result<double> result = remoteMethod->try_call( 2, 3 );
+    TEST_ASSERT_RET_FAIL( result.has_value() );
+    TEST_ASSERT_RET_FAIL( result.value() == 5 );
+
+    DBus::Result<double> missing = missingMethod->try_call( 2, 3 );
+    TEST_ASSERT_RET_FAIL( !missing );
+    TEST_ASSERT_RET_FAIL( missing.error().name() == DBUSCXX_ERROR_UNKNOWN_METHOD );
+    TEST_ASSERT_RET_FAIL( missing.value_or( -1 ) == -1 );
+
+    // value() throws the same typed error as a throwing call would
+    bool typed = false;
+
+    try {
+        missing.value();
+    } catch( DBus::ErrorUnknownMethod& ) {
+        typed = true;
+    }
+
+    TEST_ASSERT_RET_FAIL( typed );
+
+    return true;
+}
+
+static DBus::Result<int> checked_divide( int a, int b ) {
+    if( b == 0 ) {
+        return DBus::Error( DBUSCXX_ERROR_INVALID_ARGS, "Division by zero" );
+    }
+
+    return a / b;
+}
+
+static DBus::Result<int> throws_non_exception( int ) {
+    throw 42;
+}
+
+bool object_result_method() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test", DBus::ThreadForCalling::DispatcherThread );
+    object->create_method<DBus::Result<int>( int, int )>( "test.for.dbuscxx", "divide", sigc::ptr_fun( checked_divide ) );
+    object->create_method<DBus::Result<int>( int )>( "test.for.dbuscxx", "throws", sigc::ptr_fun( throws_non_exception ) );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/test" );
+    std::shared_ptr<DBus::MethodProxy<int( int, int )>> remoteMethod =
+            remote->create_method<int( int, int )>( "test.for.dbuscxx", "divide" );
+
+    TEST_ASSERT_RET_FAIL( ( *remoteMethod )( 10, 2 ) == 5 );
+
+    DBus::Result<int> result = remoteMethod->try_call( 10, 0 );
+    TEST_ASSERT_RET_FAIL( !result );
+    TEST_ASSERT_RET_FAIL( result.error().name() == DBUSCXX_ERROR_INVALID_ARGS );
+    TEST_ASSERT_RET_FAIL( result.error().message() == "Division by zero" );
+
+    // Anything thrown from the method is still sent back as an error
+    std::shared_ptr<DBus::MethodProxy<int( int )>> throwingMethod =
+            remote->create_method<int( int )>( "test.for.dbuscxx", "throws" );
+    DBus::Result<int> thrown = throwingMethod->try_call( 1 );
+    TEST_ASSERT_RET_FAIL( !thrown );
+    TEST_ASSERT_RET_FAIL( thrown.error().name() == DBUSCXX_ERROR_FAILED );
+
+    try {
+        ( *remoteMethod )( 10, 0 );
+    } catch( DBus::ErrorInvalidArgs& err ) {
+        return true;
+    }
+
+    return false;
+}
+
+bool object_bad_signature() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test", DBus::ThreadForCalling::DispatcherThread );
+    object->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+
+    std::shared_ptr<DBus::CallMessage> msg = DBus::CallMessage::create( "dbuscxx.test", "/test", "test.for.dbuscxx", "add" );
+    msg << std::string( "two" ) << 3.0;
+
+    std::shared_ptr<DBus::Message> reply = conn->send_with_reply_nothrow( msg );
+    TEST_ASSERT_RET_FAIL( reply );
+    TEST_ASSERT_RET_FAIL( reply->type() == DBus::MessageType::ERROR );
+    TEST_ASSERT_RET_FAIL( std::static_pointer_cast<DBus::ErrorMessage>( reply )->name() == DBUSCXX_ERROR_INVALID_SIGNATURE );
+
+    // Numeric types are converted, so these are still accepted
+    msg = DBus::CallMessage::create( "dbuscxx.test", "/test", "test.for.dbuscxx", "add" );
+    msg << 2 << 3.0;
+
+    reply = conn->send_with_reply_nothrow( msg );
+    TEST_ASSERT_RET_FAIL( reply );
+    TEST_ASSERT_RET_FAIL( reply->type() == DBus::MessageType::RETURN );
+
+    TEST_ASSERT_RET_FAIL( DBus::priv::signature_is_compatible( "a{sv}(iad)", "a{sv}(uad)" ) );
+    TEST_ASSERT_RET_FAIL( !DBus::priv::signature_is_compatible( "a{sv}(ia)", "a{sv}(iad)" ) );
+    TEST_ASSERT_RET_FAIL( !DBus::priv::signature_is_compatible( "i", "ii" ) );
+    TEST_ASSERT_RET_FAIL( DBus::priv::signature_is_compatible( "ii", "i" ) );
+
+    return true;
+}
+
+static std::mutex deferred_lock;
+static std::vector<std::pair<std::shared_ptr<DBus::DeferredReply<double>>, double>> deferred_replies;
+
+static void deferred_add( std::shared_ptr<DBus::DeferredReply<double>> reply, double a, double b ) {
+    std::unique_lock<std::mutex> lock( deferred_lock );
+    deferred_replies.push_back( std::make_pair( reply, a + b ) );
+}
+
+static void deferred_drop( std::shared_ptr<DBus::DeferredReply<void>>, int ) {
+}
+
+bool object_deferred_reply() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test", DBus::ThreadForCalling::DispatcherThread );
+    object->create_method<void( std::shared_ptr<DBus::DeferredReply<double>>, double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( deferred_add ) );
+    object->create_method<void( std::shared_ptr<DBus::DeferredReply<void>>, int )>( "test.for.dbuscxx", "drop", sigc::ptr_fun( deferred_drop ) );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/test" );
+    std::shared_ptr<DBus::MethodProxy<double( double, double )>> remoteMethod =
+            remote->create_method<double( double, double )>( "test.for.dbuscxx", "add" );
+    std::shared_ptr<DBus::MethodProxy<void( int )>> dropMethod =
+            remote->create_method<void( int )>( "test.for.dbuscxx", "drop" );
+
+    std::vector<std::future<double>> results;
+
+    for( int x = 0; x < 200; x++ ) {
+        results.push_back( remoteMethod->call_async( x, 1 ) );
+    }
+
+    // Every call gets to the handler while none of them have been replied to
+    for( int x = 0; x < 250; x++ ) {
+        {
+            std::unique_lock<std::mutex> lock( deferred_lock );
+
+            if( deferred_replies.size() == 200 ) { break; }
+        }
+
+        std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+    }
+
+    TEST_ASSERT_RET_FAIL( conn->outstanding_replies() == 200 );
+
+    std::thread replier( []() {
+        std::unique_lock<std::mutex> lock( deferred_lock );
+
+        for( auto it = deferred_replies.rbegin(); it != deferred_replies.rend(); it++ ) {
+            it->first->reply( it->second );
+        }
+
+        deferred_replies.clear();
+    } );
+    replier.join();
+
+    for( int x = 0; x < 200; x++ ) {
+        TEST_ASSERT_RET_FAIL( results[ x ].get() == x + 1 );
+    }
+
+    TEST_ASSERT_RET_FAIL( conn->outstanding_replies() == 0 );
+
+    // Dropping the reply without completing it sends an error
+    DBus::Result<void> dropped = dropMethod->try_call( 1 );
+    TEST_ASSERT_RET_FAIL( !dropped );
+    TEST_ASSERT_RET_FAIL( dropped.error().name() == DBUSCXX_ERROR_FAILED );
+    TEST_ASSERT_RET_FAIL( conn->outstanding_replies() == 0 );
+
+    return true;
+}
+
+bool object_fallback() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> fallback = DBus::Object::create( "/tree" );
+    fallback->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+    TEST_ASSERT_RET_FAIL( conn->register_fallback( fallback ) == DBus::RegistrationStatus::Success );
+
+    std::shared_ptr<DBus::Object> exact = conn->create_object( "/tree/a/exact", DBus::ThreadForCalling::DispatcherThread );
+    exact->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( example_method ) );
+
+    const char* fallback_paths[] = { "/tree", "/tree/a", "/tree/a/b/c", "/tree/a/exact/below" };
+
+    for( const char* path : fallback_paths ) {
+        std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", path );
+        std::shared_ptr<DBus::MethodProxy<double( double, double )>> remoteMethod =
+                remote->create_method<double( double, double )>( "test.for.dbuscxx", "add" );
+        TEST_ASSERT_RET_FAIL( ( *remoteMethod )( 2, 3 ) == 5 );
+    }
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/tree/a/exact" );
+    std::shared_ptr<DBus::MethodProxy<double( double, double )>> remoteMethod =
+            remote->create_method<double( double, double )>( "test.for.dbuscxx", "add" );
+    TEST_ASSERT_RET_FAIL( ( *remoteMethod )( 2, 3 ) == 0 );
+
+    // Nothing handles paths outside of the tree
+    remote = conn->create_object_proxy( "dbuscxx.test", "/elsewhere" );
+    remoteMethod = remote->create_method<double( double, double )>( "test.for.dbuscxx", "add" );
+    TEST_ASSERT_RET_FAIL( !remoteMethod->try_call( 2, 3 ) );
+
+    TEST_ASSERT_RET_FAIL( conn->unregister_object( "/tree" ) );
+    remote = conn->create_object_proxy( "dbuscxx.test", "/tree/a" );
+    remoteMethod = remote->create_method<double( double, double )>( "test.for.dbuscxx", "add" );
+    TEST_ASSERT_RET_FAIL( !remoteMethod->try_call( 2, 3 ) );
+
+    return true;
+}
+
+bool object_add_child() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> parent = conn->create_object( "/parent", DBus::ThreadForCalling::DispatcherThread );
+    std::shared_ptr<DBus::Object> child = DBus::Object::create();
+    child->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+
+    TEST_ASSERT_RET_FAIL( parent->add_child( "child", child ) );
+    TEST_ASSERT_RET_FAIL( child->path() == "/parent/child" );
+    TEST_ASSERT_RET_FAIL( !parent->add_child( "child", DBus::Object::create() ) );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/parent/child" );
+    std::shared_ptr<DBus::MethodProxy<double( double, double )>> remoteMethod =
+            remote->create_method<double( double, double )>( "test.for.dbuscxx", "add" );
+    TEST_ASSERT_RET_FAIL( ( *remoteMethod )( 2, 3 ) == 5 );
+
+    TEST_ASSERT_RET_FAIL( parent->remove_child( "child" ) );
+    TEST_ASSERT_RET_FAIL( !remoteMethod->try_call( 2, 3 ) );
+
+    return true;
+}
+
+bool object_add_child_force_failed() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> parent = conn->create_object( "/parent", DBus::ThreadForCalling::DispatcherThread );
+    std::shared_ptr<DBus::Object> child = DBus::Object::create();
+    child->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+    TEST_ASSERT_RET_FAIL( parent->add_child( "child", child ) );
+
+    // The new child's path is already in use, so the old child has to stay
+    std::shared_ptr<DBus::Object> taken = conn->create_object( "/taken", DBus::ThreadForCalling::DispatcherThread );
+    std::shared_ptr<DBus::Object> replacement = DBus::Object::create( "/taken" );
+    TEST_ASSERT_RET_FAIL( !parent->add_child( "child", replacement, true ) );
+    TEST_ASSERT_RET_FAIL( parent->child( "child" ) == child );
+    TEST_ASSERT_RET_FAIL( replacement->path() == "/taken" );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/parent/child" );
+    std::shared_ptr<DBus::MethodProxy<double( double, double )>> remoteMethod =
+            remote->create_method<double( double, double )>( "test.for.dbuscxx", "add" );
+    TEST_ASSERT_RET_FAIL( ( *remoteMethod )( 2, 3 ) == 5 );
+
+    // A path that failed to register is not kept
+    std::shared_ptr<DBus::Object> other = conn->create_object( "/parent/other", DBus::ThreadForCalling::DispatcherThread );
+    std::shared_ptr<DBus::Object> unnamed = DBus::Object::create();
+    TEST_ASSERT_RET_FAIL( !parent->add_child( "other", unnamed ) );
+    TEST_ASSERT_RET_FAIL( unnamed->path().empty() );
+
+    // Replacing a child with one at the same path still works
+    std::shared_ptr<DBus::Object> same = DBus::Object::create();
+    TEST_ASSERT_RET_FAIL( parent->add_child( "child", same, true ) );
+    TEST_ASSERT_RET_FAIL( parent->child( "child" ) == same );
+    TEST_ASSERT_RET_FAIL( !remoteMethod->try_call( 2, 3 ) );
+
+    return true;
+}
+
+bool object_many_siblings() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    const int SIBLINGS = 20000;
+    std::vector<std::shared_ptr<DBus::Object>> objects;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for( int x = 0; x < SIBLINGS; x++ ) {
+        objects.push_back( conn->create_object( "/siblings/s" + std::to_string( x ), DBus::ThreadForCalling::DispatcherThread ) );
+        TEST_ASSERT_RET_FAIL( objects.back() );
+    }
+
+    // Adding a sibling must not copy all of the others
+    TEST_ASSERT_RET_FAIL( std::chrono::steady_clock::now() - start < std::chrono::seconds( 10 ) );
+
+    objects[ SIBLINGS / 2 ]->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+
+    std::shared_ptr<DBus::ObjectProxy> remote =
+        conn->create_object_proxy( "dbuscxx.test", "/siblings/s" + std::to_string( SIBLINGS / 2 ) );
+    std::shared_ptr<DBus::MethodProxy<double( double, double )>> remoteMethod =
+            remote->create_method<double( double, double )>( "test.for.dbuscxx", "add" );
+    TEST_ASSERT_RET_FAIL( ( *remoteMethod )( 2, 3 ) == 5 );
+
+    for( int x = 0; x < SIBLINGS; x += 2 ) {
+        TEST_ASSERT_RET_FAIL( conn->unregister_object( "/siblings/s" + std::to_string( x ) ) );
+    }
+
+    TEST_ASSERT_RET_FAIL( !remoteMethod->try_call( 2, 3 ) );
+    TEST_ASSERT_RET_FAIL( conn->register_object( DBus::Object::create( "/siblings/s0" ), DBus::ThreadForCalling::DispatcherThread ) ==
+                          DBus::RegistrationStatus::Success );
+    TEST_ASSERT_RET_FAIL( conn->register_object( DBus::Object::create( "/siblings/s1" ), DBus::ThreadForCalling::DispatcherThread ) !=
+                          DBus::RegistrationStatus::Success );
+
+    return true;
+}
+
+static int device_number( const std::string& path ) {
+    return std::stoi( path.substr( path.rfind( '/' ) + 1 ) );
+}
+
+bool object_virtual_tree() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    const int DEVICES = 100000;
+
+    std::shared_ptr<DBus::VirtualObjectTree> tree = DBus::VirtualObjectTree::create( "/devices",
+    []( const DBus::Path & path ) {
+        std::vector<std::string> children;
+
+        if( path == "/devices" ) {
+            for( int x = 0; x < 10; x++ ) {
+                children.push_back( std::to_string( x ) );
+            }
+        }
+
+        return children;
+    },
+    []( std::shared_ptr<DBus::Connection> conn, std::shared_ptr<const DBus::CallMessage> msg ) {
+        if( msg->member() != "Number" ) {
+            return DBus::HandlerResult::Invalid_Method;
+        }
+
+        std::shared_ptr<DBus::ReturnMessage> reply = msg->create_reply();
+        reply << device_number( msg->path() );
+        conn << reply;
+        return DBus::HandlerResult::Handled;
+    } );
+    tree->set_existence_check( [DEVICES]( const DBus::Path & path ) {
+        int number = device_number( path );
+        return number >= 0 && number < DEVICES && path == "/devices/" + std::to_string( number );
+    } );
+    tree->set_describer( []( const DBus::Path& ) {
+        return std::string( "  <interface name=\"test.device\">\n"
+                            "    <method name=\"Number\"><arg type=\"i\" direction=\"out\"/></method>\n"
+                            "    <property name=\"Number\" type=\"i\" access=\"read\"/>\n"
+                            "  </interface>\n" );
+    } );
+    tree->set_property_getter( []( const DBus::Path & path, const std::string & iface ) {
+        std::map<std::string, DBus::Variant> properties;
+
+        if( iface == "test.device" ) {
+            properties[ "Number" ] = DBus::Variant( device_number( path ) );
+        }
+
+        return properties;
+    } );
+
+    TEST_ASSERT_RET_FAIL( conn->register_fallback( tree ) == DBus::RegistrationStatus::Success );
+
+    for( int device : { 0, 7, 54321, DEVICES - 1 } ) {
+        std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/devices/" + std::to_string( device ) );
+        std::shared_ptr<DBus::MethodProxy<int()>> number = remote->create_method<int()>( "test.device", "Number" );
+        TEST_ASSERT_RET_FAIL( ( *number )() == device );
+
+        std::shared_ptr<DBus::MethodProxy<DBus::Variant( std::string, std::string )>> get =
+                remote->create_method<DBus::Variant( std::string, std::string )>( DBUS_CXX_PROPERTIES_INTERFACE, "Get" );
+        DBus::Variant value = ( *get )( "test.device", "Number" );
+        TEST_ASSERT_RET_FAIL( value.to_int32() == device );
+    }
+
+    std::shared_ptr<DBus::ObjectProxy> missing = conn->create_object_proxy( "dbuscxx.test", "/devices/" + std::to_string( DEVICES ) );
+    std::shared_ptr<DBus::MethodProxy<int()>> missingNumber = missing->create_method<int()>( "test.device", "Number" );
+    DBus::Result<int> result = missingNumber->try_call();
+    TEST_ASSERT_RET_FAIL( !result );
+    TEST_ASSERT_RET_FAIL( result.error().name() == DBUSCXX_ERROR_UNKNOWN_OBJECT );
+
+    std::shared_ptr<DBus::ObjectProxy> root = conn->create_object_proxy( "dbuscxx.test", "/devices" );
+    std::shared_ptr<DBus::MethodProxy<std::string()>> introspect = root->create_method<std::string()>( DBUS_CXX_INTROSPECTABLE_INTERFACE, "Introspect" );
+    std::string xml = ( *introspect )();
+    TEST_ASSERT_RET_FAIL( xml.find( "<node name=\"7\"/>" ) != std::string::npos );
+    TEST_ASSERT_RET_FAIL( xml.find( "test.device" ) != std::string::npos );
+
+    return true;
+}
+
+bool object_introspect_cache() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/introspect", DBus::ThreadForCalling::DispatcherThread );
+    object->create_method<double( double, double )>( "test.for.dbuscxx", "add", sigc::ptr_fun( add_method ) );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/introspect" );
+    std::shared_ptr<DBus::MethodProxy<std::string()>> introspect = remote->create_method<std::string()>( DBUS_CXX_INTROSPECTABLE_INTERFACE, "Introspect" );
+
+    std::string first = ( *introspect )();
+    TEST_ASSERT_RET_FAIL( first.find( "<method name=\"add\">" ) != std::string::npos );
+    TEST_ASSERT_RET_FAIL( ( *introspect )() == first );
+
+    std::shared_ptr<DBus::MethodBase> subtract = object->create_method<double( double, double )>( "test.for.dbuscxx", "subtract", sigc::ptr_fun( add_method ) );
+    std::string second = ( *introspect )();
+    TEST_ASSERT_RET_FAIL( second.find( "<method name=\"subtract\">" ) != std::string::npos );
+
+    subtract->set_arg_name( 0, "minuend" );
+    TEST_ASSERT_RET_FAIL( ( *introspect )().find( "minuend" ) != std::string::npos );
+
+    object->interface_by_name( "test.for.dbuscxx" )->remove_method( "subtract" );
+    TEST_ASSERT_RET_FAIL( ( *introspect )().find( "subtract" ) == std::string::npos );
+
+    TEST_ASSERT_RET_FAIL( object->add_child( "child", DBus::Object::create() ) );
+    TEST_ASSERT_RET_FAIL( ( *introspect )().find( "<node name=\"child\"/>" ) != std::string::npos );
+
+    return true;
+}
+
+bool object_get_all_cache() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/properties", DBus::ThreadForCalling::DispatcherThread );
+    std::shared_ptr<DBus::Property<int32_t>> number = object->create_property<int32_t>( "test.for.dbuscxx", "number" );
+    number->set_value( 1 );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/properties" );
+    std::shared_ptr<DBus::MethodProxy<std::map<std::string, DBus::Variant>( std::string )>> getAll =
+            remote->create_method<std::map<std::string, DBus::Variant>( std::string )>( DBUS_CXX_PROPERTIES_INTERFACE, "GetAll" );
+
+    std::map<std::string, DBus::Variant> values = ( *getAll )( "test.for.dbuscxx" );
+    TEST_ASSERT_RET_FAIL( values.size() == 1 );
+    TEST_ASSERT_RET_FAIL( values[ "number" ].to_int32() == 1 );
+    TEST_ASSERT_RET_FAIL( ( *getAll )( "test.for.dbuscxx" ) == values );
+
+    number->set_value( 2 );
+    values = ( *getAll )( "test.for.dbuscxx" );
+    TEST_ASSERT_RET_FAIL( values[ "number" ].to_int32() == 2 );
+
+    object->create_property<std::string>( "test.for.dbuscxx", "name" )->set_value( "dbus-cxx" );
+    values = ( *getAll )( "test.for.dbuscxx" );
+    TEST_ASSERT_RET_FAIL( values.size() == 2 );
+    TEST_ASSERT_RET_FAIL( values[ "name" ].to_string() == "dbus-cxx" );
+
+    return true;
+}
+
+bool object_property_batch() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/batch", DBus::ThreadForCalling::DispatcherThread );
+    std::shared_ptr<DBus::Interface> iface = object->create_interface( "test.for.dbuscxx" );
+    std::shared_ptr<DBus::Property<int32_t>> a = iface->create_property<int32_t>( "a" );
+    std::shared_ptr<DBus::Property<int32_t>> b = iface->create_property<int32_t>( "b" );
+    std::shared_ptr<DBus::Property<int32_t>> c = iface->create_property<int32_t>( "c",
+            DBus::PropertyAccess::ReadWrite, DBus::PropertyUpdateType::Invalidates );
+    iface->create_method<void()>( "SetBoth", sigc::slot<void()>( [a, b]() {
+        a->set_value( 5 );
+        b->set_value( 6 );
+    } ) );
+
+    std::mutex lock;
+    std::vector<std::pair<std::map<std::string, DBus::Variant>, std::vector<std::string>>> received;
+    std::shared_ptr<DBus::SignalProxy<void( std::string, std::map<std::string, DBus::Variant>, std::vector<std::string> )>> sig =
+        conn->create_free_signal_proxy<void( std::string, std::map<std::string, DBus::Variant>, std::vector<std::string> )>(
+            DBus::MatchRuleBuilder::create()
+            .set_path( "/batch" )
+            .set_interface( DBUS_CXX_PROPERTIES_INTERFACE )
+            .set_member( "PropertiesChanged" )
+            .as_signal_match() );
+    sig->connect( [&lock, &received]( std::string, std::map<std::string, DBus::Variant> changed, std::vector<std::string> invalidated ) {
+        std::scoped_lock guard( lock );
+        received.push_back( std::make_pair( changed, invalidated ) );
+    } );
+
+    {
+        DBus::PropertyChangeBatch batch( iface );
+        a->set_value( 1 );
+        b->set_value( 2 );
+        c->set_value( 3 );
+        a->set_value( 4 );
+    }
+
+    iface->set_coalesce_property_changes( true );
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.test", "/batch" );
+    ( *remote->create_method<void()>( "test.for.dbuscxx", "SetBoth" ) )();
+
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+
+    std::scoped_lock guard( lock );
+    TEST_ASSERT_RET_FAIL( received.size() == 2 );
+    TEST_ASSERT_RET_FAIL( received[ 0 ].first.size() == 2 );
+    TEST_ASSERT_RET_FAIL( received[ 0 ].first[ "a" ].to_int32() == 4 );
+    TEST_ASSERT_RET_FAIL( received[ 0 ].first[ "b" ].to_int32() == 2 );
+    TEST_ASSERT_RET_FAIL( received[ 0 ].second == std::vector<std::string>( { "c" } ) );
+    TEST_ASSERT_RET_FAIL( received[ 1 ].first.size() == 2 );
+    TEST_ASSERT_RET_FAIL( received[ 1 ].first[ "a" ].to_int32() == 5 );
+    TEST_ASSERT_RET_FAIL( received[ 1 ].first[ "b" ].to_int32() == 6 );
+    TEST_ASSERT_RET_FAIL( received[ 1 ].second.empty() );
+
+    return true;
+}
+
+bool object_object_manager() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.test" );
+
+    std::shared_ptr<DBus::Object> manager = conn->create_object( "/manager", DBus::ThreadForCalling::DispatcherThread );
+    manager->set_object_manager( true );
+
+    std::shared_ptr<DBus::Object> first = conn->create_object( "/manager/first", DBus::ThreadForCalling::DispatcherThread );
+    std::shared_ptr<DBus::Property<int32_t>> number = first->create_property<int32_t>( "test.for.dbuscxx", "number" );
+    number->set_value( 1 );
+
+    std::shared_ptr<DBus::ObjectManagerProxy> remote = DBus::ObjectManagerProxy::create( conn, "dbuscxx.test", "/manager" );
+    std::atomic<int> added( 0 );
+    std::atomic<int> removed( 0 );
+    remote->signal_interfaces_added().connect( [&added]( DBus::Path, DBus::ObjectManagerProxy::InterfacesAndProperties ) {
+        added++;
+    } );
+    remote->signal_interfaces_removed().connect( [&removed]( DBus::Path, std::vector<std::string> ) {
+        removed++;
+    } );
+
+    TEST_ASSERT_RET_FAIL( remote->managed_objects().size() == 1 );
+    TEST_ASSERT_RET_FAIL( remote->object( "/manager/first" )[ "test.for.dbuscxx" ][ "number" ].to_int32() == 1 );
+    TEST_ASSERT_RET_FAIL( !remote->has_object( "/manager" ) );
+
+    number->set_value( 2 );
+
+    std::shared_ptr<DBus::Object> second = conn->create_object( "/manager/deeper/second", DBus::ThreadForCalling::DispatcherThread );
+    second->create_property<std::string>( "test.for.dbuscxx", "name" )->set_value( "second" );
+
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+
+    TEST_ASSERT_RET_FAIL( added == 1 );
+    TEST_ASSERT_RET_FAIL( remote->object( "/manager/first" )[ "test.for.dbuscxx" ][ "number" ].to_int32() == 2 );
+    TEST_ASSERT_RET_FAIL( remote->object( "/manager/deeper/second" )[ "test.for.dbuscxx" ][ "name" ].to_string() == "second" );
+
+    remote->refresh();
+    TEST_ASSERT_RET_FAIL( remote->managed_objects().size() == 2 );
+    TEST_ASSERT_RET_FAIL( remote->object( "/manager/deeper/second" )[ "test.for.dbuscxx" ].size() == 1 );
+
+    TEST_ASSERT_RET_FAIL( first->unregister() );
+
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+
+    TEST_ASSERT_RET_FAIL( removed == 1 );
+    TEST_ASSERT_RET_FAIL( !remote->has_object( "/manager/first" ) );
+    TEST_ASSERT_RET_FAIL( remote->managed_objects().size() == 1 );
+
+    remote->refresh();
+    TEST_ASSERT_RET_FAIL( remote->managed_objects().size() == 1 );
+    TEST_ASSERT_RET_FAIL( remote->has_object( "/manager/deeper/second" ) );
+
+    return true;
+}
+
+bool object_name_owner() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    std::shared_ptr<DBus::Connection> owner = dispatch->create_connection( DBus::BusType::SESSION );
+    std::shared_ptr<DBus::Connection> other = dispatch->create_connection( DBus::BusType::SESSION );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = conn->create_object_proxy( "dbuscxx.owner", "/owner" );
+    std::atomic<int> owner_changes( 0 );
+    remote->signal_owner_changed().connect( [&owner_changes]( std::string, std::string ) {
+        owner_changes++;
+    } );
+
+    TEST_ASSERT_RET_FAIL( conn->name_owner( "dbuscxx.owner" ).empty() );
+    TEST_ASSERT_RET_FAIL( !conn->name_has_owner( "dbuscxx.owner" ) );
+
+    std::atomic<int> from_owner( 0 );
+    std::atomic<int> from_anyone( 0 );
+    conn->create_free_signal_proxy<void()>(
+        DBus::MatchRuleBuilder::create()
+        .set_sender( "dbuscxx.owner" )
+        .set_interface( "test.for.dbuscxx" )
+        .set_member( "Ping" )
+        .as_signal_match() )->connect( [&from_owner]() {
+        from_owner++;
+    } );
+    conn->create_free_signal_proxy<void()>(
+        DBus::MatchRuleBuilder::create()
+        .set_interface( "test.for.dbuscxx" )
+        .set_member( "Ping" )
+        .as_signal_match() )->connect( [&from_anyone]() {
+        from_anyone++;
+    } );
+
+    owner->request_name( "dbuscxx.owner" );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+
+    TEST_ASSERT_RET_FAIL( owner_changes == 1 );
+    TEST_ASSERT_RET_FAIL( conn->name_owner( "dbuscxx.owner" ) == owner->unique_name() );
+    TEST_ASSERT_RET_FAIL( conn->name_has_owner( "dbuscxx.owner" ) );
+
+    owner << DBus::SignalMessage::create( "/owner", "test.for.dbuscxx", "Ping" );
+    other << DBus::SignalMessage::create( "/owner", "test.for.dbuscxx", "Ping" );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+
+    TEST_ASSERT_RET_FAIL( from_owner == 1 );
+    TEST_ASSERT_RET_FAIL( from_anyone == 2 );
+
+    owner->release_name( "dbuscxx.owner" );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+
+    TEST_ASSERT_RET_FAIL( owner_changes == 2 );
+    TEST_ASSERT_RET_FAIL( conn->name_owner( "dbuscxx.owner" ).empty() );
+
+    return true;
+}
+
+static void caller_user( std::shared_ptr<DBus::DeferredReply<uint32_t>> reply ) {
+    DBus::Credentials creds = reply->call_message()->sender_credentials();
+
+    reply->reply( creds.unix_user_id().value_or( 0xFFFFFFFF ) );
+}
+
+bool object_credentials() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    std::shared_ptr<DBus::Connection> client = dispatch->create_connection( DBus::BusType::SESSION );
+    conn->request_name( "dbuscxx.credentials" );
+
+    std::shared_ptr<DBus::Object> object = conn->create_object( "/test", DBus::ThreadForCalling::DispatcherThread );
+    object->create_method<void( std::shared_ptr<DBus::DeferredReply<uint32_t>> )>( "test.for.dbuscxx", "user", sigc::ptr_fun( caller_user ) );
+
+    std::shared_ptr<DBus::ObjectProxy> remote = client->create_object_proxy( "dbuscxx.credentials", "/test" );
+    std::shared_ptr<DBus::MethodProxy<uint32_t()>> userMethod =
+            remote->create_method<uint32_t()>( "test.for.dbuscxx", "user" );
+
+    // The second call is answered from the cache
+    TEST_ASSERT_RET_FAIL( ( *userMethod )() == getuid() );
+    TEST_ASSERT_RET_FAIL( ( *userMethod )() == getuid() );
+
+    DBus::Credentials creds = conn->credentials( client->unique_name() );
+    TEST_ASSERT_RET_FAIL( creds.unix_user_id() && *creds.unix_user_id() == getuid() );
+    TEST_ASSERT_RET_FAIL( creds.process_id() && *creds.process_id() == static_cast<uint32_t>( getpid() ) );
+
+    // Well-known names are resolved to their owner
+    creds = client->credentials( "dbuscxx.credentials" );
+    TEST_ASSERT_RET_FAIL( creds.process_id() && *creds.process_id() == static_cast<uint32_t>( getpid() ) );
+
+    bool threw = false;
+
+    try {
+        conn->credentials( "dbuscxx.nobody" );
+    } catch( const DBus::Error& ) {
+        threw = true;
+    }
+
+    TEST_ASSERT_RET_FAIL( threw );
+
+    return true;
+}
+
 #define ADD_TEST(name) do{ if( test_name == STRINGIFY(name) ){ \
             ret = object_##name();\
         } \
@@ -73,6 +1019,30 @@ int main( int argc, char** argv ) {
     ADD_TEST( proxy_create );
     ADD_TEST( proxy_create_method1 );
     ADD_TEST( export_method );
+    ADD_TEST( call_async );
+    ADD_TEST( call_async_error );
+    ADD_TEST( pending_call );
+    ADD_TEST( call_async_timeout );
+    ADD_TEST( concurrent_calls );
+    ADD_TEST( call_timeout );
+    ADD_TEST( call_batch );
+    ADD_TEST( call_batch_timeout );
+    ADD_TEST( no_reply );
+    ADD_TEST( try_call );
+    ADD_TEST( result_method );
+    ADD_TEST( bad_signature );
+    ADD_TEST( deferred_reply );
+    ADD_TEST( fallback );
+    ADD_TEST( add_child );
+    ADD_TEST( add_child_force_failed );
+    ADD_TEST( many_siblings );
+    ADD_TEST( virtual_tree );
+    ADD_TEST( introspect_cache );
+    ADD_TEST( get_all_cache );
+    ADD_TEST( property_batch );
+    ADD_TEST( object_manager );
+    ADD_TEST( name_owner );
+    ADD_TEST( credentials );
 
     return !ret;
 }
@@ -128,6 +128,85 @@ bool property_updated_from_signal(){
     return times == 1 && value == 7878;
 }
 
+bool property_lookup_by_name(){
+    std::shared_ptr<DBus::Interface> iface = DBus::Interface::create( "dbuscxx.local" );
+
+    for( int x = 0; x < 500; x++ ){
+        iface->create_property<int32_t>( "prop" + std::to_string( x ) )->set_value( x );
+    }
+
+    std::string_view name( "prop321" );
+    std::shared_ptr<DBus::PropertyBase> prop = iface->property( name );
+
+    TEST_ASSERT_RET_FAIL( prop );
+    TEST_ASSERT_RET_FAIL( prop->name() == name );
+    TEST_ASSERT_RET_FAIL( prop->shared_value()->to_int32() == 321 );
+    TEST_ASSERT_RET_FAIL( iface->has_property( "prop0" ) );
+    TEST_ASSERT_RET_FAIL( !iface->has_property( "prop500" ) );
+    TEST_ASSERT_RET_FAIL( !iface->property( "prop500" ) );
+    TEST_ASSERT_RET_FAIL( !iface->add_property( DBus::Property<int32_t>::create( "prop7", DBus::PropertyAccess::ReadWrite, DBus::PropertyUpdateType::Updates ) ) );
+    TEST_ASSERT_RET_FAIL( iface->properties().size() == 500 );
+
+    return true;
+}
+
+bool property_only_on_change(){
+    std::shared_ptr<DBus::Interface> iface = DBus::Interface::create( "dbuscxx.local" );
+    std::shared_ptr<DBus::Property<int32_t>> prop = iface->create_property<int32_t>( "sensor" );
+
+    TEST_ASSERT_RET_FAIL( DBus::Variant( 5 ).hash() == DBus::Variant( 5 ).hash() );
+    TEST_ASSERT_RET_FAIL( DBus::Variant( 5 ).hash() != DBus::Variant( 6 ).hash() );
+    TEST_ASSERT_RET_FAIL( !( DBus::Variant( std::vector<int32_t>() ) == DBus::Variant( std::vector<uint32_t>() ) ) );
+
+    prop->set_value( 5 );
+    prop->set_value( 5 );
+    TEST_ASSERT_RET_FAIL( prop->suppressed_updates() == 0 );
+
+    prop->set_emit_only_on_change( true );
+    prop->set_value( 5 );
+    prop->set_value( 5 );
+    prop->set_value( 6 );
+    prop->set_value( 6 );
+    TEST_ASSERT_RET_FAIL( prop->suppressed_updates() == 3 );
+    TEST_ASSERT_RET_FAIL( prop->value() == 6 );
+
+    return true;
+}
+
+bool property_cache(){
+    std::shared_ptr<DBus::InterfaceProxy> iface = proxy->interface_by_name( "dbuscxx.interface" );
+    std::shared_ptr<DBus::PropertyProxy<int32_t>> invalidating =
+            iface->create_property<int32_t>( "invalidating", DBus::PropertyUpdateType::Invalidates );
+    std::shared_ptr<DBus::PropertyProxyBase> intproperty = iface->property( "intproperty" );
+
+    TEST_ASSERT_RET_FAIL( intproperty->is_stale() );
+    TEST_ASSERT_RET_FAIL( invalidating->is_stale() );
+
+    iface->set_property_caching( true );
+    TEST_ASSERT_RET_FAIL( iface->property_caching() );
+    TEST_ASSERT_RET_FAIL( !intproperty->is_stale() );
+    TEST_ASSERT_RET_FAIL( !invalidating->is_stale() );
+    TEST_ASSERT_RET_FAIL( intproperty->variant_value().to_int32() == 9834 );
+    TEST_ASSERT_RET_FAIL( invalidating->value() == 1 );
+
+    uint64_t generation = iface->property_generation();
+    uint64_t invalidating_generation = invalidating->generation();
+
+    invalidating->set_value( 2 );
+
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+
+    TEST_ASSERT_RET_FAIL( invalidating->is_stale() );
+    TEST_ASSERT_RET_FAIL( !intproperty->is_stale() );
+    TEST_ASSERT_RET_FAIL( iface->property_generation() > generation );
+
+    TEST_ASSERT_RET_FAIL( invalidating->value() == 2 );
+    TEST_ASSERT_RET_FAIL( !invalidating->is_stale() );
+    TEST_ASSERT_RET_FAIL( invalidating->generation() > invalidating_generation );
+
+    return true;
+}
+
 void client_setup() {
     proxy = conn->create_object_proxy( "dbuscxx.test", "/test" );
 
@@ -152,6 +231,11 @@ void server_setup() {
     std::shared_ptr<DBus::Property<int32_t>> readonly =
             object->create_property<int32_t>( "dbuscxx.interface", "readonly", DBus::PropertyAccess::ReadOnly );
     readonly->set_value( 44 );
+
+    std::shared_ptr<DBus::Property<int32_t>> invalidating =
+            object->create_property<int32_t>( "dbuscxx.interface", "invalidating",
+                                              DBus::PropertyAccess::ReadWrite, DBus::PropertyUpdateType::Invalidates );
+    invalidating->set_value( 1 );
 }
 
 #define ADD_TEST(name) do{ if( test_name == STRINGIFY(name) ){ \
@@ -184,6 +268,9 @@ int main( int argc, char** argv ) {
         ADD_TEST( set_readonly );
         ADD_TEST( signal_emitted );
         ADD_TEST( updated_from_signal );
+        ADD_TEST( lookup_by_name );
+        ADD_TEST( only_on_change );
+        ADD_TEST( cache );
     } else {
         server_setup();
         ret = true;
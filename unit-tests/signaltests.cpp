@@ -19,8 +19,10 @@
  *   along with this software. If not see <http://www.gnu.org/licenses/>.  *
  ***************************************************************************/
 #include <dbus-cxx.h>
+#include <atomic>
 #include <unistd.h>
 #include <iostream>
+#include <thread>
 
 #include "test_macros.h"
 
@@ -36,6 +38,15 @@ void voidSigHandle() {
     num_rx++;
 }
 
+void matchErrorHandle( std::string rule, std::string, std::string ) {
+    signal_value = rule;
+}
+
+void argSigHandle( int32_t, std::vector<int32_t>, std::string value ) {
+    signal_value = value;
+    num_rx++;
+}
+
 bool signal_create() {
     std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
 
@@ -205,6 +216,203 @@ bool signal_remove_handler() {
     return true;
 }
 
+bool signal_arg_match() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+
+    std::shared_ptr<DBus::Signal<void(int32_t, std::vector<int32_t>, std::string)>> signal =
+        conn->create_free_signal<void(int32_t, std::vector<int32_t>, std::string)>( "/test/signal", "test.signal.type", "Args" );
+    std::shared_ptr<DBus::SignalProxy<void(int32_t, std::vector<int32_t>, std::string)>> proxy =
+        conn->create_free_signal_proxy<void(int32_t, std::vector<int32_t>, std::string)>(
+                DBus::MatchRuleBuilder::create()
+                .set_interface( "test.signal.type" )
+                .set_arg( 2, "wanted" )
+                .as_signal_match(),
+                DBus::ThreadForCalling::DispatcherThread );
+    std::shared_ptr<DBus::SignalProxy<void()>> otherProxy = conn->create_free_signal_proxy<void()>(
+                DBus::MatchRuleBuilder::create()
+                .set_interface( "test.signal.type" )
+                .set_arg( 2, "other" )
+                .as_signal_match(),
+                DBus::ThreadForCalling::DispatcherThread );
+
+    proxy->connect( sigc::ptr_fun( argSigHandle ) );
+    otherProxy->connect( sigc::ptr_fun( voidSigHandle ) );
+
+    // The bus delivers both signals since otherProxy matches the second one,
+    // but only the first one may go to proxy.
+    signal->emit( 5, std::vector<int32_t>{ 1, 2, 3 }, "wanted" );
+    signal->emit( 6, std::vector<int32_t>{ 4 }, "other" );
+    sleep( 1 );
+
+    TEST_ASSERT_RET_FAIL( signal_value.compare( "wanted" ) == 0 );
+    TEST_ASSERT_RET_FAIL( num_rx == 2 );
+    return true;
+}
+
+bool signal_arg0namespace_match() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+
+    std::shared_ptr<DBus::Signal<void(std::string)>> signal = conn->create_free_signal<void(std::string)>( "/test/signal", "test.signal.type", "Name" );
+    std::shared_ptr<DBus::SignalProxy<void(std::string)>> proxy = conn->create_free_signal_proxy<void(std::string)>(
+                DBus::MatchRuleBuilder::create()
+                .set_interface( "test.signal.type" )
+                .set_arg0_namespace( "com.example" )
+                .as_signal_match(),
+                DBus::ThreadForCalling::DispatcherThread );
+
+    proxy->connect( sigc::ptr_fun( sigHandle ) );
+
+    signal->emit( "com.example.Foo" );
+    sleep( 1 );
+    TEST_ASSERT_RET_FAIL( signal_value.compare( "com.example.Foo" ) == 0 );
+
+    signal->emit( "com.examples.Bar" );
+    sleep( 1 );
+    TEST_ASSERT_RET_FAIL( signal_value.compare( "com.example.Foo" ) == 0 );
+
+    return true;
+}
+
+bool signal_path_namespace_match() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+
+    std::shared_ptr<DBus::Signal<void()>> childSignal = conn->create_free_signal<void()>( "/test/signal/child", "test.signal.type", "ExampleMember" );
+    std::shared_ptr<DBus::Signal<void()>> otherSignal = conn->create_free_signal<void()>( "/test/signalother", "test.signal.type", "ExampleMember" );
+    std::shared_ptr<DBus::SignalProxy<void()>> proxy = conn->create_free_signal_proxy<void()>(
+                DBus::MatchRuleBuilder::create()
+                .set_path_namespace( "/test/signal" )
+                .as_signal_match(),
+                DBus::ThreadForCalling::DispatcherThread );
+
+    proxy->connect( sigc::ptr_fun( voidSigHandle ) );
+
+    childSignal->emit();
+    otherSignal->emit();
+    sleep( 1 );
+
+    TEST_ASSERT_RET_FAIL( num_rx == 1 );
+    return true;
+}
+
+bool signal_match_rule_string() {
+    DBus::SignalMatchRule rule = DBus::MatchRuleBuilder::create()
+        .set_interface( "test.signal.type" )
+        .set_arg( 0, "it's" )
+        .set_arg_path( 1, "/test/" )
+        .as_signal_match();
+
+    TEST_ASSERT_RET_FAIL( rule.match_rule() ==
+        "type='signal',interface='test.signal.type',arg0='it'\\''s',arg1path='/test/'" );
+    return true;
+}
+
+bool signal_match_error() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+
+    conn->signal_match_error().connect( sigc::ptr_fun( matchErrorHandle ) );
+    conn->add_match_nonblocking( "type='not-a-type'" );
+    sleep( 1 );
+
+    TEST_ASSERT_RET_FAIL( signal_value.compare( "type='not-a-type'" ) == 0 );
+
+    // The rule is still counted, so removing it still goes to the bus
+    signal_value.clear();
+    conn->remove_match( "type='not-a-type'" );
+    sleep( 1 );
+
+    TEST_ASSERT_RET_FAIL( signal_value.compare( "type='not-a-type'" ) == 0 );
+    return true;
+}
+
+bool signal_add_match_shared() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    std::atomic<int> failures( 0 );
+    std::vector<std::thread> threads;
+
+    // Only the first add goes to the bus; the others must get its answer
+    for( int x = 0; x < 4; x++ ) {
+        threads.push_back( std::thread( [conn, &failures]() {
+            try {
+                conn->add_match( "type='not-a-type'" );
+            } catch( const DBus::Error& ) {
+                failures++;
+            }
+        } ) );
+    }
+
+    for( std::thread& thr : threads ) {
+        thr.join();
+    }
+
+    TEST_ASSERT_RET_FAIL( failures == 4 );
+
+    // Each failed add took back its own count, so the bus is asked again
+    try {
+        conn->add_match( "type='not-a-type'" );
+        return false;
+    } catch( const DBus::Error& ) {}
+
+    return true;
+}
+
+bool signal_many_proxies() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+    std::vector<std::shared_ptr<DBus::SignalProxy<void()>>> proxies;
+
+    for( int x = 0; x < 200; x++ ) {
+        std::shared_ptr<DBus::SignalProxy<void()>> proxy = conn->create_free_signal_proxy<void()>(
+                DBus::MatchRuleBuilder::create()
+                .set_path( "/test/signal" )
+                .set_interface( "test.signal.type" )
+                .set_member( "Member" + std::to_string( x ) )
+                .as_signal_match(),
+                DBus::ThreadForCalling::DispatcherThread );
+        proxy->connect( sigc::ptr_fun( voidSigHandle ) );
+        proxies.push_back( proxy );
+    }
+
+    std::shared_ptr<DBus::Signal<void()>> signal = conn->create_free_signal<void()>( "/test/signal", "test.signal.type", "Member199" );
+    signal->emit();
+    sleep( 1 );
+
+    TEST_ASSERT_RET_FAIL( num_rx == 1 );
+    return true;
+}
+
+bool signal_emit_many_threads() {
+    std::shared_ptr<DBus::Connection> conn = dispatch->create_connection( DBus::BusType::SESSION );
+
+    std::shared_ptr<DBus::Signal<void()>> signal = conn->create_free_signal<void()>( "/test/signal", "test.signal.type", "ExampleMember" );
+    std::shared_ptr<DBus::SignalProxy<void()>> proxy = conn->create_free_signal_proxy<void()>(
+                DBus::MatchRuleBuilder::create()
+                .set_path( "/test/signal" )
+                .set_interface( "test.signal.type" )
+                .set_member( "ExampleMember" )
+                .as_signal_match(),
+                DBus::ThreadForCalling::DispatcherThread );
+
+    proxy->connect( sigc::ptr_fun( voidSigHandle ) );
+
+    std::vector<std::thread> threads;
+
+    for( int t = 0; t < 4; t++ ) {
+        threads.push_back( std::thread( [signal]() {
+            for( int x = 0; x < 250; x++ ) {
+                signal->emit();
+            }
+        } ) );
+    }
+
+    for( std::thread& thr : threads ) {
+        thr.join();
+    }
+
+    sleep( 2 );
+
+    TEST_ASSERT_RET_FAIL( num_rx == 1000 );
+    return true;
+}
+
 #define ADD_TEST(name) do{ if( test_name == STRINGIFY(name) ){ \
             ret = signal_##name();\
         } \
@@ -231,6 +439,14 @@ int main( int argc, char** argv ) {
     ADD_TEST( member_match_only );
     ADD_TEST( multiple_handlers );
     ADD_TEST( remove_handler );
+    ADD_TEST( arg_match );
+    ADD_TEST( arg0namespace_match );
+    ADD_TEST( path_namespace_match );
+    ADD_TEST( match_rule_string );
+    ADD_TEST( match_error );
+    ADD_TEST( add_match_shared );
+    ADD_TEST( many_proxies );
+    ADD_TEST( emit_many_threads );
 
     return !ret;
 }